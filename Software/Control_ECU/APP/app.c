@@ -11,19 +11,42 @@
  *******************************************************************************/
 #include "app.h"
 #include "uart.h"
-#include "timer.h"
-#include "external_eeprom.h"
+#include "frame.h"
+#include "baud.h"
+#include "link.h"
+#include "diag.h"
+#include "systick.h"
+#include "swtimer.h"
+#include "idle.h"
+#include "prof.h"
+#include "cred.h"
 #include "dc_motor.h"
 #include "i2c.h"
 #include "buzzer.h"
-#include <util/delay.h>
 #include <avr/io.h>
 
 /*******************************************************************************
  *                           Global Variables                                  *
  *******************************************************************************/
 
-uint8 g_sec = 0;
+/* the door phase, the tick it started at and how far the door was open then (0 -> DOOR_MOVE_MS) */
+static DOOR_State g_doorState = DOOR_LOCKED;
+static uint32 g_doorPhaseStart;
+static uint32 g_doorPosition = 0;
+
+/* static so they start stopped and stay alive while they are running */
+static SWTIMER_Timer g_doorTimer;
+static SWTIMER_Timer g_alarmTimer;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void startDoorPhase(DOOR_State state);
+
+static uint32 getDoorPosition(void);
+
+static void doorTimeoutCallback(void);
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -41,23 +64,37 @@ uint8 g_sec = 0;
 void app(void)
 {
 
-	/* contains the command received through UART */
-	uint8 command;
+	/* contains the command frame taken from the link queue */
+	FRAME_Message frame;
+
+	/* bus addresses of the panels and the index of the selected one */
+	const uint8 panelAddresses[NUM_OF_PANELS] = PANEL_ADDRESSES;
+	uint8 panel = 0;
 
-	/* array to store first password entered */
-	uint8 pass1arr[PASSWORD_SIZE];
+	/* periodic timer of the baud rate fallback check */
+	static SWTIMER_Timer linkCheckTimer;
 
-	/* array to store second password entered */
-	uint8 pass2arr[PASSWORD_SIZE];
+	/* periodic timer of the password cache check */
+	static SWTIMER_Timer credVerifyTimer;
+
+	/* Timer1 counts at the start of the iteration ... to measure the longest one */
+	uint32 loopStart;
 
 	/* set I-Bit to enable interrupts */
 	SREG = (1<<7);
 
-	/* UART configurations structure */
-	UART_ConfigType uartConfig = {DISABLE_PARITY,ONE_STOPBIT,EIGHT_DATABITS,9600};
+	/* start the millisecond tick used by all the timeouts */
+	SYSTICK_init();
+	SWTIMER_init();
+
+	/* the CPU sleeps inside the UART waits of the panel slots */
+	IDLE_init();
 
-	/* initialize UART */
-	UART_init(&uartConfig);
+	/* UART configurations structure ... the Control ECU is the master of the panels bus */
+	UART_ConfigType uartConfig = {DISABLE_PARITY,ONE_STOPBIT,PANEL_DATABITS,9600,UART_INTERRUPT_MODE,UART_MASTER_ADDRESS};
+
+	/* initialize UART at the default baud rate ... the HMI ECU may negotiate a faster one */
+	BAUD_init(&uartConfig);
 
 	/* I2C configurations structure */
 	I2C_ConfigType i2cConfig = {FAST_MODE,0b0000001};
@@ -65,34 +102,88 @@ void app(void)
 	/* initialize I2C */
 	I2C_init(&i2cConfig);
 
+	/* load the saved password in RAM ... the requests are answered from it */
+	CRED_init();
+
 	/* initialize Motor */
 	DC_MOTOR_init();
 
 	/* initialize Buzzer */
 	Buzzer_init();
 
-	/* wait till the HMI ECU is ready */
-	while(UART_receiveByte() != HMI_READY);
+	/* fall back to the default baud rate if the HMI ECU has reset */
+	SWTIMER_start(&linkCheckTimer, LINK_CHECK_PERIOD_MS, LINK_CHECK_PERIOD_MS, BAUD_checkLink);
+
+	/* compare the cached password with the EEPROM now and then */
+	SWTIMER_start(&credVerifyTimer, CRED_VERIFY_PERIOD_MS, CRED_VERIFY_PERIOD_MS, CRED_verify);
 
+	/* the frames are taken from the first panel ... the only one if there is one */
+	LINK_selectSource(panelAddresses[panel]);
+
+	loopStart = SYSTICK_getCounts();
 	while(1)
 	{
-		/* receive a command */
-		command = UART_receiveByte();
+		/* the iterations end with continue so the last one is measured here */
+		DIAG_recordLoop(loopStart);
+		loopStart = SYSTICK_getCounts();
+
+		/* fire the software timers expired since the last turn */
+		SWTIMER_process();
+
+#if(NUM_OF_PANELS > 1)
+		/* give the bus to the next panel ... round robin so no panel can starve the others,
+		 * one that has just started a request is selected again till the request completes */
+		if(releasePanel() == TRUE)
+		{
+			panel = (panel + 1) % NUM_OF_PANELS;
+		}
+		UART_sendAddress(panelAddresses[panel]);
+
+		/* one request per turn ... the frames left from the previous turns wait for the turn of their panel */
+		LINK_selectSource(panelAddresses[panel]);
+#endif
+		if(waitPanelRequest(&frame) == FALSE)
+		{
+			continue;
+		}
 
-		switch(command)
+		switch(frame.type)
 		{
+		case HMI_READY:
+			/* the HMI ECU has started ... tell it that the Control ECU is ready too */
+			LINK_reply(HMI_READY, NULL_PTR, 0);
+			break;
+
+		case BAUD_PROPOSE:
+			/* the panels share the bus so its rate can be changed only if there is one panel */
+			if(NUM_OF_PANELS == 1)
+				BAUD_handleProposal(&frame);
+			break;
+
 		case SETTING_UP_A_NEW_PASS:
-			setupNewPassword(pass1arr,pass2arr);
+			/* the payload holds the password followed by its confirmation */
+			if(frame.length == 2 * PASSWORD_SIZE)
+				setupNewPassword(frame.payload, frame.payload + PASSWORD_SIZE);
+			else
+				LINK_reply(ERROR, NULL_PTR, 0);
 			break;
 
 		case PASS_CHECK:
-			checkPassword(pass1arr, pass2arr);
+			/* the payload holds the password to be checked */
+			if(frame.length == PASSWORD_SIZE)
+				checkPassword(frame.payload);
+			else
+				LINK_reply(ERROR, NULL_PTR, 0);
 			break;
 
 		case OPEN_DOOR:
 			openDoor();
 			break;
 
+		case ABORT_DOOR:
+			abortDoor();
+			break;
+
 		case ACTIVATE_THE_ALERT:
 			activateAlarm();
 			break;
@@ -106,8 +197,104 @@ void app(void)
 			/* Deletes old password */
 			resetPass();
 			break;
+
+		case DIAGNOSTICS:
+			/* the payload holds the number of the requested counters page */
+			if(frame.length == 1)
+				sendDiagnostics(frame.payload[0]);
+			else
+				LINK_reply(ERROR, NULL_PTR, 0);
+			break;
+		}
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  waitPanelRequest
+[Description]:  Function to wait for a request from the selected panel during its slot,
+				a frame that has already started is given PANEL_FRAME_MS more to complete ...
+				a single panel is waited for till the next software timer expires
+[Args]:
+[in]	-NONE
+[out]	FRAME_Message * frame:
+					pointer to the structure you want to save the request in
+[in/out] -NONE
+[Returns]: TRUE if a request is received, FALSE if the panel has nothing to send
+------------------------------------------------------------------*/
+boolean waitPanelRequest(FRAME_Message * frame)
+{
+#if(NUM_OF_PANELS == 1)
+	/* the panel never loses the bus ... the CPU sleeps till its request or the next timer */
+	uint32 expiry;
+	sint32 timeoutMs = IDLE_MAX_SLEEP_MS;
+
+	if(SWTIMER_getNextExpiry(&expiry) == TRUE)
+	{
+		timeoutMs = (sint32)(expiry - SYSTICK_getTicks());
+		if(timeoutMs < 0)
+		{
+			timeoutMs = 0;
 		}
+		else if(timeoutMs > IDLE_MAX_SLEEP_MS)
+		{
+			timeoutMs = IDLE_MAX_SLEEP_MS;
+		}
+	}
+	return LINK_waitFrame(frame, (uint16)timeoutMs);
+#else
+	/* the last bytes of the panel selected before may still come and start a frame that never completes */
+	uint32 deadline = SYSTICK_getDeadline(PANEL_SLOT_MS + PANEL_FRAME_MS);
+
+	do
+	{
+		if(LINK_waitFrame(frame, PANEL_SLOT_MS) == TRUE)
+		{
+			return TRUE;
+		}
+	}while((LINK_isReceiving() == TRUE) && (SYSTICK_isExpired(deadline) == FALSE));
+
+	return FALSE;
+#endif
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  releasePanel
+[Description]:  Function to deselect the panel of the last turn before another one is selected,
+				the bytes it has started before the address reached it are waited for
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the bus is free, FALSE if the panel has started a request that it must complete
+------------------------------------------------------------------*/
+boolean releasePanel(void)
+{
+	UART_Statistics before;
+	UART_Statistics after;
+	uint32 deadline;
+
+	/* a panel sends till an address frame reaches it ... so it may have a byte on the line and
+	 * another one in UDR by then, the next panel would send over them if it were selected at once */
+	UART_getStatistics(&before);
+	UART_sendAddress(UART_MASTER_ADDRESS);
+	UART_flush();
+
+	deadline = SYSTICK_getDeadline(PANEL_RELEASE_MS);
+	while(SYSTICK_isExpired(deadline) == FALSE)
+	{
+		SYSTICK_sleepUntil(deadline);
 	}
+
+	UART_getStatistics(&after);
+	return (after.rxBytes == before.rxBytes);
 }
 
 
@@ -155,15 +342,11 @@ uint8 compareTwoPasswords(uint8 * pass1,uint8 * pass2)
 ------------------------------------------------------------------*/
 void checkIfPassExist(void)
 {
-	uint8 check;
-	/* check if the password exist or not */
-	EEPROM_readByte(0x00F0 - 1, &check);
-	_delay_ms(10);
-	/* if it exist tell the HMI ECU that there is a password saved */
-	if(check == PASS_EXIST)
-		UART_sendByte(PASS_EXIST);
+	/* if it exist tell the HMI ECU that there is a password saved ... answered from the cache */
+	if(CRED_exists() == TRUE)
+		LINK_reply(PASS_EXIST, NULL_PTR, 0);
 	else
-		UART_sendByte(ERROR);
+		LINK_reply(ERROR, NULL_PTR, 0);
 }
 
 
@@ -182,9 +365,10 @@ void checkIfPassExist(void)
 void resetPass(void)
 {
 	/* Delete the OLD password  " Deletes the password_exist byte " */
-	EEPROM_writeByte(0x00F0 - 1, 0x00);
-	_delay_ms(10);
-	UART_sendByte(RESET_COMPLETE);
+	if(CRED_erase() == TRUE)
+		LINK_reply(RESET_COMPLETE, NULL_PTR, 0);
+	else
+		LINK_reply(ERROR, NULL_PTR, 0);
 }
 
 
@@ -205,35 +389,19 @@ void resetPass(void)
 ------------------------------------------------------------------*/
 void setupNewPassword(uint8 * pass1, uint8 * pass2)
 {
-	uint8 i;
-	/* get the password */
-	for(i=0;i<PASSWORD_SIZE;i++)
-	{
-		pass1[i] = UART_receiveByte();
-	}
-	/* get the password confirmation */
-	for(i=0;i<PASSWORD_SIZE;i++)
-	{
-		pass2[i] = UART_receiveByte();
-	}
 	/* compare the two passwords */
 	if(compareTwoPasswords(pass1, pass2) == OK)
 	{
-		/* if they Matched save the password */
-		for(i=0;i<PASSWORD_SIZE;i++)
-		{
-			EEPROM_writeByte(0x00F0+i, pass1[i]);
-			_delay_ms(10);
-		}
-		/* sets a byte before the current password to say that password exists ... used in case of power off */
-		EEPROM_writeByte(0x00F0 - 1, PASS_EXIST);
-		_delay_ms(10);
-		UART_sendByte(NEW_PASS_SAVED);
+		/* if they Matched save the password in the EEPROM and the cache */
+		if(CRED_save(pass1) == TRUE)
+			LINK_reply(NEW_PASS_SAVED, NULL_PTR, 0);
+		else
+			LINK_reply(ERROR, NULL_PTR, 0);
 	}
 	/* if they don't match send error */
 	else
 	{
-		UART_sendByte(ERROR);
+		LINK_reply(ERROR, NULL_PTR, 0);
 	}
 }
 
@@ -246,34 +414,26 @@ void setupNewPassword(uint8 * pass1, uint8 * pass2)
 [Description]:  function to check if the password is Right or Wrong
 [Args]:
 [in]	uint8 * pass:
-					Pointer to the password array
+					Pointer to the received password array
 [out]	-NONE
 [in/out] -NONE
-[Returns]: whether the password is Right or Wrong
+[Returns]: Nothing
 ------------------------------------------------------------------*/
-void checkPassword(uint8 * pass1, uint8 * pass2)
+void checkPassword(uint8 * pass)
 {
-	uint8 i;
-	/* receive the first password */
-	for(i=0;i<PASSWORD_SIZE;i++)
-	{
-		pass1[i] = UART_receiveByte();
-	}
-	/* read the password saved in the EEPROM */
-	for(i=0;i<PASSWORD_SIZE;i++)
-	{
-		EEPROM_readByte(0x00F0+i, pass2+i);
-		_delay_ms(10);
-	}
-	/* if they matched tell the HMI_ECU that passwrod is right */
-	if(compareTwoPasswords(pass1, pass2) == OK)
+	PROF_BEGIN(PROF_CHECK_PASSWORD);
+
+	/* if it matched the saved one tell the HMI_ECU that passwrod is right ... answered from the cache */
+	if(CRED_check(pass) == TRUE)
 	{
-		UART_sendByte(PASS_CORRECT);
+		LINK_reply(PASS_CORRECT, NULL_PTR, 0);
 	}
 	else
 	{
-		UART_sendByte(ERROR);
+		LINK_reply(ERROR, NULL_PTR, 0);
 	}
+
+	PROF_END(PROF_CHECK_PASSWORD);
 }
 
 
@@ -282,7 +442,8 @@ void checkPassword(uint8 * pass1, uint8 * pass2)
 
 /*------------------------------------------------------------------
 [Function Name]:  openDoor
-[Description]:  Function to Open the door
+[Description]:  Function to start the door open cycle without waiting, during the cycle
+				it re-opens the door if it is locking or holds it open for longer
 [Args]:
 [in]	-NONE
 [out]	-NONE
@@ -291,20 +452,49 @@ void checkPassword(uint8 * pass1, uint8 * pass2)
 ------------------------------------------------------------------*/
 void openDoor(void)
 {
-	/* unlock the door for 15 sec */
-	DC_MOTOR_rotate(CW, 100);
-	delaySeconds(15);
+	switch(g_doorState)
+	{
+	case DOOR_LOCKED:
+	case DOOR_LOCKING:
+		/* unlock the door ... from where it is if it was locking */
+		startDoorPhase(DOOR_UNLOCKING);
+		break;
+
+	case DOOR_OPEN:
+		/* hold the door for another DOOR_HOLD_MS */
+		startDoorPhase(DOOR_OPEN);
+		break;
+
+	case DOOR_UNLOCKING:
+		break;
+	}
+
+	/* the command is taken ... the HMI ECU stops repeating it */
+	LINK_reply(OPEN_DOOR, NULL_PTR, 0);
+}
+
+
 
-	/* Hold the door for 3 sec */
-	DC_MOTOR_rotate(STOP, 100);
-	delaySeconds(3);
 
-	/* lock the door for 15 sec */
-	DC_MOTOR_rotate(A_CW, 100);
-	delaySeconds(15);
 
-	/* Stop the motor */
-	DC_MOTOR_rotate(STOP, 100);
+/*------------------------------------------------------------------
+[Function Name]:  abortDoor
+[Description]:  Function to end the door open cycle by locking the door from where it is
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void abortDoor(void)
+{
+	if((g_doorState == DOOR_UNLOCKING) || (g_doorState == DOOR_OPEN))
+	{
+		startDoorPhase(DOOR_LOCKING);
+	}
+
+	/* answered even if the door isn't moved ... the HMI ECU repeats it till the answer comes */
+	LINK_reply(ABORT_DOOR, NULL_PTR, 0);
 }
 
 
@@ -313,7 +503,7 @@ void openDoor(void)
 
 /*------------------------------------------------------------------
 [Function Name]:  activateAlarm
-[Description]:  Function to Activate the alarm
+[Description]:  Function to Activate the alarm, it's turned off by a timer without waiting
 [Args]:
 [in]	-NONE
 [out]	-NONE
@@ -324,8 +514,10 @@ void activateAlarm(void)
 {
 	/* Turn on the buzzer for a minute */
 	Buzzer_on();
-	delaySeconds(60);
-	Buzzer_off();
+	SWTIMER_start(&g_alarmTimer, ALARM_ON_MS, 0, Buzzer_off);
+
+	/* answered once the buzzer is on ... a repeated command only restarts the minute */
+	LINK_reply(ACTIVATE_THE_ALERT, NULL_PTR, 0);
 }
 
 
@@ -333,42 +525,137 @@ void activateAlarm(void)
 
 
 /*------------------------------------------------------------------
-[Function Name]:  countSec
-[Description]:  function to increase the number of seconds by one whenever it called
+[Function Name]:  sendDiagnostics
+[Description]:  Function to answer the HMI ECU with a page of the link counters
 [Args]:
-[in]	-NONE
+[in]	uint8 page:
+					the requested page number (DIAG_PAGE_xxx)
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void countSec(void)
+void sendDiagnostics(uint8 page)
 {
-	g_sec++;
+	uint8 payload[FRAME_MAX_PAYLOAD_SIZE];
+	uint8 length = DIAG_fillPage(page, payload);
+
+	if(length == 0)
+		LINK_reply(ERROR, NULL_PTR, 0);
+	else
+		LINK_reply(DIAGNOSTICS, payload, length);
 }
 
 
 
 
+
 /*------------------------------------------------------------------
-[Function Name]:  delaySeconds
-[Description]:  Function to wait a certain amount of seconds
+[Function Name]:  startDoorPhase
+[Description]:  Function to drive the motor for a door phase and time the phase
 [Args]:
-[in]	uint8 sec:
-					number of seconds you want to wait
+[in]	DOOR_State state:
+					the new phase
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void delaySeconds(uint8 sec)
+static void startDoorPhase(DOOR_State state)
 {
-	/* setting the callBack function to count seconds */
-	Timer1_setCallBack(countSec);
-	/* timer1 configurations to count sec per interrupt */
-	Timer1_ConfigType timer1Config = {0,31250,CLK_256,COMPARE_MODE};
+	uint32 duration;
 
-	Timer1_init(&timer1Config);
-	while(g_sec < sec);
-	g_sec = 0;
-	Timer1_deInit();
+	/* the door may be stopped half way ... the next phase starts from there */
+	g_doorPosition = getDoorPosition();
+	g_doorPhaseStart = SYSTICK_getTicks();
+	g_doorState = state;
 
+	switch(state)
+	{
+	case DOOR_UNLOCKING:
+		DC_MOTOR_rotate(CW, 100);
+		duration = DOOR_MOVE_MS - g_doorPosition;
+		break;
+
+	case DOOR_OPEN:
+		DC_MOTOR_rotate(STOP, 100);
+		duration = DOOR_HOLD_MS;
+		break;
+
+	case DOOR_LOCKING:
+		DC_MOTOR_rotate(A_CW, 100);
+		duration = g_doorPosition;
+		break;
+
+	default:
+		/* Stop the motor */
+		DC_MOTOR_rotate(STOP, 100);
+		SWTIMER_cancel(&g_doorTimer);
+		return;
+	}
+	SWTIMER_start(&g_doorTimer, duration, 0, doorTimeoutCallback);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  getDoorPosition
+[Description]:  Function to estimate how far the door is open from the time the motor has run
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the door position from 0 (locked) to DOOR_MOVE_MS (open)
+------------------------------------------------------------------*/
+static uint32 getDoorPosition(void)
+{
+	uint32 elapsed = SYSTICK_getTicks() - g_doorPhaseStart;
+
+	switch(g_doorState)
+	{
+	case DOOR_UNLOCKING:
+		return ((g_doorPosition + elapsed) > DOOR_MOVE_MS) ? DOOR_MOVE_MS : (g_doorPosition + elapsed);
+
+	case DOOR_LOCKING:
+		return (elapsed >= g_doorPosition) ? 0 : (g_doorPosition - elapsed);
+
+	case DOOR_OPEN:
+		return DOOR_MOVE_MS;
+
+	default:
+		return 0;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  doorTimeoutCallback
+[Description]:  Function called by the door timer at the end of every phase
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void doorTimeoutCallback(void)
+{
+	switch(g_doorState)
+	{
+	case DOOR_UNLOCKING:
+		/* Hold the door */
+		startDoorPhase(DOOR_OPEN);
+		break;
+
+	case DOOR_OPEN:
+		/* lock the door */
+		startDoorPhase(DOOR_LOCKING);
+		break;
+
+	default:
+		startDoorPhase(DOOR_LOCKED);
+		break;
+	}
 }
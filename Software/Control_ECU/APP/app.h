@@ -14,6 +14,8 @@
 #define APP_H_
 
 #include "std_types.h"
+#include "frame.h"
+#include "cred.h"
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -24,7 +26,50 @@
 #define OK							1u
 #define PASS_EXIST					0xCC
 
-/* UART Commands */
+#if(PASSWORD_SIZE != CRED_PASSWORD_SIZE)
+#error "PASSWORD_SIZE should be the same as CRED_PASSWORD_SIZE"
+#endif
+
+/* the baud rate fallback is checked every this time */
+#define LINK_CHECK_PERIOD_MS		200
+
+/*
+ * One keypad/LCD panel has the UART to itself (8 data bits and no address frames).
+ * More panels are opt-in: -DNUM_OF_PANELS=2 -DPANEL_ADDRESSES="{1,2}" (PANEL_ADDRESS of each HMI ECU),
+ * they share the UART as slaves on a multi-drop bus (uart.h), the Control ECU selects them
+ * round robin and serves one request per turn ... the baud rate can't be negotiated then.
+ */
+#ifndef NUM_OF_PANELS
+#define NUM_OF_PANELS				1
+#define PANEL_ADDRESSES				{UART_MASTER_ADDRESS}
+#endif
+
+#ifndef PANEL_ADDRESSES
+#error "PANEL_ADDRESSES should list the NUM_OF_PANELS addresses of the panels"
+#endif
+
+#if(NUM_OF_PANELS == 1)
+#define PANEL_DATABITS				EIGHT_DATABITS
+#else
+#define PANEL_DATABITS				NINE_DATABITS
+#endif
+
+/* time a selected panel gets to start sending a request before the next one is selected (more than one panel) */
+#define PANEL_SLOT_MS				5
+
+/* time a request that has started in the slot gets to complete (the longest frame takes about 24 ms at 9600 baud) */
+#define PANEL_FRAME_MS				30
+
+/* time the deselected panel gets to send the byte it has started and the one behind it (2.3 ms at 9600 baud) */
+#define PANEL_RELEASE_MS			4
+
+/* time the motor takes to fully unlock or lock the door, time the door is held open and the alarm time */
+#define DOOR_MOVE_MS				15000
+#define DOOR_HOLD_MS				3000
+#define ALARM_ON_MS					60000
+
+/* UART Commands ... carried in the TYPE field of a frame */
+#define DIAGNOSTICS					0xF0
 #define HMI_READY					0xFF
 #define SETTING_UP_A_NEW_PASS		0xF1
 #define NEW_PASS_SAVED				0xF2
@@ -35,6 +80,24 @@
 #define CHECK_IF_PASS_EXIST			0xF7
 #define RESET_PASS					0xF8
 #define RESET_COMPLETE				0xF9
+#define ABORT_DOOR					0xFE
+/* 0xFA -> 0xFD are used by the baud rate negotiation (baud.h) */
+/* DIAGNOSTICS carries a 1-byte page number (diag.h) and is answered with the page itself */
+/* OPEN_DOOR during the locking re-opens the door, ABORT_DOOR locks it before the cycle ends */
+/* OPEN_DOOR, ABORT_DOOR and ACTIVATE_THE_ALERT are answered with their own type once they are taken */
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[ENUM Name]: DOOR_State
+[ENUM Description]: it's used to define the phase of the door open cycle
+------------------------------------------------------------------*/
+typedef enum
+{
+	DOOR_LOCKED,DOOR_UNLOCKING,DOOR_OPEN,DOOR_LOCKING
+}DOOR_State;
 
 
 /*******************************************************************************
@@ -56,37 +119,41 @@ void app(void);
 
 
 /*------------------------------------------------------------------
-[Function Name]:  countSec
-[Description]:  function to increase the number of seconds by one whenever it called
+[Function Name]:  waitPanelRequest
+[Description]:  Function to wait for a request from the selected panel during its slot,
+				a frame that has already started is given PANEL_FRAME_MS more to complete ...
+				a single panel is waited for till the next software timer expires
 [Args]:
 [in]	-NONE
-[out]	-NONE
+[out]	FRAME_Message * frame:
+					pointer to the structure you want to save the request in
 [in/out] -NONE
-[Returns]: Nothing
+[Returns]: TRUE if a request is received, FALSE if the panel has nothing to send
 ------------------------------------------------------------------*/
-void countSec(void);
+boolean waitPanelRequest(FRAME_Message * frame);
 
 
 
 
 /*------------------------------------------------------------------
-[Function Name]:  delaySeconds
-[Description]:  Function to wait a certain amount of seconds
+[Function Name]:  releasePanel
+[Description]:  Function to deselect the panel of the last turn before another one is selected,
+				the bytes it has started before the address reached it are waited for
 [Args]:
-[in]	uint8 sec:
-					number of seconds you want to wait
+[in]	-NONE
 [out]	-NONE
 [in/out] -NONE
-[Returns]: Nothing
+[Returns]: TRUE if the bus is free, FALSE if the panel has started a request that it must complete
 ------------------------------------------------------------------*/
-void delaySeconds(uint8 sec);
+boolean releasePanel(void);
 
 
 
 
 /*------------------------------------------------------------------
 [Function Name]:  openDoor
-[Description]:  Function to Open the door
+[Description]:  Function to start the door open cycle without waiting, during the cycle
+				it re-opens the door if it is locking or holds it open for longer
 [Args]:
 [in]	-NONE
 [out]	-NONE
@@ -98,9 +165,23 @@ void openDoor(void);
 
 
 
+/*------------------------------------------------------------------
+[Function Name]:  abortDoor
+[Description]:  Function to end the door open cycle by locking the door from where it is
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void abortDoor(void);
+
+
+
+
 /*------------------------------------------------------------------
 [Function Name]:  activateAlarm
-[Description]:  Function to Activate the alarm
+[Description]:  Function to Activate the alarm, it's turned off by a timer without waiting
 [Args]:
 [in]	-NONE
 [out]	-NONE
@@ -134,12 +215,12 @@ void setupNewPassword(uint8 * pass1, uint8 * pass2);
 [Description]:  function to check if the password is Right or Wrong
 [Args]:
 [in]	uint8 * pass:
-					Pointer to the password array
+					Pointer to the received password array
 [out]	-NONE
 [in/out] -NONE
-[Returns]: whether the password is Right or Wrong
+[Returns]: Nothing
 ------------------------------------------------------------------*/
-void checkPassword(uint8 * pass1, uint8 * pass2);
+void checkPassword(uint8 * pass);
 
 
 
@@ -188,4 +269,19 @@ void resetPass(void);
 
 
 
+
+/*------------------------------------------------------------------
+[Function Name]:  sendDiagnostics
+[Description]:  Function to answer the HMI ECU with a page of the link counters
+[Args]:
+[in]	uint8 page:
+					the requested page number (DIAG_PAGE_xxx)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void sendDiagnostics(uint8 page);
+
+
+
 #endif /* APP_H_ */
@@ -11,15 +11,189 @@
  *******************************************************************************/
 #include "external_eeprom.h"
 
-#include "i2c.h"
+#include "prof.h"
+#include "systick.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* 7-bit address of the 24Cxx ... the block (bits 8 -> 10 of the memory address) is added to it */
+#define EEPROM_DEVICE_ADDRESS		0x50
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* whether the EEPROM is saving the last write and the SYSTICK_getCounts value when it started */
+static volatile boolean g_writeInProgress = FALSE;
+static uint32 g_writeStart;
+
+/* address probe sent again and again by its callback from the STOP of a write till it is acknowledged */
+static I2C_Transfer g_probe;
+static volatile boolean g_probing = FALSE;
+static uint32 g_probeDeadline;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static uint8 EEPROM_waitReady(void);
+
+static void EEPROM_setupTransfer(I2C_Transfer * transfer, uint16 u16addr);
+
+static uint8 EEPROM_runTransfer(I2C_Transfer * transfer);
+
+static void EEPROM_startProbe(void);
+
+static void EEPROM_probeDone(I2C_Transfer * transfer);
 
 /*******************************************************************************
  *                      Functions Definition                                   *
  *******************************************************************************/
 
+/*------------------------------------------------------------------
+[Function Name]:  EEPROM_waitReady
+[Description]: wait for the write cycle of the last write, the EEPROM address is polled
+				in the background by EEPROM_startProbe till it is acknowledged (ACK polling) ...
+				the polling is started again if the last one gave up
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: SUCCESS if the EEPROM is ready or ERROR if it doesn't answer in EEPROM_WRITE_TIMEOUT_MS
+------------------------------------------------------------------*/
+static uint8 EEPROM_waitReady(void)
+{
+	if((g_writeInProgress == TRUE) && (g_probing == FALSE))
+	{
+		EEPROM_startProbe();
+	}
+	if(g_probing == TRUE)
+	{
+		(void)I2C_wait(&g_probe);
+	}
+
+	/* still busy ... the next access polls it again */
+	return (g_writeInProgress == FALSE) ? SUCCESS : ERROR;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  EEPROM_startProbe
+[Description]: start polling the EEPROM address in the background right after the STOP of a write
+				so the write is known to be saved at its first ACK and not at the next access ...
+				the transfers queued meanwhile go between the probes
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void EEPROM_startProbe(void)
+{
+	g_probing = TRUE;
+	g_probeDeadline = SYSTICK_getDeadline(EEPROM_WRITE_TIMEOUT_MS);
+
+	/* a transfer without bytes only sends the address */
+	EEPROM_setupTransfer(&g_probe, 0);
+	g_probe.commandLength = 0;
+	g_probe.callback = EEPROM_probeDone;
+	I2C_submit(&g_probe);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  EEPROM_probeDone
+[Description]: callback of the background probe ... it ends the write when the address is
+				acknowledged or sends the probe again while it is NACKed, the time from the STOP of
+				the write is added to the PROF_EEPROM_WRITE_CYCLE row
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] I2C_Transfer * transfer:
+					the probe
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void EEPROM_probeDone(I2C_Transfer * transfer)
+{
+	if(transfer->status == I2C_DONE)
+	{
+		g_writeInProgress = FALSE;
+		PROF_RECORD(PROF_EEPROM_WRITE_CYCLE, SYSTICK_COUNTS_TO_US(SYSTICK_getCounts() - g_writeStart));
+	}
+	else if((transfer->errorStatus == I2C_MT_SLA_W_NACK) && (SYSTICK_isExpired(g_probeDeadline) == FALSE))
+	{
+		I2C_submit(transfer);
+		return;
+	}
+
+	/* the polling ends here ... after a failed probe the write is left in progress and the next access polls it again */
+	g_probing = FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  EEPROM_setupTransfer
+[Description]: fill a transfer that starts at a memory address, the block of the address is
+				sent in the device address and the rest of it as the command byte
+[Args]:
+[in]	uint16 u16addr:
+					Contains the memory address
+[out]	I2C_Transfer * transfer:
+					pointer to the transfer ... it has no data bytes and no callback
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void EEPROM_setupTransfer(I2C_Transfer * transfer, uint16 u16addr)
+{
+	transfer->address = EEPROM_DEVICE_ADDRESS | (uint8)((u16addr & 0x0700) >> 8);
+	transfer->command[0] = (uint8)(u16addr);
+	transfer->commandLength = 1;
+	transfer->writeData = NULL_PTR;
+	transfer->writeLength = 0;
+	transfer->readData = NULL_PTR;
+	transfer->readLength = 0;
+	transfer->callback = NULL_PTR;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  EEPROM_runTransfer
+[Description]: submit a transfer and sleep till it is done ... the interrupts are served meanwhile
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] I2C_Transfer * transfer:
+					pointer to the transfer
+[Returns]: SUCCESS if it is done or ERROR if it failed
+------------------------------------------------------------------*/
+static uint8 EEPROM_runTransfer(I2C_Transfer * transfer)
+{
+	I2C_submit(transfer);
+
+	return (I2C_wait(transfer) == I2C_DONE) ? SUCCESS : ERROR;
+}
+
+
+
+
+
 /*------------------------------------------------------------------
 [Function Name]:  EEPROM_writeByte
-[Description]: write a byte to the EEPROM
+[Description]: write a byte to the EEPROM, it returns without waiting for the write cycle
 [Args]:
 [in]	uint16 u16addr:
 					Contains the address you want to write your data in
@@ -31,22 +205,7 @@
 ------------------------------------------------------------------*/
 uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data)
 {
-	uint8 eepromAddress = 0b10100000 | (uint8)((u16addr & 0x0700) >> 7);
-	I2C_start();
-	if(I2C_getStatus() != I2C_START)
-		return ERROR;
-	I2C_writeByte(eepromAddress & 0xFE);
-	if(I2C_getStatus() != I2C_MT_SLA_W_ACK)
-		return ERROR;
-	I2C_writeByte((uint8)(u16addr));
-	if(I2C_getStatus() != I2C_MT_DATA_ACK)
-		return ERROR;
-	I2C_writeByte(u8data);
-	if(I2C_getStatus() != I2C_MT_DATA_ACK)
-		return ERROR;
-	I2C_stop();
-
-	return SUCCESS;
+	return EEPROM_writeBlock(u16addr, &u8data, 1);
 }
 
 
@@ -66,27 +225,144 @@ uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data)
 ------------------------------------------------------------------*/
 uint8 EEPROM_readByte(uint16 u16addr,uint8 *u8data)
 {
-	uint8 eepromAddress = 0b10100000 | (uint8)((u16addr & 0x0700) >> 7);
-	I2C_start();
-	if(I2C_getStatus() != I2C_START)
-		return ERROR;
-	I2C_writeByte(eepromAddress & 0xFE);
-	if(I2C_getStatus() != I2C_MT_SLA_W_ACK)
-		return ERROR;
-	I2C_writeByte((uint8)(u16addr));
-	if(I2C_getStatus() != I2C_MT_DATA_ACK)
+	I2C_Transfer transfer;
+
+	if(EEPROM_waitReady() != SUCCESS)
 		return ERROR;
-	I2C_start();
-	if(I2C_getStatus() != I2C_REP_START)
+
+	/* the wait for the last write cycle isn't part of the read */
+	PROF_BEGIN(PROF_EEPROM_READ);
+
+	EEPROM_setupTransfer(&transfer, u16addr);
+	transfer.readData = u8data;
+	transfer.readLength = 1;
+	if(EEPROM_runTransfer(&transfer) != SUCCESS)
 		return ERROR;
-	I2C_writeByte(eepromAddress | 0x01);
-	if(I2C_getStatus() != I2C_MT_SLA_R_ACK)
+
+	/* only the reads that succeed are timed */
+	PROF_END(PROF_EEPROM_READ);
+
+	return SUCCESS;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  EEPROM_writeBlock
+[Description]: write a number of bytes to the EEPROM with page writes, the block is split
+				at the page boundaries ... it waits for the write cycle of every page but the last one
+[Args]:
+[in]	uint16 u16addr:
+					Contains the address of the first byte
+		const uint8 *data:
+					pointer to the bytes you want to write
+		uint16 length:
+					number of bytes
+[out]	-NONE
+[in/out] -NONE
+[Returns]: whether the data is successfully written or not
+------------------------------------------------------------------*/
+uint8 EEPROM_writeBlock(uint16 u16addr, const uint8 *data, uint16 length)
+{
+	I2C_Transfer transfer;
+	uint16 pageLength;
+
+	while(length != 0)
+	{
+		/* the bytes after the end of the page would roll over to its start */
+		pageLength = EEPROM_PAGE_SIZE - (u16addr % EEPROM_PAGE_SIZE);
+		if(pageLength > length)
+		{
+			pageLength = length;
+		}
+
+		if(EEPROM_waitReady() != SUCCESS)
+			return ERROR;
+		EEPROM_setupTransfer(&transfer, u16addr);
+		transfer.writeData = data;
+		transfer.writeLength = pageLength;
+		if(EEPROM_runTransfer(&transfer) != SUCCESS)
+			return ERROR;
+
+		/* the page is saved after the stop bit ... the next page or access waits for it */
+		g_writeInProgress = TRUE;
+		g_writeStart = SYSTICK_getCounts();
+		EEPROM_startProbe();
+
+		u16addr += pageLength;
+		data += pageLength;
+		length -= pageLength;
+	}
+
+	return SUCCESS;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  EEPROM_readBlock
+[Description]: read a number of bytes from the EEPROM with one sequential read,
+				every byte is acknowledged but the last one
+[Args]:
+[in]	uint16 u16addr:
+					Contains the address of the first byte
+		uint16 length:
+					number of bytes
+[out]	uint8 *data:
+					pointer to the array you want to write the data in
+[in/out] -NONE
+[Returns]: whether the data is successfully read or not
+------------------------------------------------------------------*/
+uint8 EEPROM_readBlock(uint16 u16addr, uint8 *data, uint16 length)
+{
+	I2C_Transfer transfer;
+
+	if(length == 0)
+		return SUCCESS;
+	if(EEPROM_startRead(&transfer, u16addr, data, length, NULL_PTR) != SUCCESS)
 		return ERROR;
-	*u8data = I2C_readByteWithNACK();
-	if(I2C_getStatus() != I2C_MR_DATA_NACK)
+
+	return (I2C_wait(&transfer) == I2C_DONE) ? SUCCESS : ERROR;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  EEPROM_startRead
+[Description]: start a sequential read without waiting for its bytes, the transfer status is
+				I2C_PENDING till they are read and the callback is called from the TWI interrupt
+				when it is done ... it waits only if the EEPROM is saving a write
+[Args]:
+[in]	uint16 u16addr:
+					Contains the address of the first byte
+		uint16 length:
+					number of bytes
+		void (*callback)(I2C_Transfer * transfer):
+					called when the read is done, can be NULL_PTR
+[out]	uint8 *data:
+					pointer to the array you want to write the data in ... it must stay alive till the read is done
+[in/out] I2C_Transfer * transfer:
+					pointer to the transfer that holds the read ... it must stay alive till the read is done
+[Returns]: SUCCESS if the read is started or ERROR if the EEPROM is still saving a write
+------------------------------------------------------------------*/
+uint8 EEPROM_startRead(I2C_Transfer * transfer, uint16 u16addr, uint8 *data, uint16 length, void (*callback)(I2C_Transfer * transfer))
+{
+	if(EEPROM_waitReady() != SUCCESS)
 		return ERROR;
-	I2C_stop();
 
+	EEPROM_setupTransfer(transfer, u16addr);
+	transfer->readData = data;
+	transfer->readLength = length;
+	transfer->callback = callback;
+
+	/* the EEPROM keeps sending the next byte (across the blocks too) while the bytes are acknowledged */
+	I2C_submit(transfer);
 
 	return SUCCESS;
 }
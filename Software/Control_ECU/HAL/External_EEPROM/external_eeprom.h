@@ -13,6 +13,7 @@
 #define EXTERNAL_EEPROM_H_
 
 #include "std_types.h"
+#include "i2c.h"
 
 /*******************************************************************************
  *                      Preprocessor Macros                                    *
@@ -20,6 +21,15 @@
 #define ERROR 0
 #define SUCCESS 1
 
+/* the 24Cxx writes a page of this size in one write cycle, the pages start at multiples of it */
+#define EEPROM_PAGE_SIZE			16
+
+/*
+ * The EEPROM doesn't answer its address while it saves a write, the next access polls
+ * the address till it is acknowledged but gives up after this time (the 24C16 takes 5 ms at most)
+ */
+#define EEPROM_WRITE_TIMEOUT_MS		20
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -27,7 +37,7 @@
 
 /*------------------------------------------------------------------
 [Function Name]:  EEPROM_writeByte
-[Description]: write a byte to the EEPROM
+[Description]: write a byte to the EEPROM, it returns without waiting for the write cycle
 [Args]:
 [in]	uint16 u16addr:
 					Contains the address you want to write your data in
@@ -56,4 +66,66 @@ uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data);
 ------------------------------------------------------------------*/
 uint8 EEPROM_readByte(uint16 u16addr,uint8 *u8data);
 
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  EEPROM_writeBlock
+[Description]: write a number of bytes to the EEPROM with page writes, the block is split
+				at the page boundaries ... it waits for the write cycle of every page but the last one
+[Args]:
+[in]	uint16 u16addr:
+					Contains the address of the first byte
+		const uint8 *data:
+					pointer to the bytes you want to write
+		uint16 length:
+					number of bytes
+[out]	-NONE
+[in/out] -NONE
+[Returns]: whether the data is successfully written or not
+------------------------------------------------------------------*/
+uint8 EEPROM_writeBlock(uint16 u16addr, const uint8 *data, uint16 length);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  EEPROM_readBlock
+[Description]: read a number of bytes from the EEPROM with one sequential read,
+				every byte is acknowledged but the last one
+[Args]:
+[in]	uint16 u16addr:
+					Contains the address of the first byte
+		uint16 length:
+					number of bytes
+[out]	uint8 *data:
+					pointer to the array you want to write the data in
+[in/out] -NONE
+[Returns]: whether the data is successfully read or not
+------------------------------------------------------------------*/
+uint8 EEPROM_readBlock(uint16 u16addr, uint8 *data, uint16 length);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  EEPROM_startRead
+[Description]: start a sequential read without waiting for its bytes, the transfer status is
+				I2C_PENDING till they are read and the callback is called from the TWI interrupt
+				when it is done ... it waits only if the EEPROM is saving a write
+[Args]:
+[in]	uint16 u16addr:
+					Contains the address of the first byte
+		uint16 length:
+					number of bytes
+		void (*callback)(I2C_Transfer * transfer):
+					called when the read is done, can be NULL_PTR
+[out]	uint8 *data:
+					pointer to the array you want to write the data in ... it must stay alive till the read is done
+[in/out] I2C_Transfer * transfer:
+					pointer to the transfer that holds the read ... it must stay alive till the read is done
+[Returns]: SUCCESS if the read is started or ERROR if the EEPROM is still saving a write
+------------------------------------------------------------------*/
+uint8 EEPROM_startRead(I2C_Transfer * transfer, uint16 u16addr, uint8 *data, uint16 length, void (*callback)(I2C_Transfer * transfer));
+
 #endif /* EXTERNAL_EEPROM_H_ */
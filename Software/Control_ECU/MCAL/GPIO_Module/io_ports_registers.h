@@ -15,6 +15,11 @@
 
 #include "std_types.h"
 
+#ifdef HOST_BUILD
+/* the host build takes the ports from the emulated register file (Software/Host) */
+#include <avr/io.h>
+#else
+
 /*PORTD*/
 #define PIND (*((volatile const uint8 * const)0x30))
 #define DDRD (*((volatile uint8 * const)0x31))
@@ -34,14 +39,6 @@
 #define PINA (*((volatile const uint8 * const)0x39))
 #define DDRA (*((volatile uint8 * const)0x3A))
 #define PORTA (*((volatile uint8 * const)0x3B))
-
-
-
-
-
-
-
-
-
+#endif
 
 #endif /* IO_PORTS_REGISTERS_H_ */
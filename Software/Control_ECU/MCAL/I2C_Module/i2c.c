@@ -10,14 +10,248 @@
  *
  *******************************************************************************/
 #include "i2c.h"
+#include "systick.h"
 #include "common_macros.h"
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* TWCR values used by the interrupt ... TWINT is written 1 to clear it and start the next step */
+#define I2C_TWCR_NEXT			((1<<TWINT) | (1<<TWEN) | (1<<TWIE))
+#define I2C_TWCR_START			(I2C_TWCR_NEXT | (1<<TWSTA))
+#define I2C_TWCR_STOP			((1<<TWINT) | (1<<TWEN) | (1<<TWSTO))
+
+/* the TWI pins ... they are driven by PORTC while the bus is recovered */
+#define I2C_SCL_PIN				PC0
+#define I2C_SDA_PIN				PC1
+
+/* a slave in the middle of a byte releases SDA after its 8 bits and the ACK at most, clocked at 100 kHz */
+#define I2C_RECOVERY_CLOCKS		9
+#define I2C_RECOVERY_HALF_US	5
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* queue of the submitted transfers ... the head is the one on the bus */
+static I2C_Transfer * volatile g_head = NULL_PTR;
+static I2C_Transfer * g_tail = NULL_PTR;
+
+/* bytes of the current step (command & write data or read data) already done */
+static uint16 g_index;
+
+/* the configuration given to I2C_init ... used again after the bus is recovered */
+static I2C_ConfigType g_config;
+
+/* number of TWI interrupts (wraps) ... the step watchdog fires if it doesn't change */
+static volatile uint16 g_steps = 0;
+static uint16 g_watchedSteps = 0;
+static uint32 g_stepDeadline;
+
+/* set while the callback of a done transfer runs ... a transfer it submits is started by I2C_finish */
+static boolean g_inCallback = FALSE;
+
+/* whether the last step of the blocking functions has timed out */
+static boolean g_stepTimedOut = FALSE;
+
+/* error counters since power up */
+static volatile I2C_Statistics g_stats;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void I2C_finish(I2C_TransferStatus status, uint8 twiStatus);
+
+static void I2C_waitStep(void);
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+ISR(TWI_vect)
+{
+	I2C_Transfer * transfer = g_head;
+	uint8 status = TWSR & 0xF8;
+	uint16 writeLength;
+
+	g_steps++;
+	if(transfer == NULL_PTR)
+	{
+		/* nothing to do ... release the bus */
+		TWCR = I2C_TWCR_STOP;
+		return;
+	}
+	writeLength = transfer->commandLength + transfer->writeLength;
+
+	switch(status)
+	{
+	case I2C_START:
+		/* a transfer that only reads doesn't need the write part */
+		g_index = 0;
+		if((writeLength == 0) && (transfer->readLength != 0))
+		{
+			TWDR = (uint8)((transfer->address << 1) | 0x01);
+		}
+		else
+		{
+			TWDR = (uint8)(transfer->address << 1);
+		}
+		TWCR = I2C_TWCR_NEXT;
+		break;
+
+	case I2C_REP_START:
+		g_index = 0;
+		TWDR = (uint8)((transfer->address << 1) | 0x01);
+		TWCR = I2C_TWCR_NEXT;
+		break;
+
+	case I2C_MT_SLA_W_ACK:
+	case I2C_MT_DATA_ACK:
+		if(g_index < writeLength)
+		{
+			/* the command bytes go first then the write data */
+			if(g_index < transfer->commandLength)
+			{
+				TWDR = transfer->command[g_index];
+			}
+			else
+			{
+				TWDR = transfer->writeData[g_index - transfer->commandLength];
+			}
+			g_index++;
+			TWCR = I2C_TWCR_NEXT;
+		}
+		else if(transfer->readLength != 0)
+		{
+			TWCR = I2C_TWCR_START;
+		}
+		else
+		{
+			I2C_finish(I2C_DONE, status);
+		}
+		break;
+
+	case I2C_MT_SLA_R_ACK:
+		/* every byte is acknowledged but the last one */
+		TWCR = (transfer->readLength > 1) ? (I2C_TWCR_NEXT | (1<<TWEA)) : I2C_TWCR_NEXT;
+		break;
+
+	case I2C_MR_DATA_ACK:
+		transfer->readData[g_index] = TWDR;
+		g_index++;
+		TWCR = (g_index < (transfer->readLength - 1)) ? (I2C_TWCR_NEXT | (1<<TWEA)) : I2C_TWCR_NEXT;
+		break;
+
+	case I2C_MR_DATA_NACK:
+		transfer->readData[g_index] = TWDR;
+		I2C_finish(I2C_DONE, status);
+		break;
+
+	default:
+		/* NACK, arbitration lost or a bus error ... the bus is released by the STOP (it also clears a bus error) */
+		if((status == I2C_BUS_ERROR) || (status == I2C_ARBITRATION_LOST))
+		{
+			g_stats.busErrors++;
+		}
+		else if((writeLength != 0) || (transfer->readLength != 0))
+		{
+			/* an address only transfer is a probe so its NACK is expected (EEPROM ACK polling) */
+			g_stats.nacks++;
+		}
+		I2C_finish(I2C_FAILED, status);
+		break;
+	}
+}
 
 /*******************************************************************************
  *                      Functions Definition                                   *
  *******************************************************************************/
 
+/*------------------------------------------------------------------
+[Function Name]:  I2C_finish
+[Description]: end the transfer on the bus with STOP, start the next queued one and
+				call the callback of the ended one ... called by the ISR
+[Args]:
+[in]	I2C_TransferStatus status:
+					I2C_DONE or I2C_FAILED
+		uint8 twiStatus:
+					the TWI status of the last step
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void I2C_finish(I2C_TransferStatus status, uint8 twiStatus)
+{
+	I2C_Transfer * transfer = g_head;
+
+	g_head = transfer->next;
+	if(g_head == NULL_PTR)
+	{
+		g_tail = NULL_PTR;
+	}
+
+	transfer->next = NULL_PTR;
+	transfer->errorStatus = (status == I2C_FAILED) ? twiStatus : 0;
+	transfer->status = status;
+
+	/* the callback can submit the next transfer, it is only queued so TWCR is written once below */
+	if(transfer->callback != NULL_PTR)
+	{
+		g_inCallback = TRUE;
+		transfer->callback(transfer);
+		g_inCallback = FALSE;
+	}
+
+	if(g_head == NULL_PTR)
+	{
+		TWCR = I2C_TWCR_STOP;
+	}
+	else
+	{
+		/* the TWI sends the STOP then the START of the next transfer */
+		TWCR = I2C_TWCR_STOP | (1<<TWIE) | (1<<TWSTA);
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_waitStep
+[Description]: wait for TWINT after a step of the blocking functions but give up after
+				I2C_STEP_TIMEOUT_MS, I2C_getStatus returns I2C_STEP_TIMEOUT if it is given up
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void I2C_waitStep(void)
+{
+	uint32 deadline = SYSTICK_getDeadline(I2C_STEP_TIMEOUT_MS);
+
+	g_stepTimedOut = FALSE;
+	while(BIT_IS_CLEAR(TWCR,TWINT))
+	{
+		if(SYSTICK_isExpired(deadline) == TRUE)
+		{
+			g_stepTimedOut = TRUE;
+			g_stats.timeouts++;
+			return;
+		}
+	}
+}
+
+
+
+
+
 /*------------------------------------------------------------------
 [Function Name]:  I2C_init
 [Description]: initialize I2C (TWI) Interface
@@ -30,6 +264,9 @@
 ------------------------------------------------------------------*/
 void I2C_init(I2C_ConfigType * config)
 {
+	/* kept for I2C_recoverBus */
+	g_config = *config;
+
 	/* Enable I2C */
 	TWCR = (1<<TWEN);
 	/* Setup Two Wire Bus address my address if any master device want to call me */
@@ -86,7 +323,7 @@ void I2C_start(void)
 	TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWSTA);
 
 	/* Wait for TWINT flag set in TWCR Register (start bit is send successfully) */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	I2C_waitStep();
 }
 
 
@@ -137,7 +374,7 @@ void I2C_writeByte(uint8 data)
 	 */
 	TWCR = (1<<TWINT) | (1<<TWEN);
     /* Wait for TWINT flag set in TWCR Register(data is send successfully) */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	I2C_waitStep();
 }
 
 
@@ -163,7 +400,7 @@ uint8 I2C_readByteWithACK(void)
 	TWCR = (1<<TWINT) | (1<<TWEN) | (1<<TWEA);
 
 	/* Wait for TWINT flag set in TWCR Register (data received successfully) */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	I2C_waitStep();
 
 	/* Read Data */
 	return TWDR;
@@ -191,7 +428,7 @@ uint8 I2C_readByteWithNACK(void)
 	TWCR = (1<<TWINT) | (1<<TWEN);
 
     /* Wait for TWINT flag set in TWCR Register (data received successfully) */
-	while(BIT_IS_CLEAR(TWCR,TWINT));
+	I2C_waitStep();
 
 	/* Read Data */
 	return TWDR;
@@ -203,7 +440,7 @@ uint8 I2C_readByteWithNACK(void)
 
 /*------------------------------------------------------------------
 [Function Name]:  I2C_getStatus
-[Description]: send the start bit
+[Description]: get the status of the last step, I2C_STEP_TIMEOUT if it has timed out
 [Args]:
 [in]	-NONE
 [out]	-NONE
@@ -212,6 +449,232 @@ uint8 I2C_readByteWithNACK(void)
 ------------------------------------------------------------------*/
 uint8 I2C_getStatus(void)
 {
+	if(g_stepTimedOut == TRUE)
+	{
+		return I2C_STEP_TIMEOUT;
+	}
 	/* masking to eliminate first 3 bits and get the last 5 bits (status bits) */
 	return (TWSR & 0xF8);
 }
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_submit
+[Description]: queue a transfer without waiting, it is done by the TWI interrupt after the ones
+				queued before it ... its status is I2C_PENDING till then and its callback is called
+				from the interrupt when it is done, the interrupts must be enabled and a pending
+				transfer must not be submitted again
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] I2C_Transfer * transfer:
+					pointer to the transfer
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void I2C_submit(I2C_Transfer * transfer)
+{
+	uint8 sreg;
+
+	transfer->next = NULL_PTR;
+	transfer->status = I2C_PENDING;
+
+	/* the queue is shared with the ISR so it is changed with the interrupts disabled */
+	sreg = SREG;
+	cli();
+	if(g_head == NULL_PTR)
+	{
+		/* the bus is free ... start the transfer now (I2C_finish starts it after the STOP if it is
+		 * submitted by a callback), the watchdog starts from here */
+		g_steps++;
+		g_head = transfer;
+		g_tail = transfer;
+		if(g_inCallback == FALSE)
+		{
+			TWCR = I2C_TWCR_START;
+		}
+	}
+	else
+	{
+		g_tail->next = transfer;
+		g_tail = transfer;
+	}
+	SREG = sreg;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_isIdle
+[Description]: check if all the submitted transfers are done
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if no transfer is queued, FALSE otherwise
+------------------------------------------------------------------*/
+boolean I2C_isIdle(void)
+{
+	I2C_checkTimeout();
+	return (g_head == NULL_PTR) ? TRUE : FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_wait
+[Description]: sleep till a submitted transfer is done, the status is checked with the
+				interrupts disabled so a transfer done just before sleeping still wakes the CPU up ...
+				a transfer that stops moving fails with I2C_STEP_TIMEOUT (see I2C_checkTimeout)
+[Args]:
+[in]	const I2C_Transfer * transfer:
+					pointer to the transfer
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the status of the transfer (I2C_DONE or I2C_FAILED)
+------------------------------------------------------------------*/
+I2C_TransferStatus I2C_wait(const I2C_Transfer * transfer)
+{
+	cli();
+	while(transfer->status == I2C_PENDING)
+	{
+		/* it enables the interrupts again just before sleeping ... the TWI interrupt wakes the CPU up */
+		SYSTICK_sleepUntil(SYSTICK_getDeadline(I2C_STEP_TIMEOUT_MS));
+		I2C_checkTimeout();
+		cli();
+	}
+	sei();
+
+	return transfer->status;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_checkTimeout
+[Description]: fail the transfer on the bus if no TWI interrupt has come for I2C_STEP_TIMEOUT_MS,
+				the bus is recovered and the next transfer is started ... it is called by I2C_wait
+				and I2C_isIdle so a transfer nobody waits for is checked only when it is polled
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void I2C_checkTimeout(void)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	if(g_head == NULL_PTR)
+	{
+		/* nothing to watch */
+	}
+	else if(g_steps != g_watchedSteps)
+	{
+		/* the bus has moved since the last check */
+		g_watchedSteps = g_steps;
+		g_stepDeadline = SYSTICK_getDeadline(I2C_STEP_TIMEOUT_MS);
+	}
+	else if(SYSTICK_isExpired(g_stepDeadline) == TRUE)
+	{
+		g_stats.timeouts++;
+		I2C_recoverBus();
+		g_steps++;
+		I2C_finish(I2C_FAILED, I2C_STEP_TIMEOUT);
+	}
+	SREG = sreg;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_recoverBus
+[Description]: free a slave that holds SDA low by clocking SCL till it releases SDA then send
+				a STOP by hand and initialize the TWI again with the configuration of I2C_init ...
+				it must not be called while a transfer is on the bus (I2C_checkTimeout does it for them)
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if both lines are high after it, FALSE if the bus is still stuck
+------------------------------------------------------------------*/
+boolean I2C_recoverBus(void)
+{
+	uint8 i;
+
+	g_stats.recoveries++;
+
+	/*
+	 * give the pins back to PORTC ... the lines are open drain so a line is pulled low by
+	 * making its pin an output (PORT bit is 0) and released by making it an input
+	 */
+	TWCR = 0;
+	CLEAR_BIT(PORTC,I2C_SCL_PIN);
+	CLEAR_BIT(PORTC,I2C_SDA_PIN);
+	CLEAR_BIT(DDRC,I2C_SCL_PIN);
+	CLEAR_BIT(DDRC,I2C_SDA_PIN);
+	_delay_us(I2C_RECOVERY_HALF_US);
+
+	for(i=0;(i<I2C_RECOVERY_CLOCKS) && BIT_IS_CLEAR(PINC,I2C_SDA_PIN);i++)
+	{
+		SET_BIT(DDRC,I2C_SCL_PIN);
+		_delay_us(I2C_RECOVERY_HALF_US);
+		CLEAR_BIT(DDRC,I2C_SCL_PIN);
+		_delay_us(I2C_RECOVERY_HALF_US);
+	}
+
+	/* STOP ... SDA goes high while SCL is high */
+	SET_BIT(DDRC,I2C_SCL_PIN);
+	SET_BIT(DDRC,I2C_SDA_PIN);
+	_delay_us(I2C_RECOVERY_HALF_US);
+	CLEAR_BIT(DDRC,I2C_SCL_PIN);
+	_delay_us(I2C_RECOVERY_HALF_US);
+	CLEAR_BIT(DDRC,I2C_SDA_PIN);
+	_delay_us(I2C_RECOVERY_HALF_US);
+
+	I2C_init(&g_config);
+
+	if(BIT_IS_SET(PINC,I2C_SCL_PIN) && BIT_IS_SET(PINC,I2C_SDA_PIN))
+	{
+		return TRUE;
+	}
+	return FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_getStatistics
+[Description]: take a copy of the error counters
+[Args]:
+[in]	-NONE
+[out]	I2C_Statistics * stats:
+					pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void I2C_getStatistics(I2C_Statistics * stats)
+{
+	uint8 sreg = SREG;
+
+	/* the counters are changed by the ISR */
+	cli();
+	stats->timeouts = g_stats.timeouts;
+	stats->nacks = g_stats.nacks;
+	stats->busErrors = g_stats.busErrors;
+	stats->recoveries = g_stats.recoveries;
+	SREG = sreg;
+}
@@ -22,10 +22,30 @@
 #define I2C_START         0x08 /* start has been sent */
 #define I2C_REP_START     0x10 /* repeated start */
 #define I2C_MT_SLA_W_ACK  0x18 /* Master transmit ( slave address + Write request ) to slave + ACK received from slave. */
+#define I2C_MT_SLA_W_NACK 0x20 /* Master transmit ( slave address + Write request ) to slave + NACK received from slave. */
 #define I2C_MT_SLA_R_ACK  0x40 /* Master transmit ( slave address + Read request ) to slave + ACK received from slave. */
 #define I2C_MT_DATA_ACK   0x28 /* Master transmit data and ACK has been received from Slave. */
 #define I2C_MR_DATA_ACK   0x50 /* Master received data and send ACK to slave. */
 #define I2C_MR_DATA_NACK  0x58 /* Master received data but doesn't send ACK to slave. */
+#define I2C_ARBITRATION_LOST 0x38 /* another master has taken the bus */
+#define I2C_BUS_ERROR     0x00 /* illegal START or STOP condition */
+
+/* not a TWSR status ... I2C_getStatus returns it if the last blocking step has timed out */
+#define I2C_STEP_TIMEOUT  0x01
+
+/*
+ * Longest time a step (START, a byte or STOP) can take, a step takes less than 0.1 ms at 100 kb/s
+ * so a step that isn't done in this time means a slave is holding the bus
+ */
+#define I2C_STEP_TIMEOUT_MS		5
+
+/*
+ * The transfers submitted by I2C_submit are done by the TWI interrupt one after the other,
+ * the blocking functions (I2C_start ... I2C_readByteWithNACK) must not be used while a
+ * transfer is queued. A transfer can send up to I2C_MAX_COMMAND_SIZE command bytes
+ * (a register or a memory address) before its write data.
+ */
+#define I2C_MAX_COMMAND_SIZE	2
 
 /*******************************************************************************
  *                               Types Declaration                             *
@@ -54,6 +74,55 @@ typedef struct
 	uint8 address;
 }I2C_ConfigType;
 
+/*------------------------------------------------------------------
+[ENUM Name]: I2C_TransferStatus
+[ENUM Description]: it's used to report the state of a transfer submitted by I2C_submit
+------------------------------------------------------------------*/
+typedef enum
+{
+	I2C_PENDING,I2C_DONE,I2C_FAILED
+}I2C_TransferStatus;
+
+/*------------------------------------------------------------------
+[Structure Name]: I2C_Transfer
+[Structure Description]: it holds one transfer ... owned by the caller, it and its data must stay
+						alive till it is done. The bytes are sent in this order:
+						START, address + W, command, write data then if readLength isn't 0
+						a repeated START, address + R and the read data, then STOP.
+						A transfer without command, write or read bytes only checks
+						that the slave acknowledges its address
+------------------------------------------------------------------*/
+typedef struct I2C_Transfer
+{
+	struct I2C_Transfer * next;					/* used by the driver while it is queued */
+	uint8 address;								/* 7-bit slave address */
+	uint8 command[I2C_MAX_COMMAND_SIZE];
+	uint8 commandLength;
+	const uint8 * writeData;
+	uint16 writeLength;
+	uint8 * readData;
+	uint16 readLength;
+	void (*callback)(struct I2C_Transfer * transfer);	/* called by the ISR when it is done, can be NULL_PTR */
+	volatile I2C_TransferStatus status;
+	uint8 errorStatus;							/* the TWI status that failed the transfer (or I2C_STEP_TIMEOUT) */
+}I2C_Transfer;
+
+/*------------------------------------------------------------------
+[Structure Name]: I2C_Statistics
+[Structure Description]: it holds the error counters of the bus
+					timeouts   : steps that weren't done in I2C_STEP_TIMEOUT_MS
+					nacks      : transfers not acknowledged by the slave (the address only probes aren't counted)
+					busErrors  : bus errors and lost arbitrations
+					recoveries : times I2C_recoverBus is done
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint16 timeouts;
+	uint16 nacks;
+	uint16 busErrors;
+	uint16 recoveries;
+}I2C_Statistics;
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -147,7 +216,7 @@ uint8 I2C_readByteWithNACK(void);
 
 /*------------------------------------------------------------------
 [Function Name]:  I2C_getStatus
-[Description]: send the start bit
+[Description]: get the status of the last step, I2C_STEP_TIMEOUT if it has timed out
 [Args]:
 [in]	-NONE
 [out]	-NONE
@@ -158,4 +227,102 @@ uint8 I2C_getStatus(void);
 
 
 
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_submit
+[Description]: queue a transfer without waiting, it is done by the TWI interrupt after the ones
+				queued before it ... its status is I2C_PENDING till then and its callback is called
+				from the interrupt when it is done, the interrupts must be enabled and a pending
+				transfer must not be submitted again
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] I2C_Transfer * transfer:
+					pointer to the transfer
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void I2C_submit(I2C_Transfer * transfer);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_isIdle
+[Description]: check if all the submitted transfers are done
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if no transfer is queued, FALSE otherwise
+------------------------------------------------------------------*/
+boolean I2C_isIdle(void);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_wait
+[Description]: sleep till a submitted transfer is done, the status is checked with the
+				interrupts disabled so a transfer done just before sleeping still wakes the CPU up ...
+				a transfer that stops moving fails with I2C_STEP_TIMEOUT (see I2C_checkTimeout)
+[Args]:
+[in]	const I2C_Transfer * transfer:
+					pointer to the transfer
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the status of the transfer (I2C_DONE or I2C_FAILED)
+------------------------------------------------------------------*/
+I2C_TransferStatus I2C_wait(const I2C_Transfer * transfer);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_checkTimeout
+[Description]: fail the transfer on the bus if no TWI interrupt has come for I2C_STEP_TIMEOUT_MS,
+				the bus is recovered and the next transfer is started ... it is called by I2C_wait
+				and I2C_isIdle so a transfer nobody waits for is checked only when it is polled
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void I2C_checkTimeout(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_recoverBus
+[Description]: free a slave that holds SDA low by clocking SCL till it releases SDA then send
+				a STOP by hand and initialize the TWI again with the configuration of I2C_init ...
+				it must not be called while a transfer is on the bus (I2C_checkTimeout does it for them)
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if both lines are high after it, FALSE if the bus is still stuck
+------------------------------------------------------------------*/
+boolean I2C_recoverBus(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  I2C_getStatistics
+[Description]: take a copy of the error counters
+[Args]:
+[in]	-NONE
+[out]	I2C_Statistics * stats:
+					pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void I2C_getStatistics(I2C_Statistics * stats);
+
+
+
 #endif /* I2C_H_ */
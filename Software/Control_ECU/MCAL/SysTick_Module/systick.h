@@ -0,0 +1,191 @@
+ /******************************************************************************
+ *
+ * Module: SysTick
+ *
+ * File Name: systick.h
+ *
+ * Description: Header file for the millisecond system tick built on Timer1
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef SYSTICK_H_
+#define SYSTICK_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Timer1 runs freely at F_CPU/8 ... 1000 counts = 1 ms at 8 MHz, the tick uses the OCR1A compare
+ * channel only and moves it 1000 counts forward every tick so COMPARE_B, the overflow and the
+ * input capture of Timer1 stay free for the other modules
+ */
+#define SYSTICK_PRESCALER			8UL
+#define SYSTICK_COUNTS_PER_TICK		((uint16)(F_CPU / SYSTICK_PRESCALER / 1000UL))
+
+/*
+ * converts a number of Timer1 counts to microseconds ... 1 count = 1 us at 8 MHz and 0.5 us at 16 MHz,
+ * it multiplies before dividing so the fraction isn't lost, the counts must be an interval
+ * (a difference of two SYSTICK_getCounts values) to stay far from the 32-bit limit
+ */
+#define SYSTICK_COUNTS_TO_US(counts)	((uint32)(counts) * SYSTICK_PRESCALER / (F_CPU / 1000000UL))
+
+#if((F_CPU % 1000000UL) != 0) || (F_CPU < 1000000UL)
+#error "SYSTICK_COUNTS_TO_US needs F_CPU to be a whole number of MHz"
+#endif
+
+/* longest tick period SYSTICK_sleepUntil can stretch the compare channel to ... must fit in the 16-bit counter */
+#define SYSTICK_MAX_SLEEP_TICKS		60
+
+/* the compare value is never set nearer than this number of counts to the counter so it can't be passed while it is written */
+#define SYSTICK_MIN_COMPARE_COUNTS	32
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: SYSTICK_SleepStatistics
+[Structure Description]: it's used to report the sleep residency since SYSTICK_init
+					sleepTicks   : milliseconds the CPU has slept
+					sleeps       : times the CPU went to sleep
+					timerWakeups : sleeps that lasted till their wake tick,
+					               the others are ended by an interrupt
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint32 sleepTicks;
+	uint32 sleeps;
+	uint32 timerWakeups;
+}SYSTICK_SleepStatistics;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_init
+[Description]: start Timer1 to count one tick every millisecond,
+				Timer1 must not be re-initialized by anyone else after that but its
+				other events can be used through the Timer1 driver
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SYSTICK_init(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_getTicks
+[Description]: get the number of milliseconds since SYSTICK_init (wraps after ~49 days)
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the tick counter
+------------------------------------------------------------------*/
+uint32 SYSTICK_getTicks(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_getCounts
+[Description]: get the number of Timer1 counts since SYSTICK_init (SYSTICK_COUNTS_TO_US converts them),
+				used to measure short intervals finer than a tick
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the Timer1 counts (wraps after ~71 minutes at 8 MHz)
+------------------------------------------------------------------*/
+uint32 SYSTICK_getCounts(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_getMicros
+[Description]: get a free running microseconds time stamp, intervals are measured by
+				subtracting two time stamps so the wrap around doesn't matter
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the microseconds since SYSTICK_init (wraps after ~71 minutes)
+------------------------------------------------------------------*/
+uint32 SYSTICK_getMicros(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_sleepUntil
+[Description]: put the CPU in the idle sleep mode without waking up every tick,
+				the tick period is stretched till the wake tick (SYSTICK_MAX_SLEEP_TICKS at most)
+				and any other interrupt wakes the CPU up earlier ... the tick counter is
+				corrected before returning either way
+[Args]:
+[in]	uint32 wakeTick:
+					the tick at which the CPU must be awake
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SYSTICK_sleepUntil(uint32 wakeTick);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_getSleepStatistics
+[Description]: take a copy of the sleep residency counters
+[Args]:
+[in]	-NONE
+[out]	SYSTICK_SleepStatistics * stats:
+					pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SYSTICK_getSleepStatistics(SYSTICK_SleepStatistics * stats);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_getDeadline
+[Description]: get the tick value at which a timeout starting now expires
+[Args]:
+[in]	uint32 timeoutMs:
+					the timeout in milliseconds
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the deadline tick
+------------------------------------------------------------------*/
+uint32 SYSTICK_getDeadline(uint32 timeoutMs);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_isExpired
+[Description]: check if a deadline is reached ... safe across the counter wrap around
+[Args]:
+[in]	uint32 deadline:
+					the deadline tick
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the deadline is reached, FALSE otherwise
+------------------------------------------------------------------*/
+boolean SYSTICK_isExpired(uint32 deadline);
+
+
+#endif /* SYSTICK_H_ */
@@ -11,11 +11,123 @@
  *******************************************************************************/
 
 #include "uart.h"
+#include "systick.h"
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include "common_macros.h"
 
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* the mode selected in UART_init */
+static UART_Mode g_uartMode = UART_POLLING_MODE;
+
+/* Rx ring buffer ... written by the RXC ISR and read by the application */
+static volatile uint8 g_rxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint8 g_rxHead = 0;
+static volatile uint8 g_rxTail = 0;
+
+/* Tx ring buffer ... written by the application and read by the UDRE ISR */
+static volatile uint8 g_txBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint8 g_txHead = 0;
+static volatile uint8 g_txTail = 0;
+
+/* set once a byte is written to UDR ... before that TXC never gets set */
+static volatile boolean g_txUsed = FALSE;
 
+/* byte & error counters ... kept across UART_init so a baud rate change doesn't reset them */
+static volatile UART_Statistics g_stats;
 
+/* FE, DOR & PE flags seen by the RXC ISR and not reported yet */
+static volatile uint8 g_rxErrorFlags = 0;
+
+/* multi-drop bus address ... a slave receives and transmits only while it is selected */
+static uint8 g_ownAddress = UART_MASTER_ADDRESS;
+static volatile boolean g_selected = TRUE;
+static boolean g_nineBits = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static boolean UART_putInTxBuffer(uint8 data);
+
+static UART_Status UART_getErrorStatus(uint8 flags);
+
+static void UART_countErrors(uint8 flags);
+
+static void UART_disableRxInterrupt(void);
+
+static void UART_restoreRxInterrupt(void);
+
+static void UART_handleAddress(uint8 address);
+
+static void UART_sleepTillData(uint32 deadline);
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+ISR(USART_RXC_vect)
+{
+	/* the status and the 9th bit must be read before UDR as reading UDR clears them */
+	uint8 status = UCSRA;
+	uint8 ninthBit = UCSRB & (1<<RXB8);
+	uint8 data = UDR;
+	uint8 nextHead = (g_rxHead + 1) & (UART_RX_BUFFER_SIZE - 1);
+
+	status &= (1<<FE) | (1<<DOR) | (1<<PE);
+
+	/* keep the error flags till the application reads them */
+	g_rxErrorFlags |= status;
+	g_stats.rxBytes++;
+	UART_countErrors(status);
+
+	/* an address frame on the multi-drop bus is handled here and never buffered */
+	if((g_nineBits == TRUE) && (ninthBit != 0))
+	{
+		if((status & (1<<FE)) == 0)
+		{
+			UART_handleAddress(data);
+		}
+		return;
+	}
+
+	/* a byte with a wrong stop or parity bit is garbage so it is dropped */
+	if((status & ((1<<FE) | (1<<PE))) == 0)
+	{
+		/* the buffer is full so drop the new byte */
+		if(nextHead == g_rxTail)
+		{
+			g_stats.rxOverruns++;
+		}
+		else
+		{
+			g_rxBuffer[g_rxHead] = data;
+			g_rxHead = nextHead;
+		}
+	}
+}
+
+ISR(USART_UDRE_vect)
+{
+	/* a slave keeps its bytes queued till the master selects it */
+	if((g_txTail != g_txHead) && (g_selected == TRUE))
+	{
+		/* clear the TXC flag so UART_flush can tell when this byte is shifted out */
+		SET_BIT(UCSRA,TXC);
+		UDR = g_txBuffer[g_txTail];
+		g_txUsed = TRUE;
+		g_stats.txBytes++;
+		g_txTail = (g_txTail + 1) & (UART_TX_BUFFER_SIZE - 1);
+	}
+	else
+	{
+		/* nothing to send ... disable the interrupt till a byte is queued or the slave is selected */
+		CLEAR_BIT(UCSRB,UDRIE);
+	}
+}
 
 /*******************************************************************************
  *                              Functions Prototypes                           *
@@ -40,20 +152,57 @@ void UART_init(UART_ConfigType * config)
 	/* calculate the value of the UBRR register to setup the baud rate */
 	uint16 ubrrValue = (uint16)((F_CPU / (8UL * config->baudrate)) - 1);
 
-	/* U2X = 1 for double transmission speed */
-	UCSRA = (1<<U2X);
+	g_uartMode = config->mode;
+	g_nineBits = (config->databits == NINE_DATABITS) ? TRUE : FALSE;
+
+	/* a new address starts deselected ... a baud rate change keeps the selection */
+	if(config->address != g_ownAddress)
+	{
+		g_ownAddress = config->address;
+		g_selected = (g_ownAddress == UART_MASTER_ADDRESS) ? TRUE : FALSE;
+	}
+
+	/*
+	 * U2X = 1 for double transmission speed
+	 * MPCM = 1 for a slave that is not selected so the data frames are ignored
+	 */
+	if((g_nineBits == TRUE) && (g_selected == FALSE))
+	{
+		UCSRA = (1<<U2X) | (1<<MPCM);
+	}
+	else
+	{
+		UCSRA = (1<<U2X);
+	}
+
+	/* empty the ring buffers */
+	g_rxHead = g_rxTail = 0;
+	g_txHead = g_txTail = 0;
+	g_txUsed = FALSE;
 
 	/************************** UCSRB Description **************************
-	* RXCIE = 0 Disable USART RX Complete Interrupt Enable
+	* RXCIE = 0 Disable USART RX Complete Interrupt Enable (1 in interrupt mode)
 	* TXCIE = 0 Disable USART Tx Complete Interrupt Enable
 	* UDRIE = 0 Disable USART Data Register Empty Interrupt Enable
 	* RXEN  = 1 Receiver Enable
 	* RXEN  = 1 Transmitter Enable
-	* UCSZ2 = 0 For 8-bit data mode
-	* RXB8 & TXB8 not used for 8-bit data mode
+	* UCSZ2 = 0 For 8-bit data mode (1 for 9-bit data mode)
+	* RXB8 & TXB8 not used for 8-bit data mode (TXB8 = 0 for the data frames in 9-bit mode)
 	***********************************************************************/
 	UCSRB = (1<<RXEN) | (1<<TXEN);
 
+	/* UCSZ2 is the 3rd bit of the data bits setting */
+	if(config->databits & 0x04)
+	{
+		SET_BIT(UCSRB,UCSZ2);
+	}
+
+	if(g_uartMode == UART_INTERRUPT_MODE)
+	{
+		/* UDRIE is enabled later only when there is a byte to send */
+		SET_BIT(UCSRB,RXCIE);
+	}
+
 	/* URSEL   = 1 The URSEL must be one when writing the UCSRC */
 	UCSRC = (1<<URSEL);
 
@@ -81,27 +230,50 @@ void UART_init(UART_ConfigType * config)
 				the byte you want to send through UART
 [out]	-NONE
 [in/out] -NONE
-[Returns]: Nothing
+[Returns]: TRUE if the byte is sent or queued, FALSE if it is dropped
 ------------------------------------------------------------------*/
-void UART_sendByte(uint8 data)
+boolean UART_sendByte(uint8 data)
 {
+	if(g_uartMode == UART_INTERRUPT_MODE)
+	{
+		/* wait for a free place in the Tx buffer ... the UDRE interrupt or the next tick wakes the CPU up */
+		while(UART_putInTxBuffer(data) == FALSE)
+		{
+			/* a slave that is not selected never drains the buffer so waiting would block forever */
+			if(g_selected == FALSE)
+			{
+				g_stats.txOverruns++;
+				return FALSE;
+			}
+			SYSTICK_sleepUntil(SYSTICK_getDeadline(1));
+		}
+		return TRUE;
+	}
+
 	/*
 	 * UDRE flag is set when the Tx buffer (UDR) is empty and ready for
 	* transmitting a new byte so wait until this flag is set to one
 	*/
 	while(BIT_IS_CLEAR(UCSRA,UDRE));
 
+	/* clear the TXC flag so UART_flush can tell when this byte is shifted out */
+	SET_BIT(UCSRA,TXC);
+
 	/*
 	 * Put the required data in the UDR register and it also clear the UDRE flag as
 	 * the UDR register is not empty now
 	 */
 	UDR = data;
+	g_txUsed = TRUE;
+	g_stats.txBytes++;
 
 	/************************* Another Method *************************
 	UDR = data;
 	while(BIT_IS_CLEAR(UCSRA,TXC)){} // Wait until the transmission is complete TXC = 1
 	SET_BIT(UCSRA,TXC); // Clear the TXC flag
 	*******************************************************************/
+
+	return TRUE;
 }
 
 
@@ -117,9 +289,25 @@ void UART_sendByte(uint8 data)
 ------------------------------------------------------------------*/
 uint8 UART_receiveByte(void)
 {
+	uint8 data;
+
+	if(g_uartMode == UART_INTERRUPT_MODE)
+	{
+		/* wait till the RXC ISR puts a byte in the Rx buffer ... errors are skipped */
+		while(UART_receiveByteNonBlocking(&data) != UART_SUCCESS)
+		{
+			UART_sleepTillData(SYSTICK_getDeadline(SYSTICK_MAX_SLEEP_TICKS));
+		}
+		return data;
+	}
+
 	/* RXC flag is set when the UART receive data so wait until this flag is set to one */
 	while(BIT_IS_CLEAR(UCSRA,RXC));
 
+	/* the flags must be read before UDR as reading UDR clears them */
+	g_stats.rxBytes++;
+	UART_countErrors(UCSRA & ((1<<FE) | (1<<DOR) | (1<<PE)));
+
 	/*
 	 * Read the received data from the Rx buffer (UDR)
 	 * The RXC flag will be cleared after read the data
@@ -142,10 +330,9 @@ uint8 UART_receiveByte(void)
 ------------------------------------------------------------------*/
 void UART_sendString(const uint8 * str)
 {
-	/* Send the whole string */
-	while(*str != '\0')
+	/* Send the whole string ... stop if a byte is dropped */
+	while((*str != '\0') && (UART_sendByte(*str) == TRUE))
 	{
-		UART_sendByte(*str);
 		str++;
 	}
 }
@@ -176,3 +363,531 @@ void UART_receiveString(uint8 * str)
 
 	}
 }
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_sendByteNonBlocking
+[Description]: queue a byte in the Tx buffer without waiting (interrupt mode only).
+[Args]:
+[in]	uint8 data:
+				the byte you want to send through UART
+[out]	-NONE
+[in/out] -NONE
+[Returns]: UART_SUCCESS if the byte is queued or UART_BUFFER_FULL if it is dropped
+------------------------------------------------------------------*/
+UART_Status UART_sendByteNonBlocking(uint8 data)
+{
+	if(UART_putInTxBuffer(data) == FALSE)
+	{
+		g_stats.txOverruns++;
+		return UART_BUFFER_FULL;
+	}
+
+	return UART_SUCCESS;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_receiveByteNonBlocking
+[Description]: take a byte from the Rx buffer without waiting (interrupt mode only).
+				Errors seen by the RXC ISR since the last call are reported first,
+				the corrupted bytes themselves are never put in the buffer.
+[Args]:
+[in]	 -NONE
+[out]	 uint8 * data:
+				pointer to the variable you want to save the received byte in
+[in/out] -NONE
+[Returns]: UART_SUCCESS if a byte is returned, UART_NO_DATA if the buffer is empty
+			or the error (FE, DOR, PE) if one happened
+------------------------------------------------------------------*/
+UART_Status UART_receiveByteNonBlocking(uint8 * data)
+{
+	uint8 errorFlags;
+
+	if(g_rxErrorFlags != 0)
+	{
+		/* take the flags with the RXC interrupt disabled so no new flag is lost */
+		UART_disableRxInterrupt();
+		errorFlags = g_rxErrorFlags;
+		g_rxErrorFlags = 0;
+		UART_restoreRxInterrupt();
+
+		return UART_getErrorStatus(errorFlags);
+	}
+
+	if(g_rxTail == g_rxHead)
+	{
+		return UART_NO_DATA;
+	}
+
+	*data = g_rxBuffer[g_rxTail];
+	g_rxTail = (g_rxTail + 1) & (UART_RX_BUFFER_SIZE - 1);
+
+	return UART_SUCCESS;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_receiveByteTimeout
+[Description]: wait for a received byte till a system tick deadline (works in both modes).
+[Args]:
+[in]	 uint32 deadline:
+				the SysTick value at which the wait is given up (see SYSTICK_getDeadline)
+[out]	 uint8 * data:
+				pointer to the variable you want to save the received byte in
+[in/out] -NONE
+[Returns]: UART_SUCCESS if a byte is returned, UART_TIMEOUT if the deadline is reached
+			or the error (FE, DOR, PE) if one happened
+------------------------------------------------------------------*/
+UART_Status UART_receiveByteTimeout(uint8 * data, uint32 deadline)
+{
+	UART_Status status;
+	uint8 flags;
+
+	do
+	{
+		if(g_uartMode == UART_INTERRUPT_MODE)
+		{
+			status = UART_receiveByteNonBlocking(data);
+			if(status != UART_NO_DATA)
+			{
+				return status;
+			}
+			UART_sleepTillData(deadline);
+		}
+		else if(BIT_IS_SET(UCSRA,RXC))
+		{
+			/* the flags must be read before UDR as reading UDR clears them */
+			flags = UCSRA & ((1<<FE) | (1<<DOR) | (1<<PE));
+			*data = UDR;
+			g_stats.rxBytes++;
+			UART_countErrors(flags);
+			if(flags != 0)
+			{
+				return UART_getErrorStatus(flags);
+			}
+			return UART_SUCCESS;
+		}
+	}while(SYSTICK_isExpired(deadline) == FALSE);
+
+	return UART_TIMEOUT;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_getRxOverrunCount
+[Description]: get how many received bytes were lost because the Rx buffer
+				was full or the hardware data overrun flag (DOR) was set.
+[Args]:
+[in]	 -NONE
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: the number of lost received bytes
+------------------------------------------------------------------*/
+uint16 UART_getRxOverrunCount(void)
+{
+	uint16 count;
+
+	/* the counter is 16-bit so read it with the RXC interrupt disabled */
+	UART_disableRxInterrupt();
+	count = g_stats.rxOverruns;
+	UART_restoreRxInterrupt();
+
+	return count;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_getTxOverrunCount
+[Description]: get how many bytes were dropped by UART_sendByteNonBlocking
+				because the Tx buffer was full.
+[Args]:
+[in]	 -NONE
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: the number of dropped transmitted bytes
+------------------------------------------------------------------*/
+uint16 UART_getTxOverrunCount(void)
+{
+	return g_stats.txOverruns;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_getFrameErrorCount
+[Description]: get how many received bytes were dropped because of a
+				framing error (wrong stop bit), usually a baud rate mismatch.
+[Args]:
+[in]	 -NONE
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: the number of bytes received with a framing error
+------------------------------------------------------------------*/
+uint16 UART_getFrameErrorCount(void)
+{
+	uint16 count;
+
+	/* the counter is 16-bit so read it with the RXC interrupt disabled */
+	UART_disableRxInterrupt();
+	count = g_stats.frameErrors;
+	UART_restoreRxInterrupt();
+
+	return count;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_getStatistics
+[Description]: take a copy of all the driver counters at once.
+[Args]:
+[in]	 -NONE
+[out]	 UART_Statistics * stats:
+				pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void UART_getStatistics(UART_Statistics * stats)
+{
+	/* the UDRE ISR updates txBytes so both interrupts are held while copying */
+	uint8 ucsrb = UCSRB;
+
+	UCSRB &= ~((1<<RXCIE) | (1<<UDRIE));
+	stats->rxBytes = g_stats.rxBytes;
+	stats->txBytes = g_stats.txBytes;
+	stats->frameErrors = g_stats.frameErrors;
+	stats->parityErrors = g_stats.parityErrors;
+	stats->rxOverruns = g_stats.rxOverruns;
+	stats->txOverruns = g_stats.txOverruns;
+	UCSRB = ucsrb;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_sendAddress
+[Description]: (master) send an address frame on the multi-drop bus after the queued bytes,
+				the addressed slave gets all the next data bytes till another address is sent.
+[Args]:
+[in]	uint8 address:
+				the address of the slave
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void UART_sendAddress(uint8 address)
+{
+	/* the queued bytes still belong to the previous slave ... the UDRE ISR clears UDRIE if it can't send them */
+	while((g_txTail != g_txHead) && BIT_IS_SET(UCSRB,UDRIE));
+	while(BIT_IS_CLEAR(UCSRA,UDRE));
+
+	/* TXB8 = 1 marks the address frame */
+	SET_BIT(UCSRA,TXC);
+	SET_BIT(UCSRB,TXB8);
+	UDR = address;
+	g_txUsed = TRUE;
+	g_stats.txBytes++;
+
+	/* TXB8 is taken with the byte when it moves to the shift register */
+	while(BIT_IS_CLEAR(UCSRA,UDRE));
+	CLEAR_BIT(UCSRB,TXB8);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_flush
+[Description]: wait till every queued byte is completely shifted out on the Tx line,
+				must be called before changing the frame format or the baud rate.
+[Args]:
+[in]	 -NONE
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void UART_flush(void)
+{
+	/* wait till the UDRE ISR takes the last byte from the Tx buffer (a slave that isn't selected keeps them) */
+	while((g_txTail != g_txHead) && BIT_IS_SET(UCSRB,UDRIE));
+
+	/* TXC is never set if nothing was sent since UART_init */
+	if(g_txUsed == FALSE)
+	{
+		return;
+	}
+
+	/* wait till the last byte leaves the shift register */
+	while(BIT_IS_CLEAR(UCSRA,TXC));
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_canSend
+[Description]: check if a number of bytes can be sent now without being dropped,
+				used to send a whole frame or nothing while the slave is not selected.
+[Args]:
+[in]	 uint8 count:
+				the number of bytes
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: TRUE if they fit in the Tx buffer or the buffer is being drained, FALSE otherwise
+------------------------------------------------------------------*/
+boolean UART_canSend(uint8 count)
+{
+	/* one place is always left empty to tell a full buffer from an empty one */
+	uint8 freePlaces = (g_txTail - g_txHead - 1) & (UART_TX_BUFFER_SIZE - 1);
+
+	/* the polling mode and a selected device wait for the room so nothing is dropped */
+	if((g_uartMode == UART_POLLING_MODE) || (g_selected == TRUE))
+	{
+		return TRUE;
+	}
+
+	return (count <= freePlaces) ? TRUE : FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_waitForData
+[Description]: sleep till a byte is received or a system tick deadline is reached,
+				it returns at once if a byte is already waiting or in the polling mode.
+[Args]:
+[in]	 uint32 deadline:
+				the SysTick value at which the CPU must be awake (see SYSTICK_getDeadline)
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void UART_waitForData(uint32 deadline)
+{
+	/* the polling mode has no interrupt to wake the CPU up */
+	if(g_uartMode == UART_INTERRUPT_MODE)
+	{
+		UART_sleepTillData(deadline);
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_putInTxBuffer
+[Description]: put a byte in the Tx buffer and let the UDRE ISR send it.
+[Args]:
+[in]	uint8 data:
+				the byte you want to send through UART
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the byte is queued or FALSE if the buffer is full
+------------------------------------------------------------------*/
+static boolean UART_putInTxBuffer(uint8 data)
+{
+	uint8 nextHead = (g_txHead + 1) & (UART_TX_BUFFER_SIZE - 1);
+
+	if(nextHead == g_txTail)
+	{
+		return FALSE;
+	}
+
+	g_txBuffer[g_txHead] = data;
+	g_txHead = nextHead;
+
+	/* let the UDRE ISR start draining the buffer */
+	SET_BIT(UCSRB,UDRIE);
+
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_getErrorStatus
+[Description]: convert the UCSRA error flags to a status ... a framing error
+				hides the other errors as the whole byte is garbage then
+[Args]:
+[in]	uint8 flags:
+				the FE, DOR & PE flags of UCSRA
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the error status
+------------------------------------------------------------------*/
+static UART_Status UART_getErrorStatus(uint8 flags)
+{
+	if(BIT_IS_SET(flags,FE))
+	{
+		return UART_FRAMING_ERROR;
+	}
+	else if(BIT_IS_SET(flags,PE))
+	{
+		return UART_PARITY_ERROR;
+	}
+	return UART_OVERRUN_ERROR;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_countErrors
+[Description]: update the error counters with the UCSRA flags of one received byte
+[Args]:
+[in]	uint8 flags:
+				the FE, DOR & PE flags of UCSRA
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_countErrors(uint8 flags)
+{
+	/* the hardware lost a byte before this one */
+	if(BIT_IS_SET(flags,DOR))
+	{
+		g_stats.rxOverruns++;
+	}
+
+	if(BIT_IS_SET(flags,FE))
+	{
+		g_stats.frameErrors++;
+	}
+	else if(BIT_IS_SET(flags,PE))
+	{
+		g_stats.parityErrors++;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_disableRxInterrupt
+[Description]: hold the RXC ISR while a multi-byte shared variable is accessed
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_disableRxInterrupt(void)
+{
+	CLEAR_BIT(UCSRB,RXCIE);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_restoreRxInterrupt
+[Description]: release the RXC ISR held by UART_disableRxInterrupt (interrupt mode only)
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_restoreRxInterrupt(void)
+{
+	if(g_uartMode == UART_INTERRUPT_MODE)
+	{
+		SET_BIT(UCSRB,RXCIE);
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_handleAddress
+[Description]: (slave) select or deselect this device when an address frame is received
+[Args]:
+[in]	uint8 address:
+				the received address
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_handleAddress(uint8 address)
+{
+	if(g_ownAddress == UART_MASTER_ADDRESS)
+	{
+		return;
+	}
+
+	if(address == g_ownAddress)
+	{
+		/* MPCM = 0 to receive the data frames and let the UDRE ISR send the queued bytes */
+		g_selected = TRUE;
+		UCSRA = (1<<U2X);
+		SET_BIT(UCSRB,UDRIE);
+	}
+	else
+	{
+		/* another slave is selected ... ignore the data frames and stop sending */
+		g_selected = FALSE;
+		UCSRA = (1<<U2X) | (1<<MPCM);
+		CLEAR_BIT(UCSRB,UDRIE);
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_sleepTillData
+[Description]: sleep till the RXC ISR receives a byte or the deadline is reached (interrupt mode),
+				the Rx buffer is checked with the interrupts disabled so a byte received
+				just before sleeping still wakes the CPU up
+[Args]:
+[in]	uint32 deadline:
+				the SysTick value at which the CPU must be awake
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_sleepTillData(uint32 deadline)
+{
+	cli();
+	if((g_rxTail == g_rxHead) && (g_rxErrorFlags == 0))
+	{
+		/* it enables the interrupts again just before sleeping */
+		SYSTICK_sleepUntil(deadline);
+	}
+	sei();
+}
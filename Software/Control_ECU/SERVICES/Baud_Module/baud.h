@@ -0,0 +1,141 @@
+ /******************************************************************************
+ *
+ * Module: BAUD
+ *
+ * File Name: baud.h
+ *
+ * Description: Header file for the baud rate negotiation between the HMI_ECU and the Control_ECU
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+#ifndef BAUD_H_
+#define BAUD_H_
+
+#include "std_types.h"
+#include "uart.h"
+#include "frame.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Negotiation sequence (the HMI_ECU leads, both ECUs start at the default rate):
+ *
+ *   HMI  --- BAUD_PROPOSE(index) --->  Control     (default rate)
+ *   HMI  <-- BAUD_ACCEPT(index)  ----  Control     (default rate)
+ *            ... both switch to the proposed rate ...
+ *   HMI  --- BAUD_TEST(pattern)  --->  Control
+ *   HMI  <-- BAUD_TEST(pattern)  ----  Control
+ *   HMI  --- BAUD_CONFIRM        --->  Control
+ *   HMI  <-- BAUD_CONFIRM        ----  Control
+ *
+ * If any step times out or the pattern is corrupted both ECUs go back to the
+ * default rate and the HMI_ECU proposes the next slower rate.
+ */
+
+/* Frame types used by the negotiation */
+#define BAUD_PROPOSE				0xFA
+#define BAUD_ACCEPT					0xFB
+#define BAUD_TEST					0xFC
+#define BAUD_CONFIRM				0xFD
+
+/* Supported rates ... all of them give <= 0.2% UBRR error at 8 MHz with U2X */
+#define BAUD_NUM_OF_RATES			6
+#define BAUD_DEFAULT_INDEX			(BAUD_NUM_OF_RATES - 1)
+
+/* the fastest rate the HMI_ECU proposes ... a later index caps the rate (BAUD_DEFAULT_INDEX keeps the default one) */
+#ifndef BAUD_FIRST_INDEX
+#define BAUD_FIRST_INDEX			0
+#endif
+
+#define BAUD_TEST_PATTERN_SIZE		8
+
+/* Timing of the negotiation */
+#define BAUD_REPLY_TIMEOUT_MS		100
+#define BAUD_TEST_TIMEOUT_MS		50
+#define BAUD_SWITCH_GUARD_MS		2
+
+/* Control_ECU falls back to the default rate after this number of framing errors between two link checks */
+#define BAUD_MAX_FRAME_ERRORS		4
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_init
+[Description]: initialize the UART at the default baud rate
+[Args]:
+[in]	const UART_ConfigType * config:
+					the UART configurations, its baud rate is replaced by the default one
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void BAUD_init(const UART_ConfigType * config);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_negotiate
+[Description]: (HMI_ECU) try the rates from BAUD_FIRST_INDEX to the slowest
+				and keep the first one that passes the test pattern exchange
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the agreed baud rate
+------------------------------------------------------------------*/
+uint32 BAUD_negotiate(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_handleProposal
+[Description]: (Control_ECU) answer a BAUD_PROPOSE frame and run the test pattern exchange,
+				the default rate is restored if the exchange fails
+[Args]:
+[in]	const FRAME_Message * frame:
+					the received BAUD_PROPOSE frame
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void BAUD_handleProposal(const FRAME_Message * frame);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_checkLink
+[Description]: (Control_ECU) go back to the default rate if framing errors show that
+				the HMI_ECU is talking at another rate (after a reset for example)
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void BAUD_checkLink(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_getBaudrate
+[Description]: get the baud rate in use
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the current baud rate
+------------------------------------------------------------------*/
+uint32 BAUD_getBaudrate(void);
+
+
+
+#endif /* BAUD_H_ */
@@ -0,0 +1,469 @@
+ /******************************************************************************
+ *
+ * Module: CRED
+ *
+ * File Name: cred.c
+ *
+ * Description: Source file for the password store cached in RAM and written through to the External EEPROM
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "cred.h"
+#include "external_eeprom.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* the exist byte, the password and the checksum are read by one sequential read */
+#define CRED_RECORD_SIZE			(1 + CRED_PASSWORD_SIZE + 1)
+
+/* value of an EEPROM byte that was never written ... the checksum byte of a password saved before it was added */
+#define CRED_ERASED_BYTE			0xFF
+
+#if((CRED_EXIST_ADDRESS + 1) != CRED_PASSWORD_ADDRESS)
+
+#error "the exist byte should be just before the password"
+
+#endif
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: CRED_Record
+[Structure Description]: it holds what is saved in the EEPROM
+------------------------------------------------------------------*/
+typedef struct
+{
+	boolean exists;
+	uint8 password[CRED_PASSWORD_SIZE];
+}CRED_Record;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* the cached copy of the EEPROM and whether it can be used */
+static CRED_Record g_cache;
+static boolean g_cacheValid = FALSE;
+
+/* the background read started by CRED_verify ... done by the TWI interrupt while the main loop goes on */
+static I2C_Transfer g_verifyTransfer;
+static uint8 g_verifyBytes[CRED_RECORD_SIZE];
+static boolean g_verifying = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static uint8 CRED_checksum(const uint8 * pass);
+static boolean CRED_parse(const uint8 * bytes, CRED_Record * record);
+static boolean CRED_load(CRED_Record * record);
+static boolean CRED_compare(const uint8 * pass1, const uint8 * pass2);
+static void CRED_checkVerify(void);
+static void CRED_dropVerify(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_checksum
+[Description]: calculate the checksum saved after the password ... the complement of the
+				sum of the digits so an erased EEPROM (all 0xFF) never passes it
+[Args]:
+[in]	const uint8 * pass:
+					Pointer to the password array
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the checksum
+------------------------------------------------------------------*/
+static uint8 CRED_checksum(const uint8 * pass)
+{
+	uint8 sum = 0;
+	uint8 i;
+
+	for(i=0;i<CRED_PASSWORD_SIZE;i++)
+	{
+		sum += pass[i];
+	}
+	return (uint8)~sum;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_parse
+[Description]: take the record out of the bytes read from the EEPROM
+[Args]:
+[in]	const uint8 * bytes:
+					the exist byte, the password and its checksum
+[out]	CRED_Record * record:
+					pointer to the structure you want to save the record in
+[in/out] -NONE
+[Returns]: TRUE if the checksum is right, FALSE otherwise
+------------------------------------------------------------------*/
+static boolean CRED_parse(const uint8 * bytes, CRED_Record * record)
+{
+	uint8 i;
+
+	if(bytes[CRED_RECORD_SIZE - 1] != CRED_checksum(&bytes[1]))
+	{
+		return FALSE;
+	}
+
+	record->exists = (bytes[0] == CRED_EXIST_MARK) ? TRUE : FALSE;
+	for(i=0;i<CRED_PASSWORD_SIZE;i++)
+	{
+		record->password[i] = bytes[1 + i];
+	}
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_load
+[Description]: read the exist byte, the password and its checksum from the EEPROM
+[Args]:
+[in]	-NONE
+[out]	CRED_Record * record:
+					pointer to the structure you want to save the record in
+[in/out] -NONE
+[Returns]: TRUE if the record is read and its checksum is right, FALSE otherwise
+------------------------------------------------------------------*/
+static boolean CRED_load(CRED_Record * record)
+{
+	uint8 bytes[CRED_RECORD_SIZE];
+
+	if(EEPROM_readBlock(CRED_EXIST_ADDRESS, bytes, CRED_RECORD_SIZE) != SUCCESS)
+	{
+		return FALSE;
+	}
+	return CRED_parse(bytes, record);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_compare
+[Description]: compare two passwords
+[Args]:
+[in]	const uint8 * pass1:
+					Pointer to the password1 array
+		const uint8 * pass2:
+					Pointer to the password2 array
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if they matched, FALSE otherwise
+------------------------------------------------------------------*/
+static boolean CRED_compare(const uint8 * pass1, const uint8 * pass2)
+{
+	uint8 i;
+
+	for(i=0;i<CRED_PASSWORD_SIZE;i++)
+	{
+		if(pass1[i] != pass2[i])
+		{
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_checkVerify
+[Description]: use the result of the background read if it is done, the cache isn't used
+				if the EEPROM is different and it is taken from the EEPROM if it isn't used ...
+				a read that failed is ignored
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void CRED_checkVerify(void)
+{
+	CRED_Record record;
+
+	/* a read stuck on the bus is failed here so the verify doesn't stay pending forever */
+	if(g_verifying == TRUE)
+	{
+		I2C_checkTimeout();
+	}
+	if((g_verifying == FALSE) || (g_verifyTransfer.status == I2C_PENDING))
+	{
+		return;
+	}
+	g_verifying = FALSE;
+
+	if(g_verifyTransfer.status != I2C_DONE)
+	{
+		return;
+	}
+
+	if(CRED_parse(g_verifyBytes, &record) == FALSE)
+	{
+		g_cacheValid = FALSE;
+	}
+	else if(g_cacheValid == FALSE)
+	{
+		g_cache = record;
+		g_cacheValid = TRUE;
+	}
+	else if((record.exists != g_cache.exists) || (CRED_compare(record.password, g_cache.password) == FALSE))
+	{
+		g_cacheValid = FALSE;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_dropVerify
+[Description]: wait for the background read and forget its result ... used before
+				the EEPROM is changed as the result would be old
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void CRED_dropVerify(void)
+{
+	if(g_verifying == TRUE)
+	{
+		I2C_wait(&g_verifyTransfer);
+		g_verifying = FALSE;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_init
+[Description]: load the cache from the EEPROM, I2C_init and SYSTICK_init must be called first ...
+				a password saved before the checksum was added gets its checksum written once
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void CRED_init(void)
+{
+	uint8 bytes[CRED_RECORD_SIZE];
+	uint8 checksum;
+
+	g_cacheValid = FALSE;
+	if(EEPROM_readBlock(CRED_EXIST_ADDRESS, bytes, CRED_RECORD_SIZE) != SUCCESS)
+	{
+		return;
+	}
+
+	/*
+	 * the record is valid but for its checksum byte that was never written, any other wrong
+	 * checksum is a damaged record and it is left as it is
+	 */
+	if((CRED_parse(bytes, &g_cache) == FALSE) && (bytes[0] == CRED_EXIST_MARK) &&
+			(bytes[CRED_RECORD_SIZE - 1] == CRED_ERASED_BYTE))
+	{
+		checksum = CRED_checksum(&bytes[1]);
+		if(EEPROM_writeByte(CRED_CHECKSUM_ADDRESS, checksum) != SUCCESS)
+		{
+			return;
+		}
+		bytes[CRED_RECORD_SIZE - 1] = checksum;
+	}
+	g_cacheValid = CRED_parse(bytes, &g_cache);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_exists
+[Description]: check if a password is saved
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if a password is saved, FALSE otherwise
+------------------------------------------------------------------*/
+boolean CRED_exists(void)
+{
+	uint8 check;
+
+	CRED_checkVerify();
+	if(g_cacheValid == TRUE)
+	{
+		return g_cache.exists;
+	}
+
+	/*
+	 * without the cache the exist byte is read like before ... a damaged record still counts so
+	 * no new password can be saved over it, CRED_check refuses every password with it
+	 */
+	if(EEPROM_readByte(CRED_EXIST_ADDRESS, &check) != SUCCESS)
+	{
+		return FALSE;
+	}
+	return (check == CRED_EXIST_MARK) ? TRUE : FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_check
+[Description]: compare a password with the saved one
+[Args]:
+[in]	const uint8 * pass:
+					Pointer to the password array (CRED_PASSWORD_SIZE digits)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if they matched, FALSE if they didn't, no password is saved or the EEPROM can't be read
+------------------------------------------------------------------*/
+boolean CRED_check(const uint8 * pass)
+{
+	CRED_Record record;
+
+	CRED_checkVerify();
+	if(g_cacheValid == TRUE)
+	{
+		record = g_cache;
+	}
+	else if(CRED_load(&record) == FALSE)
+	{
+		/* the EEPROM can't be read or its checksum is wrong */
+		return FALSE;
+	}
+
+	if(record.exists == FALSE)
+	{
+		return FALSE;
+	}
+	return CRED_compare(pass, record.password);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_save
+[Description]: save a new password in the EEPROM then in the cache
+[Args]:
+[in]	const uint8 * pass:
+					Pointer to the password array (CRED_PASSWORD_SIZE digits)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is saved, FALSE if the EEPROM failed
+------------------------------------------------------------------*/
+boolean CRED_save(const uint8 * pass)
+{
+	uint8 bytes[CRED_PASSWORD_SIZE + 1];
+	uint8 existMark = CRED_EXIST_MARK;
+	uint8 i;
+
+	for(i=0;i<CRED_PASSWORD_SIZE;i++)
+	{
+		bytes[i] = pass[i];
+	}
+	bytes[CRED_PASSWORD_SIZE] = CRED_checksum(pass);
+
+	/*
+	 * the exist byte is written after the password ... used in case of power off,
+	 * the cache is not used till both are written
+	 */
+	CRED_dropVerify();
+	g_cacheValid = FALSE;
+	if((EEPROM_writeBlock(CRED_PASSWORD_ADDRESS, bytes, CRED_PASSWORD_SIZE + 1) != SUCCESS) ||
+			(EEPROM_writeBlock(CRED_EXIST_ADDRESS, &existMark, 1) != SUCCESS))
+	{
+		return FALSE;
+	}
+
+	g_cache.exists = TRUE;
+	for(i=0;i<CRED_PASSWORD_SIZE;i++)
+	{
+		g_cache.password[i] = pass[i];
+	}
+	g_cacheValid = TRUE;
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_erase
+[Description]: delete the saved password by clearing the exist byte
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is deleted, FALSE if the EEPROM failed
+------------------------------------------------------------------*/
+boolean CRED_erase(void)
+{
+	CRED_dropVerify();
+	if(EEPROM_writeByte(CRED_EXIST_ADDRESS, 0x00) != SUCCESS)
+	{
+		/* the exist byte may or may not be written */
+		g_cacheValid = FALSE;
+		return FALSE;
+	}
+	g_cache.exists = FALSE;
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_verify
+[Description]: start reading the EEPROM in the background to compare it with the cache,
+				the result is used by the next request or the next call ... it is called every
+				CRED_VERIFY_PERIOD_MS by a software timer
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void CRED_verify(void)
+{
+	/* a result that no request has used yet */
+	CRED_checkVerify();
+
+	if(g_verifying == FALSE)
+	{
+		if(EEPROM_startRead(&g_verifyTransfer, CRED_EXIST_ADDRESS, g_verifyBytes, CRED_RECORD_SIZE, NULL_PTR) == SUCCESS)
+		{
+			g_verifying = TRUE;
+		}
+	}
+}
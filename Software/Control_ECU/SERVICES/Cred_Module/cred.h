@@ -0,0 +1,133 @@
+ /******************************************************************************
+ *
+ * Module: CRED
+ *
+ * File Name: cred.h
+ *
+ * Description: Header file for the password store cached in RAM and written through to the External EEPROM
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef CRED_H_
+#define CRED_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * EEPROM layout ... the exist byte is followed by the password and its checksum,
+ * the password and the checksum are in the same page so they are saved by one write cycle
+ */
+#define CRED_EXIST_ADDRESS			0x00EF
+#define CRED_PASSWORD_ADDRESS		0x00F0
+#define CRED_PASSWORD_SIZE			5
+#define CRED_CHECKSUM_ADDRESS		(CRED_PASSWORD_ADDRESS + CRED_PASSWORD_SIZE)
+
+/* value of the exist byte when a password is saved */
+#define CRED_EXIST_MARK				0xCC
+
+/*
+ * The cache is loaded by CRED_init and compared with the EEPROM every this time (CRED_verify),
+ * if they are different or the checksum is wrong the cache isn't used and the password is read
+ * from the EEPROM every time till a check finds a valid copy again
+ */
+#define CRED_VERIFY_PERIOD_MS		60000
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_init
+[Description]: load the cache from the EEPROM, I2C_init and SYSTICK_init must be called first ...
+				a password saved before the checksum was added gets its checksum written once
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void CRED_init(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_exists
+[Description]: check if a password is saved
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if a password is saved, FALSE otherwise
+------------------------------------------------------------------*/
+boolean CRED_exists(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_check
+[Description]: compare a password with the saved one
+[Args]:
+[in]	const uint8 * pass:
+					Pointer to the password array (CRED_PASSWORD_SIZE digits)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if they matched, FALSE if they didn't, no password is saved or the EEPROM can't be read
+------------------------------------------------------------------*/
+boolean CRED_check(const uint8 * pass);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_save
+[Description]: save a new password in the EEPROM then in the cache
+[Args]:
+[in]	const uint8 * pass:
+					Pointer to the password array (CRED_PASSWORD_SIZE digits)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is saved, FALSE if the EEPROM failed
+------------------------------------------------------------------*/
+boolean CRED_save(const uint8 * pass);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_erase
+[Description]: delete the saved password by clearing the exist byte
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is deleted, FALSE if the EEPROM failed
+------------------------------------------------------------------*/
+boolean CRED_erase(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  CRED_verify
+[Description]: start reading the EEPROM in the background to compare it with the cache,
+				the result is used by the next request or the next call ... it is called every
+				CRED_VERIFY_PERIOD_MS by a software timer
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void CRED_verify(void);
+
+
+
+#endif /* CRED_H_ */
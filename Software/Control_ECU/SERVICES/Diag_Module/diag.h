@@ -0,0 +1,125 @@
+ /******************************************************************************
+ *
+ * Module: Diag
+ *
+ * File Name: diag.h
+ *
+ * Description: Header file for packing the UART, frame and link counters in diagnostics pages
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef DIAG_H_
+#define DIAG_H_
+
+#include "std_types.h"
+#include "prof.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * The counters don't fit in one frame so they are split in pages,
+ * every page fits in FRAME_MAX_PAYLOAD_SIZE and holds fields of the same size
+ * sent least significant byte first:
+ * DIAG_PAGE_BYTES    : UART rx bytes, tx bytes                                      (uint32)
+ * DIAG_PAGE_ERRORS   : UART frame errors, parity errors, rx overruns, tx overruns,
+ *                      bad frames                                                   (uint16)
+ * DIAG_PAGE_LINK     : rx frames, tx frames, retransmissions, timeouts, dropped frames (uint16)
+ * DIAG_PAGE_RTT_LOW  : round trip time histogram buckets 0 -> 7                     (uint16)
+ * DIAG_PAGE_RTT_HIGH : round trip time histogram buckets 8 -> 15                    (uint16)
+ * DIAG_PAGE_LOOP     : longest main loop iteration in microseconds, iterations       (uint32)
+ * DIAG_PAGE_SLEEP    : percentage of the time slept, milliseconds slept, sleeps,
+ *                      sleeps that lasted till their wake tick                      (uint32)
+ * DIAG_PAGE_RAM      : .data + .bss bytes, stack bytes, deepest stack use,
+ *                      stack bytes never used (stack.h)                             (uint16)
+ * DIAG_PAGE_I2C      : I2C step timeouts, NACKs, bus errors, bus recoveries,
+ *                      empty on the ECU without I2C (i2c.h)                         (uint16)
+ * DIAG_PAGE_PROF + r : times region r is passed, shortest, longest and total time
+ *                      in microseconds, empty if PROF_ENABLE is FALSE (prof.h)      (uint32)
+ */
+#define DIAG_PAGE_BYTES				0
+#define DIAG_PAGE_ERRORS			1
+#define DIAG_PAGE_LINK				2
+#define DIAG_PAGE_RTT_LOW			3
+#define DIAG_PAGE_RTT_HIGH			4
+#define DIAG_PAGE_LOOP				5
+#define DIAG_PAGE_SLEEP				6
+#define DIAG_PAGE_RAM				7
+#define DIAG_PAGE_I2C				8
+#define DIAG_PAGE_PROF				9
+#define DIAG_PROF_MAX_FIELD			2
+#define DIAG_NUM_OF_PAGES			(DIAG_PAGE_PROF + PROF_NUM_OF_REGIONS)
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  DIAG_fillPage
+[Description]: pack the current counters of a page in a frame payload
+[Args]:
+[in]	uint8 page:
+					the page number (DIAG_PAGE_xxx)
+[out]	uint8 * payload:
+					pointer to a buffer of FRAME_MAX_PAYLOAD_SIZE bytes
+[in/out] -NONE
+[Returns]: the number of bytes written or 0 if the page doesn't exist
+------------------------------------------------------------------*/
+uint8 DIAG_fillPage(uint8 page, uint8 * payload);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  DIAG_getFieldSize
+[Description]: get the size of the fields of a page
+[Args]:
+[in]	uint8 page:
+					the page number (DIAG_PAGE_xxx)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the field size in bytes
+------------------------------------------------------------------*/
+uint8 DIAG_getFieldSize(uint8 page);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  DIAG_getField
+[Description]: unpack one field of a page filled by DIAG_fillPage (on this ECU or the other one)
+[Args]:
+[in]	uint8 page:
+					the page number (DIAG_PAGE_xxx)
+		const uint8 * payload:
+					pointer to the page bytes
+		uint8 index:
+					the field number in the page
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the field value
+------------------------------------------------------------------*/
+uint32 DIAG_getField(uint8 page, const uint8 * payload, uint8 index);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  DIAG_recordLoop
+[Description]: count one main loop iteration and keep the longest one,
+				it must be called at the end of every iteration
+[Args]:
+[in]	uint32 start:
+					SYSTICK_getCounts value at the start of the iteration
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void DIAG_recordLoop(uint32 start);
+
+
+
+#endif /* DIAG_H_ */
@@ -0,0 +1,648 @@
+ /******************************************************************************
+ *
+ * Module: LINK
+ *
+ * File Name: link.c
+ *
+ * Description: Source file for the tagged request/response layer used between the HMI_ECU and the Control_ECU
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "link.h"
+#include "uart.h"
+#include "systick.h"
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: LINK_PendingRequest
+[Structure Description]: it holds a request waiting for its response
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint8 seq;			/* LINK_UNTAGGED if the slot is free */
+	boolean done;		/* TRUE once the response is saved */
+	FRAME_Message response;
+}LINK_PendingRequest;
+
+/*------------------------------------------------------------------
+[Structure Name]: LINK_QueuedFrame
+[Structure Description]: it holds a received frame with the source it came from
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint8 source;
+	FRAME_Message frame;
+}LINK_QueuedFrame;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* parser kept between the calls so a frame can be received over many polls */
+static FRAME_Parser g_parser = {FRAME_WAIT_SYNC};
+
+/* requests waiting for their responses */
+static LINK_PendingRequest g_pending[LINK_MAX_PENDING];
+
+/* the last sequence number given to a request */
+static uint8 g_lastSeq = 0;
+
+/* queue of the received frames that are not responses ... g_queue[0] is the oldest */
+static LINK_QueuedFrame g_queue[LINK_QUEUE_SIZE];
+static uint8 g_queueCount = 0;
+
+/* the source of the frames being received */
+static uint8 g_source = LINK_DEFAULT_SOURCE;
+
+/* sequence number of the frame being handled (used by LINK_reply) */
+static uint8 g_currentSeq = LINK_UNTAGGED;
+
+/* the time the frame being handled was taken from the queue */
+static uint32 g_currentStart = 0;
+
+/* link counters and round trip time histogram */
+static LINK_Statistics g_stats;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void LINK_dispatch(const FRAME_Message * frame);
+
+static void LINK_recordRtt(uint32 start);
+
+static void LINK_sendAttempt(LINK_Transaction * transaction);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_poll
+[Description]: parse all the bytes waiting in the UART Rx buffer,
+				responses are matched with their pending requests and
+				any other frame is put in the receive queue
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_poll(void)
+{
+	UART_Status status;
+	uint8 data;
+
+	while((status = UART_receiveByteNonBlocking(&data)) != UART_NO_DATA)
+	{
+		if(status != UART_SUCCESS)
+		{
+			/* a byte is lost or corrupted ... drop the partial frame and resync */
+			FRAME_initParser(&g_parser);
+		}
+		else if(FRAME_parseByte(&g_parser, data) == TRUE)
+		{
+			LINK_dispatch(&g_parser.message);
+		}
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_sendRequest
+[Description]: send a tagged request without waiting for its response
+[Args]:
+[in]	uint8 type:
+					the command
+		const uint8 * payload:
+					pointer to the payload bytes (can be NULL_PTR if length is 0)
+		uint8 length:
+					number of payload bytes
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the sequence number of the request or LINK_UNTAGGED if
+			LINK_MAX_PENDING requests are already waiting
+------------------------------------------------------------------*/
+uint8 LINK_sendRequest(uint8 type, const uint8 * payload, uint8 length)
+{
+	uint8 i;
+
+	for(i=0;i<LINK_MAX_PENDING;i++)
+	{
+		if(g_pending[i].seq == LINK_UNTAGGED)
+		{
+			/* next sequence number in the range 1 -> 127 */
+			g_lastSeq = (g_lastSeq % (LINK_RESPONSE_FLAG - 1)) + 1;
+
+			g_pending[i].seq = g_lastSeq;
+			g_pending[i].done = FALSE;
+
+			FRAME_send(type, g_lastSeq, payload, length);
+			return g_lastSeq;
+		}
+	}
+
+	/* no free slot */
+	return LINK_UNTAGGED;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_getResponse
+[Description]: check if the response of a request has arrived,
+				the request is forgotten once its response is returned
+[Args]:
+[in]	uint8 seq:
+					the sequence number returned by LINK_sendRequest
+[out]	FRAME_Message * response:
+					pointer to the structure you want to save the response in
+[in/out] -NONE
+[Returns]: TRUE if the response is returned, FALSE if it hasn't arrived yet
+------------------------------------------------------------------*/
+boolean LINK_getResponse(uint8 seq, FRAME_Message * response)
+{
+	uint8 i;
+
+	for(i=0;i<LINK_MAX_PENDING;i++)
+	{
+		if((g_pending[i].seq == seq) && (g_pending[i].done == TRUE))
+		{
+			*response = g_pending[i].response;
+			g_pending[i].seq = LINK_UNTAGGED;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_cancel
+[Description]: forget a pending request, a late response is dropped
+[Args]:
+[in]	uint8 seq:
+					the sequence number returned by LINK_sendRequest
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_cancel(uint8 seq)
+{
+	uint8 i;
+
+	for(i=0;i<LINK_MAX_PENDING;i++)
+	{
+		if(g_pending[i].seq == seq)
+		{
+			g_pending[i].seq = LINK_UNTAGGED;
+		}
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_transact
+[Description]: send a request and wait for its response, the request is sent again
+				with a new sequence number if no response comes in LINK_RESPONSE_TIMEOUT_MS
+[Args]:
+[in]	uint8 type:
+					the command
+		const uint8 * payload:
+					pointer to the payload bytes (can be NULL_PTR if length is 0)
+		uint8 length:
+					number of payload bytes
+[out]	FRAME_Message * response:
+					pointer to the structure you want to save the response in
+[in/out] -NONE
+[Returns]: TRUE if the response is received, FALSE if all the retries timed out
+------------------------------------------------------------------*/
+boolean LINK_transact(uint8 type, const uint8 * payload, uint8 length, FRAME_Message * response)
+{
+	LINK_Transaction transaction;
+	LINK_TransactionStatus status;
+
+	LINK_startTransaction(&transaction, type, payload, length);
+	do
+	{
+		status = LINK_pollTransaction(&transaction, response);
+	}while(status == LINK_PENDING);
+
+	if(status == LINK_DONE)
+	{
+		return TRUE;
+	}
+	return FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_startTransaction
+[Description]: send a request without waiting, LINK_pollTransaction must be called
+				till the response comes or all the retries time out
+[Args]:
+[in]	uint8 type:
+					the command
+		const uint8 * payload:
+					pointer to the payload bytes (can be NULL_PTR if length is 0)
+		uint8 length:
+					number of payload bytes
+[out]	LINK_Transaction * transaction:
+					pointer to the structure that holds the transaction
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_startTransaction(LINK_Transaction * transaction, uint8 type, const uint8 * payload, uint8 length)
+{
+	uint8 i;
+
+	if(length > FRAME_MAX_PAYLOAD_SIZE)
+	{
+		length = FRAME_MAX_PAYLOAD_SIZE;
+	}
+
+	/* keep a copy of the request to send it again */
+	transaction->type = type;
+	transaction->length = length;
+	for(i=0;i<length;i++)
+	{
+		transaction->payload[i] = payload[i];
+	}
+	transaction->attempt = 0;
+
+	LINK_sendAttempt(transaction);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_pollTransaction
+[Description]: check a transaction without waiting, the request is sent again with a new
+				sequence number if no response comes in LINK_RESPONSE_TIMEOUT_MS
+[Args]:
+[in]	-NONE
+[out]	FRAME_Message * response:
+					pointer to the structure you want to save the response in
+[in/out] LINK_Transaction * transaction:
+					pointer to the transaction
+[Returns]: LINK_DONE if the response is received, LINK_FAILED if all the retries
+			timed out or LINK_PENDING otherwise
+------------------------------------------------------------------*/
+LINK_TransactionStatus LINK_pollTransaction(LINK_Transaction * transaction, FRAME_Message * response)
+{
+	LINK_poll();
+
+	if((transaction->seq != LINK_UNTAGGED) && (LINK_getResponse(transaction->seq, response) == TRUE))
+	{
+		LINK_recordRtt(transaction->start);
+		transaction->seq = LINK_UNTAGGED;
+		return LINK_DONE;
+	}
+
+	if(SYSTICK_isExpired(transaction->deadline) == FALSE)
+	{
+		return LINK_PENDING;
+	}
+
+	/* no response ... forget the request so a late response is dropped */
+	LINK_abortTransaction(transaction);
+
+	if(transaction->attempt >= LINK_MAX_RETRIES)
+	{
+		g_stats.timeouts++;
+		return LINK_FAILED;
+	}
+
+	transaction->attempt++;
+	g_stats.retransmissions++;
+	LINK_sendAttempt(transaction);
+
+	return LINK_PENDING;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_abortTransaction
+[Description]: forget a transaction before it is done, a late response is dropped
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] LINK_Transaction * transaction:
+					pointer to the transaction
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_abortTransaction(LINK_Transaction * transaction)
+{
+	if(transaction->seq != LINK_UNTAGGED)
+	{
+		LINK_cancel(transaction->seq);
+		transaction->seq = LINK_UNTAGGED;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_receive
+[Description]: take the oldest frame of the selected source from the receive queue without waiting
+[Args]:
+[in]	-NONE
+[out]	FRAME_Message * frame:
+					pointer to the structure you want to save the frame in
+[in/out] -NONE
+[Returns]: TRUE if a frame is returned, FALSE if the source has no frame queued
+------------------------------------------------------------------*/
+boolean LINK_receive(FRAME_Message * frame)
+{
+	uint8 i;
+
+	LINK_poll();
+
+	/* the frames of the other sources wait for their turn */
+	for(i=0;(i<g_queueCount) && (g_queue[i].source != g_source);i++);
+	if(i == g_queueCount)
+	{
+		return FALSE;
+	}
+
+	*frame = g_queue[i].frame;
+
+	/* close the gap so the queue stays in the arrival order */
+	g_queueCount--;
+	for(;i<g_queueCount;i++)
+	{
+		g_queue[i] = g_queue[i + 1];
+	}
+
+	/* remember who is waiting for the answer */
+	g_currentSeq = frame->seq;
+	g_currentStart = SYSTICK_getCounts();
+
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_waitFrame
+[Description]: wait for a frame in the receive queue but give up after a certain time
+[Args]:
+[in]	uint16 timeoutMs:
+					maximum time to wait in milliseconds
+[out]	FRAME_Message * frame:
+					pointer to the structure you want to save the frame in
+[in/out] -NONE
+[Returns]: TRUE if a frame is returned or FALSE if the time is out
+------------------------------------------------------------------*/
+boolean LINK_waitFrame(FRAME_Message * frame, uint16 timeoutMs)
+{
+	uint32 deadline = SYSTICK_getDeadline(timeoutMs);
+
+	while(LINK_receive(frame) == FALSE)
+	{
+		if(SYSTICK_isExpired(deadline) == TRUE)
+		{
+			return FALSE;
+		}
+
+		/* the CPU sleeps till the next byte comes */
+		UART_waitForData(deadline);
+	}
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_isReceiving
+[Description]: check if a frame has started but is not complete yet
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the parser is in the middle of a frame, FALSE otherwise
+------------------------------------------------------------------*/
+boolean LINK_isReceiving(void)
+{
+	LINK_poll();
+
+	if(g_parser.state == FRAME_WAIT_SYNC)
+	{
+		return FALSE;
+	}
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_selectSource
+[Description]: set the peer the next frames come from (the panel selected on the multi-drop bus),
+				the queued frames of the other sources are kept till their source is selected again
+				and LINK_receive returns only the frames of the selected source
+[Args]:
+[in]	uint8 source:
+					the source (its bus address)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_selectSource(uint8 source)
+{
+	/* the complete frames belong to the old source ... a frame it didn't finish is dropped
+	 * so its bytes aren't joined with the bytes of the new source, the same source selected
+	 * again goes on with its frame */
+	LINK_poll();
+	if(source != g_source)
+	{
+		FRAME_initParser(&g_parser);
+	}
+
+	g_source = source;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_reply
+[Description]: answer the last frame taken by LINK_receive or LINK_waitFrame
+[Args]:
+[in]	uint8 type:
+					the response
+		const uint8 * payload:
+					pointer to the payload bytes (can be NULL_PTR if length is 0)
+		uint8 length:
+					number of payload bytes
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_reply(uint8 type, const uint8 * payload, uint8 length)
+{
+	/* an untagged frame gets an untagged answer */
+	if(g_currentSeq == LINK_UNTAGGED)
+	{
+		FRAME_send(type, LINK_UNTAGGED, payload, length);
+	}
+	else
+	{
+		FRAME_send(type, g_currentSeq | LINK_RESPONSE_FLAG, payload, length);
+		LINK_recordRtt(g_currentStart);
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_getStatistics
+[Description]: take a copy of the link counters and the round trip time histogram
+[Args]:
+[in]	-NONE
+[out]	LINK_Statistics * stats:
+					pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_getStatistics(LINK_Statistics * stats)
+{
+	*stats = g_stats;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_dispatch
+[Description]: save a received frame as the response of its request or put it in the receive queue
+[Args]:
+[in]	const FRAME_Message * frame:
+					the received frame
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void LINK_dispatch(const FRAME_Message * frame)
+{
+	uint8 i;
+	uint8 seq;
+
+	if(frame->seq & LINK_RESPONSE_FLAG)
+	{
+		seq = frame->seq & (uint8)(~LINK_RESPONSE_FLAG);
+		for(i=0;i<LINK_MAX_PENDING;i++)
+		{
+			if((g_pending[i].seq == seq) && (g_pending[i].done == FALSE))
+			{
+				g_pending[i].response = *frame;
+				g_pending[i].done = TRUE;
+				return;
+			}
+		}
+		/* response of a cancelled request ... drop it */
+		g_stats.droppedFrames++;
+		return;
+	}
+
+	/* the queue is full ... drop the frame, the sender will time out */
+	if(g_queueCount == LINK_QUEUE_SIZE)
+	{
+		g_stats.droppedFrames++;
+		return;
+	}
+
+	g_queue[g_queueCount].source = g_source;
+	g_queue[g_queueCount].frame = *frame;
+	g_queueCount++;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_recordRtt
+[Description]: add the time passed since start to the round trip time histogram
+[Args]:
+[in]	uint32 start:
+					the SYSTICK_getCounts value at the start of the transaction
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void LINK_recordRtt(uint32 start)
+{
+	uint32 rtt = SYSTICK_COUNTS_TO_US(SYSTICK_getCounts() - start) / LINK_RTT_UNIT_US;
+	uint8 bucket = 0;
+
+	/* bucket = log2(rtt) limited to the last bucket */
+	while((rtt > 1) && (bucket < (LINK_RTT_BUCKETS - 1)))
+	{
+		rtt >>= 1;
+		bucket++;
+	}
+
+	/* the counter sticks at its maximum instead of wrapping */
+	if(g_stats.rttHistogram[bucket] != 0xFFFF)
+	{
+		g_stats.rttHistogram[bucket]++;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_sendAttempt
+[Description]: send the request of a transaction with a new sequence number,
+				if all the pending slots are busy it is tried again when the attempt times out
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] LINK_Transaction * transaction:
+					pointer to the transaction
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void LINK_sendAttempt(LINK_Transaction * transaction)
+{
+	transaction->start = SYSTICK_getCounts();
+	transaction->seq = LINK_sendRequest(transaction->type, transaction->payload, transaction->length);
+	transaction->deadline = SYSTICK_getDeadline(LINK_RESPONSE_TIMEOUT_MS);
+}
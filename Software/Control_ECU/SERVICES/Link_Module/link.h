@@ -0,0 +1,342 @@
+ /******************************************************************************
+ *
+ * Module: LINK
+ *
+ * File Name: link.h
+ *
+ * Description: Header file for the tagged request/response layer used between the HMI_ECU and the Control_ECU
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+#ifndef LINK_H_
+#define LINK_H_
+
+#include "std_types.h"
+#include "frame.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Every request gets a sequence number 1 -> 127 in the SEQ field of its frame,
+ * the response carries the same number with LINK_RESPONSE_FLAG set so both ECUs
+ * can tell a response from a new request.
+ * SEQ = 0 is used for untagged frames (handshake and baud rate negotiation).
+ */
+#define LINK_UNTAGGED				0
+#define LINK_RESPONSE_FLAG			0x80
+
+/* maximum number of requests waiting for a response at the same time */
+#define LINK_MAX_PENDING			4
+
+/* maximum number of received requests waiting to be handled ... the sources share it */
+#define LINK_QUEUE_SIZE				4
+
+/* source of the received frames till LINK_selectSource is called (a device with one peer never calls it) */
+#define LINK_DEFAULT_SOURCE			0
+
+/* time to wait for a response before the request is sent again */
+#define LINK_RESPONSE_TIMEOUT_MS	500
+
+/* number of times a request is sent again before LINK_transact gives up */
+#define LINK_MAX_RETRIES			2
+
+/*
+ * Round trip times are kept in a log2 histogram of LINK_RTT_UNIT_US units,
+ * bucket i counts the times in [2^i, 2^(i+1)) units and the last bucket takes all the longer ones.
+ * The requester measures from sending a request till its response arrives,
+ * the responder measures from taking a request till replying to it.
+ */
+#define LINK_RTT_BUCKETS			16
+#define LINK_RTT_UNIT_US			8
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[ENUM Name]: LINK_TransactionStatus
+[ENUM Description]: it's used to report the state of a transaction started by LINK_startTransaction
+------------------------------------------------------------------*/
+typedef enum
+{
+	LINK_PENDING,LINK_DONE,LINK_FAILED
+}LINK_TransactionStatus;
+
+/*------------------------------------------------------------------
+[Structure Name]: LINK_Transaction
+[Structure Description]: it holds a request till its response comes, the request is kept
+						so it can be sent again if the response times out
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint8 type;
+	uint8 length;
+	uint8 payload[FRAME_MAX_PAYLOAD_SIZE];
+	uint8 seq;				/* sequence number of the last attempt */
+	uint8 attempt;			/* number of the times the request is sent again */
+	uint32 start;			/* SYSTICK_getCounts value when the last attempt was sent */
+	uint32 deadline;		/* tick at which the last attempt times out */
+}LINK_Transaction;
+
+/*------------------------------------------------------------------
+[Structure Name]: LINK_Statistics
+[Structure Description]: it's used to report the link counters since power up
+					retransmissions : requests sent again because the response timed out
+					timeouts        : transactions that failed after all the retries
+					droppedFrames   : late responses and requests that found the queue full
+					rttHistogram    : the round trip time histogram (see LINK_RTT_BUCKETS)
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint16 retransmissions;
+	uint16 timeouts;
+	uint16 droppedFrames;
+	uint16 rttHistogram[LINK_RTT_BUCKETS];
+}LINK_Statistics;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_poll
+[Description]: parse all the bytes waiting in the UART Rx buffer,
+				responses are matched with their pending requests and
+				any other frame is put in the receive queue
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_poll(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_sendRequest
+[Description]: send a tagged request without waiting for its response
+[Args]:
+[in]	uint8 type:
+					the command
+		const uint8 * payload:
+					pointer to the payload bytes (can be NULL_PTR if length is 0)
+		uint8 length:
+					number of payload bytes
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the sequence number of the request or LINK_UNTAGGED if
+			LINK_MAX_PENDING requests are already waiting
+------------------------------------------------------------------*/
+uint8 LINK_sendRequest(uint8 type, const uint8 * payload, uint8 length);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_getResponse
+[Description]: check if the response of a request has arrived,
+				the request is forgotten once its response is returned
+[Args]:
+[in]	uint8 seq:
+					the sequence number returned by LINK_sendRequest
+[out]	FRAME_Message * response:
+					pointer to the structure you want to save the response in
+[in/out] -NONE
+[Returns]: TRUE if the response is returned, FALSE if it hasn't arrived yet
+------------------------------------------------------------------*/
+boolean LINK_getResponse(uint8 seq, FRAME_Message * response);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_cancel
+[Description]: forget a pending request, a late response is dropped
+[Args]:
+[in]	uint8 seq:
+					the sequence number returned by LINK_sendRequest
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_cancel(uint8 seq);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_transact
+[Description]: send a request and wait for its response, the request is sent again
+				with a new sequence number if no response comes in LINK_RESPONSE_TIMEOUT_MS
+[Args]:
+[in]	uint8 type:
+					the command
+		const uint8 * payload:
+					pointer to the payload bytes (can be NULL_PTR if length is 0)
+		uint8 length:
+					number of payload bytes
+[out]	FRAME_Message * response:
+					pointer to the structure you want to save the response in
+[in/out] -NONE
+[Returns]: TRUE if the response is received, FALSE if all the retries timed out
+------------------------------------------------------------------*/
+boolean LINK_transact(uint8 type, const uint8 * payload, uint8 length, FRAME_Message * response);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_startTransaction
+[Description]: send a request without waiting, LINK_pollTransaction must be called
+				till the response comes or all the retries time out
+[Args]:
+[in]	uint8 type:
+					the command
+		const uint8 * payload:
+					pointer to the payload bytes (can be NULL_PTR if length is 0)
+		uint8 length:
+					number of payload bytes
+[out]	LINK_Transaction * transaction:
+					pointer to the structure that holds the transaction
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_startTransaction(LINK_Transaction * transaction, uint8 type, const uint8 * payload, uint8 length);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_pollTransaction
+[Description]: check a transaction without waiting, the request is sent again with a new
+				sequence number if no response comes in LINK_RESPONSE_TIMEOUT_MS
+[Args]:
+[in]	-NONE
+[out]	FRAME_Message * response:
+					pointer to the structure you want to save the response in
+[in/out] LINK_Transaction * transaction:
+					pointer to the transaction
+[Returns]: LINK_DONE if the response is received, LINK_FAILED if all the retries
+			timed out or LINK_PENDING otherwise
+------------------------------------------------------------------*/
+LINK_TransactionStatus LINK_pollTransaction(LINK_Transaction * transaction, FRAME_Message * response);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_abortTransaction
+[Description]: forget a transaction before it is done, a late response is dropped
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] LINK_Transaction * transaction:
+					pointer to the transaction
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_abortTransaction(LINK_Transaction * transaction);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_receive
+[Description]: take the oldest frame from the receive queue without waiting
+[Args]:
+[in]	-NONE
+[out]	FRAME_Message * frame:
+					pointer to the structure you want to save the frame in
+[in/out] -NONE
+[Returns]: TRUE if a frame is returned, FALSE if the queue is empty
+------------------------------------------------------------------*/
+boolean LINK_receive(FRAME_Message * frame);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_waitFrame
+[Description]: wait for a frame in the receive queue but give up after a certain time
+[Args]:
+[in]	uint16 timeoutMs:
+					maximum time to wait in milliseconds
+[out]	FRAME_Message * frame:
+					pointer to the structure you want to save the frame in
+[in/out] -NONE
+[Returns]: TRUE if a frame is returned or FALSE if the time is out
+------------------------------------------------------------------*/
+boolean LINK_waitFrame(FRAME_Message * frame, uint16 timeoutMs);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_isReceiving
+[Description]: check if a frame has started but is not complete yet
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the parser is in the middle of a frame, FALSE otherwise
+------------------------------------------------------------------*/
+boolean LINK_isReceiving(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_selectSource
+[Description]: set the peer the next frames come from (the panel selected on the multi-drop bus),
+				the queued frames of the other sources are kept till their source is selected again
+				and LINK_receive returns only the frames of the selected source
+[Args]:
+[in]	uint8 source:
+					the source (its bus address)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_selectSource(uint8 source);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_reply
+[Description]: answer the last frame taken by LINK_receive or LINK_waitFrame
+[Args]:
+[in]	uint8 type:
+					the response
+		const uint8 * payload:
+					pointer to the payload bytes (can be NULL_PTR if length is 0)
+		uint8 length:
+					number of payload bytes
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_reply(uint8 type, const uint8 * payload, uint8 length);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  LINK_getStatistics
+[Description]: take a copy of the link counters and the round trip time histogram
+[Args]:
+[in]	-NONE
+[out]	LINK_Statistics * stats:
+					pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void LINK_getStatistics(LINK_Statistics * stats);
+
+
+
+#endif /* LINK_H_ */
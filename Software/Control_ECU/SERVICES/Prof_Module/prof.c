@@ -0,0 +1,171 @@
+ /******************************************************************************
+ *
+ * Module: Prof
+ *
+ * File Name: prof.c
+ *
+ * Description: Source file for timing the hot code regions
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "prof.h"
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* latency budget of every region */
+static const uint32 g_budgets[PROF_NUM_OF_REGIONS] = PROF_BUDGETS_US;
+
+#if(PROF_ENABLE == TRUE)
+
+/* one row per region */
+static PROF_Region g_regions[PROF_NUM_OF_REGIONS];
+
+/* start time of every region timed by PROF_START and whether it is running */
+static uint32 g_starts[PROF_NUM_OF_REGIONS];
+static boolean g_started[PROF_NUM_OF_REGIONS];
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  PROF_record
+[Description]: add one time to the row of a region, used by PROF_END and PROF_RECORD
+[Args]:
+[in]	uint8 region:
+					the region (PROF_xxx)
+		uint32 timeUs:
+					the time in microseconds
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void PROF_record(uint8 region, uint32 timeUs)
+{
+	PROF_Region * row;
+
+	if(region >= PROF_NUM_OF_REGIONS)
+	{
+		return;
+	}
+	row = &g_regions[region];
+
+	if((row->count == 0) || (timeUs < row->min))
+	{
+		row->min = timeUs;
+	}
+	if(timeUs > row->max)
+	{
+		row->max = timeUs;
+	}
+
+	/* the total sticks at its maximum instead of wrapping */
+	if((row->total + timeUs) < row->total)
+	{
+		row->total = 0xFFFFFFFF;
+	}
+	else
+	{
+		row->total += timeUs;
+	}
+	row->count++;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  PROF_getRegion
+[Description]: take a copy of the row of a region
+[Args]:
+[in]	uint8 region:
+					the region (PROF_xxx)
+[out]	PROF_Region * row:
+					pointer to the structure you want to save the row in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void PROF_getRegion(uint8 region, PROF_Region * row)
+{
+	if(region < PROF_NUM_OF_REGIONS)
+	{
+		*row = g_regions[region];
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  PROF_start
+[Description]: keep the start time of a region, used by PROF_START
+[Args]:
+[in]	uint8 region:
+					the region (PROF_xxx)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void PROF_start(uint8 region)
+{
+	if(region < PROF_NUM_OF_REGIONS)
+	{
+		g_starts[region] = SYSTICK_getCounts();
+		g_started[region] = TRUE;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  PROF_stop
+[Description]: add the time since PROF_start to the row of a region, used by PROF_STOP
+[Args]:
+[in]	uint8 region:
+					the region (PROF_xxx)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void PROF_stop(uint8 region)
+{
+	if((region < PROF_NUM_OF_REGIONS) && (g_started[region] == TRUE))
+	{
+		g_started[region] = FALSE;
+		PROF_record(region, SYSTICK_COUNTS_TO_US(SYSTICK_getCounts() - g_starts[region]));
+	}
+}
+
+#endif
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  PROF_getBudget
+[Description]: get the latency budget of a region (see PROF_BUDGETS_US),
+				it is available even if PROF_ENABLE is FALSE
+[Args]:
+[in]	uint8 region:
+					the region (PROF_xxx)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the budget in microseconds or 0 if the region doesn't exist
+------------------------------------------------------------------*/
+uint32 PROF_getBudget(uint8 region)
+{
+	if(region < PROF_NUM_OF_REGIONS)
+	{
+		return g_budgets[region];
+	}
+	return 0;
+}
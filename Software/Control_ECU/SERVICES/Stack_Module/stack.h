@@ -0,0 +1,67 @@
+ /******************************************************************************
+ *
+ * Module: Stack
+ *
+ * File Name: stack.h
+ *
+ * Description: Header file for measuring the RAM used by the stack
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef STACK_H_
+#define STACK_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * All the RAM between the end of .bss and the top of the stack is filled with this byte
+ * before main is called, the bytes that still hold it have never been used by the stack
+ */
+#define STACK_PAINT_BYTE			0xC5
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: STACK_Usage
+[Structure Description]: it's used to report the RAM usage in bytes
+					staticRam : .data and .bss of all the modules
+					stackSize : RAM left for the stack
+					maxUsed   : deepest the stack has been since power up (high water mark)
+					neverUsed : stack bytes that have never been touched
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint16 staticRam;
+	uint16 stackSize;
+	uint16 maxUsed;
+	uint16 neverUsed;
+}STACK_Usage;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  STACK_getUsage
+[Description]: measure the stack high water mark by counting the painted bytes
+				that are still untouched above the end of .bss
+[Args]:
+[in]	-NONE
+[out]	STACK_Usage * usage:
+					pointer to the structure you want to save the usage in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void STACK_getUsage(STACK_Usage * usage);
+
+
+
+#endif /* STACK_H_ */
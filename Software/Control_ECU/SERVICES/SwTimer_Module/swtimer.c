@@ -0,0 +1,284 @@
+ /******************************************************************************
+ *
+ * Module: SWTIMER
+ *
+ * File Name: swtimer.c
+ *
+ * Description: Source file for the software timers wheel driven by the SysTick
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "swtimer.h"
+#include "systick.h"
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* list of the running timers of every slot */
+static SWTIMER_Timer * g_wheel[SWTIMER_WHEEL_SIZE];
+
+/* the last tick handled by SWTIMER_process */
+static uint32 g_lastTick = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void SWTIMER_link(SWTIMER_Timer * timer);
+
+static void SWTIMER_unlink(SWTIMER_Timer * timer);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_init
+[Description]: start the wheel from the current tick, SYSTICK_init must be called before
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SWTIMER_init(void)
+{
+	uint8 i;
+
+	for(i=0;i<SWTIMER_WHEEL_SIZE;i++)
+	{
+		g_wheel[i] = NULL_PTR;
+	}
+	g_lastTick = SYSTICK_getTicks();
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_start
+[Description]: arm a one-shot or a periodic timer, a running timer is restarted
+[Args]:
+[in]	uint32 timeoutMs:
+					time till the first expiry in milliseconds
+		uint32 periodMs:
+					time between the next expiries or 0 for a one-shot timer
+		void (*callback)(void):
+					function called from SWTIMER_process at every expiry (can be NULL_PTR)
+[out]	-NONE
+[in/out] SWTIMER_Timer * timer:
+					pointer to the timer
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SWTIMER_start(SWTIMER_Timer * timer, uint32 timeoutMs, uint32 periodMs, void (*callback)(void))
+{
+	SWTIMER_cancel(timer);
+
+	timer->expiry = SYSTICK_getTicks() + timeoutMs;
+	timer->period = periodMs;
+	timer->callback = callback;
+
+	/* a tick that is already handled would wait for the counter to wrap ... take the next one */
+	if((sint32)(timer->expiry - g_lastTick) <= 0)
+	{
+		timer->expiry = g_lastTick + 1;
+	}
+
+	SWTIMER_link(timer);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_cancel
+[Description]: stop a timer, nothing happens if it is not running
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] SWTIMER_Timer * timer:
+					pointer to the timer
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SWTIMER_cancel(SWTIMER_Timer * timer)
+{
+	if(timer->running == TRUE)
+	{
+		SWTIMER_unlink(timer);
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_isRunning
+[Description]: check if a timer is still armed (a one-shot timer stops after it fires)
+[Args]:
+[in]	const SWTIMER_Timer * timer:
+					pointer to the timer
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the timer is running, FALSE otherwise
+------------------------------------------------------------------*/
+boolean SWTIMER_isRunning(const SWTIMER_Timer * timer)
+{
+	return timer->running;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_getNextExpiry
+[Description]: find the tick at which the next running timer expires,
+				used to know how long the CPU can sleep
+[Args]:
+[in]	-NONE
+[out]	uint32 * expiry:
+					pointer to the variable you want to save the tick in
+[in/out] -NONE
+[Returns]: TRUE if a timer is running, FALSE otherwise
+------------------------------------------------------------------*/
+boolean SWTIMER_getNextExpiry(uint32 * expiry)
+{
+	SWTIMER_Timer * timer;
+	boolean found = FALSE;
+	uint8 i;
+
+	/* the slots also hold timers of the next turns of the wheel so all of them are checked */
+	for(i=0;i<SWTIMER_WHEEL_SIZE;i++)
+	{
+		for(timer=g_wheel[i];timer!=NULL_PTR;timer=timer->next)
+		{
+			if((found == FALSE) || ((sint32)(timer->expiry - *expiry) < 0))
+			{
+				*expiry = timer->expiry;
+				found = TRUE;
+			}
+		}
+	}
+	return found;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_process
+[Description]: fire the timers expired since the last call, must be called from the main loop,
+				the callbacks run here so they must not wait for long
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SWTIMER_process(void)
+{
+	uint32 now = SYSTICK_getTicks();
+	SWTIMER_Timer * timer;
+	boolean fired;
+
+	/* handle every tick passed since the last call one by one */
+	while((sint32)(now - g_lastTick) > 0)
+	{
+		g_lastTick++;
+
+		do
+		{
+			fired = FALSE;
+			for(timer=g_wheel[g_lastTick & (SWTIMER_WHEEL_SIZE - 1)];timer!=NULL_PTR;timer=timer->next)
+			{
+				/* the slot also holds timers of the next turns of the wheel */
+				if(timer->expiry != g_lastTick)
+				{
+					continue;
+				}
+
+				SWTIMER_unlink(timer);
+				if(timer->period != 0)
+				{
+					timer->expiry += timer->period;
+					SWTIMER_link(timer);
+				}
+				if(timer->callback != NULL_PTR)
+				{
+					timer->callback();
+				}
+
+				/* the callback may have started or cancelled timers of this slot ... scan it again */
+				fired = TRUE;
+				break;
+			}
+		}while(fired == TRUE);
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_link
+[Description]: put a timer at the head of the list of its expiry slot
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] SWTIMER_Timer * timer:
+					pointer to the timer
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void SWTIMER_link(SWTIMER_Timer * timer)
+{
+	SWTIMER_Timer ** head = &g_wheel[timer->expiry & (SWTIMER_WHEEL_SIZE - 1)];
+
+	timer->prev = NULL_PTR;
+	timer->next = *head;
+	if(*head != NULL_PTR)
+	{
+		(*head)->prev = timer;
+	}
+	*head = timer;
+	timer->running = TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_unlink
+[Description]: take a timer out of the list of its slot
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] SWTIMER_Timer * timer:
+					pointer to the timer
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void SWTIMER_unlink(SWTIMER_Timer * timer)
+{
+	if(timer->prev != NULL_PTR)
+	{
+		timer->prev->next = timer->next;
+	}
+	else
+	{
+		g_wheel[timer->expiry & (SWTIMER_WHEEL_SIZE - 1)] = timer->next;
+	}
+
+	if(timer->next != NULL_PTR)
+	{
+		timer->next->prev = timer->prev;
+	}
+	timer->running = FALSE;
+}
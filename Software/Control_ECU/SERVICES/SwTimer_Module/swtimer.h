@@ -0,0 +1,150 @@
+ /******************************************************************************
+ *
+ * Module: SWTIMER
+ *
+ * File Name: swtimer.h
+ *
+ * Description: Header file for the software timers wheel driven by the SysTick
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef SWTIMER_H_
+#define SWTIMER_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Number of one millisecond slots in the wheel ... must be a power of two.
+ * A timer is linked in the slot of its expiry tick so arming and cancelling are O(1),
+ * timers longer than one turn of the wheel stay in their slot till their turn comes.
+ */
+#define SWTIMER_WHEEL_SIZE			64
+
+#if(SWTIMER_WHEEL_SIZE & (SWTIMER_WHEEL_SIZE - 1))
+#error "SWTIMER_WHEEL_SIZE should be a power of two"
+#endif
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: SWTIMER_Timer
+[Structure Description]: it holds one software timer ... owned by the caller, it must be static
+						or global so it starts stopped and stays alive while it is running
+------------------------------------------------------------------*/
+typedef struct SWTIMER_Timer
+{
+	struct SWTIMER_Timer * next;
+	struct SWTIMER_Timer * prev;
+	uint32 expiry;				/* the tick at which it fires */
+	uint32 period;				/* 0 for a one-shot timer */
+	void (*callback)(void);		/* can be NULL_PTR */
+	boolean running;
+}SWTIMER_Timer;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_init
+[Description]: start the wheel from the current tick, SYSTICK_init must be called before
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SWTIMER_init(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_start
+[Description]: arm a one-shot or a periodic timer, a running timer is restarted
+[Args]:
+[in]	uint32 timeoutMs:
+					time till the first expiry in milliseconds
+		uint32 periodMs:
+					time between the next expiries or 0 for a one-shot timer
+		void (*callback)(void):
+					function called from SWTIMER_process at every expiry (can be NULL_PTR)
+[out]	-NONE
+[in/out] SWTIMER_Timer * timer:
+					pointer to the timer
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SWTIMER_start(SWTIMER_Timer * timer, uint32 timeoutMs, uint32 periodMs, void (*callback)(void));
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_cancel
+[Description]: stop a timer, nothing happens if it is not running
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] SWTIMER_Timer * timer:
+					pointer to the timer
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SWTIMER_cancel(SWTIMER_Timer * timer);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_isRunning
+[Description]: check if a timer is still armed (a one-shot timer stops after it fires)
+[Args]:
+[in]	const SWTIMER_Timer * timer:
+					pointer to the timer
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the timer is running, FALSE otherwise
+------------------------------------------------------------------*/
+boolean SWTIMER_isRunning(const SWTIMER_Timer * timer);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_getNextExpiry
+[Description]: find the tick at which the next running timer expires,
+				used to know how long the CPU can sleep
+[Args]:
+[in]	-NONE
+[out]	uint32 * expiry:
+					pointer to the variable you want to save the tick in
+[in/out] -NONE
+[Returns]: TRUE if a timer is running, FALSE otherwise
+------------------------------------------------------------------*/
+boolean SWTIMER_getNextExpiry(uint32 * expiry);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SWTIMER_process
+[Description]: fire the timers expired since the last call, must be called from the main loop,
+				the callbacks run here so they must not wait for long
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SWTIMER_process(void);
+
+
+
+#endif /* SWTIMER_H_ */
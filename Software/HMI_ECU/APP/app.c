@@ -13,19 +13,94 @@
 #include "lcd.h"
 #include "keypad.h"
 #include "uart.h"
-#include "timer.h"
-#include <util/delay.h>
+#include "frame.h"
+#include "baud.h"
+#include "link.h"
+#include "diag.h"
+#include "systick.h"
+#include "swtimer.h"
+#include "idle.h"
+#include "prof.h"
 #include <avr/io.h>
 
 /*******************************************************************************
  *                           Global Variables                                  *
  *******************************************************************************/
-/* seconds counter */
-uint8 g_sec = 0;
-
 /* counter to count how many times password has been written wrong */
 uint8 passWrongCounter = 0;
 
+/* the current state and the state to go back to after the link is synced again */
+static APP_State g_state = STATE_SYNC;
+static APP_State g_resumeState = STATE_SYNC;
+
+/* the request waiting for the Control ECU ... kept so it can be repeated after a resync */
+static LINK_Transaction g_transaction;
+static boolean g_requestActive = FALSE;
+static boolean g_resendRequest = FALSE;
+
+/* static so they start stopped and stay alive while they are running */
+static SWTIMER_Timer g_stateTimer;
+static SWTIMER_Timer g_digitTimer;
+static SWTIMER_Timer g_keyScanTimer;
+
+/* arrays to store the first and the second password entered */
+static uint8 g_pass1[PASSWORD_SIZE];
+static uint8 g_pass2[PASSWORD_SIZE];
+
+/* the password being entered, the number of its digits and the LCD column of the first one */
+static uint8 * g_passEntry;
+static uint8 g_digitCount;
+static uint8 g_digitColumn;
+static boolean g_digitShown = FALSE;
+
+/* the main menu option ('+' or '-') the password is checked for */
+static uint8 g_menuChoice;
+
+/* the tick the door phase started at and how far the door was open then (0 -> DOOR_MOVE_MS) */
+static uint32 g_doorPhaseStart;
+static uint32 g_doorPosition = 0;
+
+/* keypad debouncing */
+static uint8 g_rawKey = KEYPAD_NO_KEY;
+static uint8 g_stableKey = KEYPAD_NO_KEY;
+static uint32 g_keyDeadline;
+
+/* the diagnostics page shown, the index of its field shown on the first row and its number of fields */
+static uint8 g_diagPage;
+static uint8 g_diagField;
+static uint8 g_diagCount;
+
+/* TRUE to show the Control ECU counters, FALSE for the HMI ECU ones */
+static boolean g_diagRemote;
+
+/* names of the diagnostics fields shown on the service screen (see diag.h) */
+static const char * const g_diagNames[DIAG_NUM_OF_PAGES][8] =
+{
+	{"RxByt","TxByt"},
+	{"FrErr","PaErr","RxOvr","TxDrp","BadFr"},
+	{"RxFrm","TxFrm","Retry","TmOut","Drop"},
+	{"<16u","<32u","<64u","<128u","<256u","<512u","<1m","<2m"},
+	{"<4m","<8m","<16m","<33m","<66m","<131m","<262m",">262m"},
+	{"LoopU","Loops"},
+	{"Slp%","SlpMs","Slps","TmrWk"},
+	{"Stat","Stack","StkMx","StkFr"},
+	{"I2cTo","Nack","BusEr","Recov"},
+	{"PwChk","MinUs","MaxUs","TotUs"},
+	{"EeRd","MinUs","MaxUs","TotUs"},
+	{"LcdCm","MinUs","MaxUs","TotUs"},
+	{"KeyEc","MinUs","MaxUs","TotUs"},
+	{"PwOk","MinUs","MaxUs","TotUs"},
+	{"NewPw","MinUs","MaxUs","TotUs"},
+	{"Boot","MinUs","MaxUs","TotUs"},
+	{"EeWr","MinUs","MaxUs","TotUs"}
+};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void stateTimeoutCallback(void);
+
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
@@ -41,164 +116,186 @@ uint8 passWrongCounter = 0;
 ------------------------------------------------------------------*/
 void app(void)
 {
-	/* variable to store pressed key */
-	uint8 keyPressed;
-
-	/* array to store first password entered */
-	uint8 pass1arr[PASSWORD_SIZE];
-
-	/* array to store second password entered */
-	uint8 pass2arr[PASSWORD_SIZE];
+	/* holds the event handled by the current state */
+	APP_Event event;
 
-	/* flag to set and reset the password */
-	uint8 passSetFlag = 0;
+	/* Timer1 counts at the start of the iteration ... to measure the longest one */
+	uint32 loopStart;
 
-	/* UART configurations structure */
-	UART_ConfigType uartConfig = {DISABLE_PARITY,ONE_STOPBIT,EIGHT_DATABITS,9600};
+	/* UART configurations structure ... this panel is a slave of the Control ECU */
+	UART_ConfigType uartConfig = {DISABLE_PARITY,ONE_STOPBIT,PANEL_DATABITS,9600,UART_INTERRUPT_MODE,PANEL_ADDRESS};
 
 	/* set I-Bit to enable interrupts */
 	SREG = (1<<7);
 
+	/* start the millisecond tick used by all the timeouts */
+	SYSTICK_init();
+	PROF_START(PROF_POWER_ON_TO_MENU);
+	SWTIMER_init();
+	IDLE_init();
+
+	/* the keypad can't wake the CPU up so it is scanned by a periodic timer while sleeping */
+	SWTIMER_start(&g_keyScanTimer, KEY_SCAN_PERIOD_MS, KEY_SCAN_PERIOD_MS, NULL_PTR);
+
 	/* initialize LCD Screen */
 	LCD_init();
 
-	/* initialize UART */
-	UART_init(&uartConfig);
+	/* initialize UART at the default baud rate */
+	BAUD_init(&uartConfig);
 
-	/* send READY BYTE to the Control ECU */
-	UART_sendByte(HMI_READY);
+	/* wait for the Control ECU and agree on the link speed */
+	changeState(STATE_SYNC);
 
+	/*
+	 * Every iteration takes the timer, UART and keypad events and hands them to the current state,
+	 * a state never waits so the iteration is bounded by the longest LCD update
+	 * (the baud rate negotiation in STATE_SYNC is the only exception).
+	 */
 	while(1)
 	{
-		/* check if the password is set or not */
-		if(passSetFlag == 0)
-		{
-			/* Checks if the User has logged in before
-			 * and the system has restarted for any reason
-			 */
+		loopStart = SYSTICK_getCounts();
 
-			/* asks the Control ECU if password already exists */
-			UART_sendByte(CHECK_IF_PASS_EXIST);
+		/* timer events ... the expired timers dispatch EVENT_TIMEOUT */
+		SWTIMER_process();
 
-			/* if it exist set password is set flag to one and go to the first of the main loop */
-			if(UART_receiveByte() == PASS_EXIST)
+		/* UART events */
+		LINK_poll();
+		if(g_requestActive == TRUE)
+		{
+			switch(LINK_pollTransaction(&g_transaction, &event.frame))
 			{
-
-				passSetFlag = 1;
-				continue;
+			case LINK_DONE:
+				g_requestActive = FALSE;
+				event.type = EVENT_RESPONSE;
+				dispatchEvent(&event);
+				break;
+
+			case LINK_FAILED:
+				/* the Control ECU may have restarted or fallen back to the default baud rate */
+				g_requestActive = FALSE;
+				g_resendRequest = TRUE;
+				g_resumeState = g_state;
+				LCD_clearScreen();
+				LCD_displayStringRowColumn(0, 0, "Connecting...");
+				changeState(STATE_SYNC);
+				break;
+
+			case LINK_PENDING:
+				break;
 			}
+		}
+		while(LINK_receive(&event.frame) == TRUE)
+		{
+			event.type = EVENT_FRAME;
+			dispatchEvent(&event);
+		}
 
-			/* password is not found it means we should setup a new password */
-			do
-			{
-				getPassword(pass1arr);
-				getPasswordConfirmation(pass2arr);
-				/* Password is set successfully */
-				passSetFlag = 1;
+		/* keypad events */
+		event.key = getKeyEvent();
+		if(event.key != KEYPAD_NO_KEY)
+		{
+			PROF_BEGIN(PROF_KEY_TO_ECHO);
 
-				/* repeat till two passwords match */
-			}while(checkPasswordsMatching(pass1arr, pass2arr) == TWO_PASSWORDS_NOT_MATCHED);
+			event.type = EVENT_KEY;
+			dispatchEvent(&event);
 
-			/* you got out of the loop means Password is saved successfully */
+			PROF_END(PROF_KEY_TO_ECHO);
 		}
 
-		/* display Main Menu */
-		LCD_clearScreen();
-		LCD_displayStringRowColumn(0, 0, "+ : Open Door");
-		LCD_displayStringRowColumn(1, 0, "- : Change Pass");
+		DIAG_recordLoop(loopStart);
 
-		/* loop to get only one of the two options '+' or '-' to open the door or change the password */
-		do
-		{
-			keyPressed = KEYPAD_getPressedKey();
-		}while(keyPressed != '+' && keyPressed != '-');
+		/* nothing to do till the next timer or UART interrupt */
+		IDLE_enter();
+	}
+}
 
-		/* open Door Option */
-		if(keyPressed == '+')
-		{
-			/* loop to repeat till the password is right or you lose all three tries */
-			while(1)
-			{
-				getPassword(pass1arr);
-
-				/* checks if the password is right */
-				if(checkPassword(pass1arr) == RIGHT_PASSWORD)
-				{
-					/* if password is right open the door and get out of the loop */
-					openDoor();
-					break;
-				}
-
-				/* password is wrong -- your chances has reduced by one */
-				else
-				{
-					passWrongCounter++;
-
-					LCD_clearScreen();
-					LCD_moveCursor(0, 0);
-					LCD_displayString("Wrong Password!!");
-					_delay_ms(500);
-				}
-				/* checks if you entered the password wrong for three times */
-				if(passWrongCounter == MAX_NUM_OF_WRONG_TRIES)
-				{
-					/* activate the alarm */
-					activateAlarm();
-					break;
-				}
-			}
-			/* reset your wrong pass tries */
-			passWrongCounter = 0;
 
-		}
 
-		/* change Password Option */
-		else
-		{
-			/* loop to repeat till the password is right or you lose all three tries */
-			while(1)
-			{
-				getPassword(pass1arr);
-				/* checks if the password is right */
-				if(checkPassword(pass1arr) == RIGHT_PASSWORD)
-				{
-					LCD_clearScreen();
-					LCD_moveCursor(0, 0);
-					LCD_displayString("Change the pass");
-					delaySeconds(1);
-
-					/* Clear password flag and continues to get to the loop */
-					passSetFlag = 0;
-
-					/* deletes the password in the EEPROM */
-					UART_sendByte(RESET_PASS);
-					while(UART_receiveByte() != RESET_COMPLETE );
-
-					break;
-				}
-
-				/* password is wrong -- your chances has reduced by one */
-				else
-				{
-					passWrongCounter++;
-					LCD_clearScreen();
-					LCD_moveCursor(0, 0);
-					LCD_displayString("Wrong Password!!");
-					_delay_ms(500);
-				}
-				/* checks if you entered the password wrong for three times */
-				if(passWrongCounter == MAX_NUM_OF_WRONG_TRIES)
-				{
-					activateAlarm();
-					break;
-				}
-			}
-			/* reset your wrong pass tries */
-			passWrongCounter = 0;
 
-		}
+
+/*------------------------------------------------------------------
+[Function Name]:  dispatchEvent
+[Description]:  Function to handle one event in the current state, the event runs to completion
+				so it must never wait
+[Args]:
+[in]	const APP_Event * event:
+					pointer to the event
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void dispatchEvent(const APP_Event * event)
+{
+	switch(g_state)
+	{
+	case STATE_SYNC:
+		handleSync(event);
+		break;
+
+	case STATE_CHECK_PASS_EXIST:
+	case STATE_NEW_PASS:
+	case STATE_CONFIRM_PASS:
+	case STATE_SAVE_PASS:
+		handlePasswordSetup(event);
+		break;
+
+	case STATE_MAIN_MENU:
+		handleMainMenu(event);
+		break;
+
+	case STATE_ENTER_PASS:
+	case STATE_CHECK_PASS:
+	case STATE_WRONG_PASS:
+	case STATE_CHANGE_PASS:
+	case STATE_RESET_PASS:
+		handlePasswordCheck(event);
+		break;
+
+	case STATE_DOOR_UNLOCKING:
+	case STATE_DOOR_OPEN:
+	case STATE_DOOR_LOCKING:
+	case STATE_ALARM:
+		handleDoor(event);
+		break;
+
+	case STATE_SERVICE:
+		handleService(event);
+		break;
 	}
+}
 
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  changeState
+[Description]:  Function to leave the current state and enter a new one, the timers and the
+				request of the old state are stopped then the new state gets EVENT_ENTRY
+[Args]:
+[in]	APP_State state:
+					the new state
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void changeState(APP_State state)
+{
+	APP_Event event;
+
+	SWTIMER_cancel(&g_stateTimer);
+	SWTIMER_cancel(&g_digitTimer);
+	g_digitShown = FALSE;
+
+	if(g_requestActive == TRUE)
+	{
+		LINK_abortTransaction(&g_transaction);
+		g_requestActive = FALSE;
+	}
+
+	g_state = state;
+	event.type = EVENT_ENTRY;
+	dispatchEvent(&event);
 }
 
 
@@ -206,17 +303,31 @@ void app(void)
 
 
 /*------------------------------------------------------------------
-[Function Name]:  countSec
-[Description]:  function to increase the number of seconds by one whenever it called
+[Function Name]:  startRequest
+[Description]:  function to send a command to the Control ECU without waiting, its answer comes
+				as EVENT_RESPONSE ... if the Control ECU stops answering the link is synced again
+				and the command is repeated
 [Args]:
-[in]	-NONE
+[in]	uint8 command:
+					the command to be sent
+		const uint8 * payload:
+					pointer to the command data
+		uint8 length:
+					number of data bytes
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void countSec(void)
+void startRequest(uint8 command, const uint8 * payload, uint8 length)
 {
-	g_sec++;
+	/* only one request at a time ... the answer of the old one is dropped */
+	if(g_requestActive == TRUE)
+	{
+		LINK_abortTransaction(&g_transaction);
+	}
+
+	LINK_startTransaction(&g_transaction, command, payload, length);
+	g_requestActive = TRUE;
 }
 
 
@@ -224,40 +335,53 @@ void countSec(void)
 
 
 /*------------------------------------------------------------------
-[Function Name]:  getPassword
-[Description]:  function to get the password and store on an array
+[Function Name]:  startStateTimer
+[Description]:  Function to get EVENT_TIMEOUT in the current state after a certain time
 [Args]:
-[in]	uint8 * pass:
-					Pointer to the password array
+[in]	uint32 timeoutMs:
+					the time in milliseconds
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void getPassword(uint8 * pass)
+void startStateTimer(uint32 timeoutMs)
 {
-	/* variable to store pressed key */
-	uint8 keyPressed;
-	/* counter variable for FOR Loop */
-	uint8 i;
-	LCD_clearScreen();
-	LCD_moveCursor(0, 0);
-	LCD_displayString("plz enter pass:");
-	LCD_moveCursor(1, 0);
-	/* loop to get the password */
-	for(i=0;i<PASSWORD_SIZE;i++)
+	SWTIMER_start(&g_stateTimer, timeoutMs, 0, stateTimeoutCallback);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  getKeyEvent
+[Description]:  function to scan the keypad once and debounce it
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the key if it has just been pressed or KEYPAD_NO_KEY
+------------------------------------------------------------------*/
+uint8 getKeyEvent(void)
+{
+	uint8 key = KEYPAD_scan();
+
+	/* the key has changed ... wait till it is stable */
+	if(key != g_rawKey)
 	{
-		do
-		{
-			keyPressed = KEYPAD_getPressedKey();
-		}while(keyPressed > 9);
-		pass[i] = keyPressed;
-		LCD_intgerToString(keyPressed);
-		_delay_ms(500);
-		LCD_moveCursor(1, i);
-		LCD_displayCharacter('*');
+		g_rawKey = key;
+		g_keyDeadline = SYSTICK_getDeadline(KEY_DEBOUNCE_MS);
+		return KEYPAD_NO_KEY;
+	}
+
+	if((key == g_stableKey) || (SYSTICK_isExpired(g_keyDeadline) == FALSE))
+	{
+		return KEYPAD_NO_KEY;
 	}
-	/* wait for the Enter */
-	while(KEYPAD_getPressedKey() != 13);
+
+	/* KEYPAD_NO_KEY is returned when the key is released */
+	g_stableKey = key;
+	return key;
 }
 
 
@@ -265,41 +389,86 @@ void getPassword(uint8 * pass)
 
 
 /*------------------------------------------------------------------
-[Function Name]:  getPasswordConfirmation
-[Description]:  function to confirm that the password you entered
+[Function Name]:  startPasswordEntry
+[Description]:  function to start getting a password from the keypad
 [Args]:
-[in]	uint8 * pass:
+[in]	uint8 column:
+					the LCD column of the first digit on the second row
+[out]	uint8 * pass:
 					Pointer to the password array
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void startPasswordEntry(uint8 * pass, uint8 column)
+{
+	g_passEntry = pass;
+	g_digitColumn = column;
+	g_digitCount = 0;
+	g_digitShown = FALSE;
+	LCD_moveCursor(1, column);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  enterPasswordKey
+[Description]:  function to add a pressed key to the password being entered,
+				only digits are taken and Enter is taken only after the last digit
+[Args]:
+[in]	uint8 key:
+					the pressed key
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the password is complete and Enter is pressed, FALSE otherwise
+------------------------------------------------------------------*/
+boolean enterPasswordKey(uint8 key)
+{
+	if((key <= 9) && (g_digitCount < PASSWORD_SIZE))
+	{
+		/* the previous digit may be still shown */
+		hideDigit();
+
+		g_passEntry[g_digitCount] = key;
+		LCD_moveCursor(1, g_digitColumn + g_digitCount);
+		LCD_intgerToString(key);
+		g_digitCount++;
+
+		/* show the digit for a while then hide it */
+		g_digitShown = TRUE;
+		SWTIMER_start(&g_digitTimer, DIGIT_SHOW_MS, 0, hideDigit);
+	}
+	else if((key == ENTER_KEY) && (g_digitCount == PASSWORD_SIZE))
+	{
+		hideDigit();
+		return TRUE;
+	}
+	return FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  hideDigit
+[Description]:  function to replace the last shown digit by '*'
+[Args]:
+[in]	-NONE
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void getPasswordConfirmation(uint8 * pass)
+void hideDigit(void)
 {
-	/* variable to store pressed key */
-	uint8 keyPressed;
-	/* counter variable for FOR Loop */
-	uint8 i;
-	LCD_clearScreen();
-	LCD_moveCursor(0, 0);
-	LCD_displayString("plz re-enter the");
-	LCD_moveCursor(1, 0);
-	LCD_displayString("same pass: ");
-	/* loop to get the password Confirmation */
-	for(i=0;i<PASSWORD_SIZE;i++)
+	if(g_digitShown == TRUE)
 	{
-		do
-		{
-			keyPressed = KEYPAD_getPressedKey();
-		}while(keyPressed > 9);
-		pass[i] = keyPressed;
-		LCD_intgerToString(keyPressed);
-		_delay_ms(500);
-		LCD_moveCursor(1, i+11);
+		SWTIMER_cancel(&g_digitTimer);
+		LCD_moveCursor(1, g_digitColumn + g_digitCount - 1);
 		LCD_displayCharacter('*');
+		g_digitShown = FALSE;
 	}
-	/* wait for the Enter */
-	while(KEYPAD_getPressedKey() != 13);
 }
 
 
@@ -307,36 +476,203 @@ void getPasswordConfirmation(uint8 * pass)
 
 
 /*------------------------------------------------------------------
-[Function Name]:  getPasswordConfirmation
-[Description]:  function to check the two password
+[Function Name]:  handleSync
+[Description]:  Function to handle the events of STATE_SYNC, HMI_READY is sent till the Control ECU
+				answers then the baud rate is negotiated
 [Args]:
-[in]	uint8 * pass1:
-					Pointer to the password1 array
-		uint8 * pass2:
-					Pointer to the password2 array
+[in]	const APP_Event * event:
+					pointer to the event
 [out]	-NONE
 [in/out] -NONE
-[Returns]: whether the passwords matched or not
+[Returns]: Nothing
 ------------------------------------------------------------------*/
-uint8 checkPasswordsMatching(uint8 * pass1,uint8 * pass2)
+void handleSync(const APP_Event * event)
+{
+	/* tells the resumed state that the link is back */
+	APP_Event resume;
+
+	switch(event->type)
+	{
+	case EVENT_ENTRY:
+	case EVENT_TIMEOUT:
+		/* send READY frame to the Control ECU till it answers ... it may be still starting,
+		 * while the panel isn't selected on the bus a READY that doesn't fit is dropped instead of waiting */
+		FRAME_send(HMI_READY, LINK_UNTAGGED, NULL_PTR, 0);
+		startStateTimer(HANDSHAKE_TIMEOUT_MS);
+		break;
+
+	case EVENT_FRAME:
+		if(event->frame.type != HMI_READY)
+		{
+			break;
+		}
+		SWTIMER_cancel(&g_stateTimer);
+
+		/* agree with the Control ECU on the fastest baud rate the link can handle,
+		 * it waits but every step of it is bounded by a timeout (baud.h) */
+		BAUD_negotiate();
+
+		if(g_resendRequest == TRUE)
+		{
+			/* go back to the state that lost the link and repeat its command */
+			g_resendRequest = FALSE;
+			g_state = g_resumeState;
+			startRequest(g_transaction.type, g_transaction.payload, g_transaction.length);
+
+			resume.type = EVENT_RESUME;
+			dispatchEvent(&resume);
+		}
+		else
+		{
+			changeState(STATE_CHECK_PASS_EXIST);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  handlePasswordSetup
+[Description]:  Function to handle the events of the states that set up a new password
+[Args]:
+[in]	const APP_Event * event:
+					pointer to the event
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void handlePasswordSetup(const APP_Event * event)
 {
 	/* counter variable for FOR Loop */
 	uint8 i;
 
-	UART_sendByte(SETTING_UP_A_NEW_PASS);
-	/* send password 1 and password 2 through UART to check them */
-	for(i=0;i<PASSWORD_SIZE;i++)
+	/* holds password 1 followed by password 2 */
+	uint8 payload[2 * PASSWORD_SIZE];
+
+	switch(g_state)
+	{
+	case STATE_CHECK_PASS_EXIST:
+		/* Checks if the User has logged in before
+		 * and the system has restarted for any reason
+		 */
+		if(event->type == EVENT_ENTRY)
+		{
+			startRequest(CHECK_IF_PASS_EXIST, NULL_PTR, 0);
+		}
+		else if(event->type == EVENT_RESPONSE)
+		{
+			/* password is not found it means we should setup a new password */
+			changeState((event->frame.type == PASS_EXIST) ? STATE_MAIN_MENU : STATE_NEW_PASS);
+		}
+		break;
+
+	case STATE_NEW_PASS:
+		if(event->type == EVENT_ENTRY)
+		{
+			LCD_clearScreen();
+			LCD_moveCursor(0, 0);
+			LCD_displayString("plz enter pass:");
+			startPasswordEntry(g_pass1, 0);
+		}
+		else if((event->type == EVENT_KEY) && (enterPasswordKey(event->key) == TRUE))
+		{
+			changeState(STATE_CONFIRM_PASS);
+		}
+		break;
+
+	case STATE_CONFIRM_PASS:
+		if(event->type == EVENT_ENTRY)
+		{
+			LCD_clearScreen();
+			LCD_moveCursor(0, 0);
+			LCD_displayString("plz re-enter the");
+			LCD_moveCursor(1, 0);
+			LCD_displayString("same pass: ");
+			startPasswordEntry(g_pass2, 11);
+		}
+		else if((event->type == EVENT_KEY) && (enterPasswordKey(event->key) == TRUE))
+		{
+			changeState(STATE_SAVE_PASS);
+		}
+		break;
+
+	case STATE_SAVE_PASS:
+		if(event->type == EVENT_ENTRY)
+		{
+			for(i=0;i<PASSWORD_SIZE;i++)
+			{
+				payload[i] = g_pass1[i];
+				payload[i + PASSWORD_SIZE] = g_pass2[i];
+			}
+
+			/* send password 1 and password 2 in one frame to check them */
+			PROF_START(PROF_NEW_PASS_TO_SAVED);
+			startRequest(SETTING_UP_A_NEW_PASS, payload, 2 * PASSWORD_SIZE);
+		}
+		else if(event->type == EVENT_RESPONSE)
+		{
+			if(event->frame.type == NEW_PASS_SAVED)
+			{
+				PROF_STOP(PROF_NEW_PASS_TO_SAVED);
+			}
+
+			/* repeat till two passwords match */
+			changeState((event->frame.type == NEW_PASS_SAVED) ? STATE_MAIN_MENU : STATE_NEW_PASS);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  handleMainMenu
+[Description]:  Function to handle the events of STATE_MAIN_MENU
+[Args]:
+[in]	const APP_Event * event:
+					pointer to the event
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void handleMainMenu(const APP_Event * event)
+{
+	if(event->type == EVENT_ENTRY)
 	{
-		UART_sendByte(pass1[i]);
+		/* display Main Menu */
+		LCD_clearScreen();
+		LCD_displayStringRowColumn(0, 0, "+ : Open Door");
+		LCD_displayStringRowColumn(1, 0, "- : Change Pass");
+
+		/* only the first time after power on is timed */
+		PROF_STOP(PROF_POWER_ON_TO_MENU);
 	}
-	for(i=0;i<PASSWORD_SIZE;i++)
+	else if(event->type == EVENT_KEY)
 	{
-		UART_sendByte(pass2[i]);
+		/* only one of the two options '+' or '-' to open the door or change the password */
+		if((event->key == '+') || (event->key == '-'))
+		{
+			g_menuChoice = event->key;
+			changeState(STATE_ENTER_PASS);
+		}
+
+		/* hidden option for the service screen */
+		else if(event->key == SERVICE_SCREEN_KEY)
+		{
+			changeState(STATE_SERVICE);
+		}
 	}
-	if(UART_receiveByte() == NEW_PASS_SAVED)
-		return TWO_PASSWORDS_MATCHED;
-	else
-		return TWO_PASSWORDS_NOT_MATCHED;
 }
 
 
@@ -344,61 +680,196 @@ uint8 checkPasswordsMatching(uint8 * pass1,uint8 * pass2)
 
 
 /*------------------------------------------------------------------
-[Function Name]:  getPasswordConfirmation
-[Description]:  function to check if the password is Right or Wrong
+[Function Name]:  handlePasswordCheck
+[Description]:  Function to handle the events of the states that check the password
+				before opening the door or changing the password
 [Args]:
-[in]	uint8 * pass:
-					Pointer to the password array
+[in]	const APP_Event * event:
+					pointer to the event
 [out]	-NONE
 [in/out] -NONE
-[Returns]: whether the password is Right or Wrong
+[Returns]: Nothing
 ------------------------------------------------------------------*/
-uint8 checkPassword(uint8 * pass)
+void handlePasswordCheck(const APP_Event * event)
 {
-	/* counter variable for FOR Loop */
-	uint8 i;
-
-	UART_sendByte(PASS_CHECK);
-	/* send the password through UART to check it */
-	for(i=0;i<PASSWORD_SIZE;i++)
+	switch(g_state)
 	{
-		UART_sendByte(pass[i]);
+	case STATE_ENTER_PASS:
+		if(event->type == EVENT_ENTRY)
+		{
+			LCD_clearScreen();
+			LCD_moveCursor(0, 0);
+			LCD_displayString("plz enter pass:");
+			startPasswordEntry(g_pass1, 0);
+		}
+		else if((event->type == EVENT_KEY) && (enterPasswordKey(event->key) == TRUE))
+		{
+			changeState(STATE_CHECK_PASS);
+		}
+		break;
+
+	case STATE_CHECK_PASS:
+		if(event->type == EVENT_ENTRY)
+		{
+			/* send the password in one frame to check it */
+			PROF_START(PROF_ENTER_TO_PASS_CORRECT);
+			startRequest(PASS_CHECK, g_pass1, PASSWORD_SIZE);
+		}
+		else if(event->type == EVENT_RESPONSE)
+		{
+			if(event->frame.type == PASS_CORRECT)
+			{
+				PROF_STOP(PROF_ENTER_TO_PASS_CORRECT);
+
+				/* reset your wrong pass tries then open the door or change the password */
+				passWrongCounter = 0;
+				changeState((g_menuChoice == '+') ? STATE_DOOR_UNLOCKING : STATE_CHANGE_PASS);
+			}
+
+			/* password is wrong -- your chances has reduced by one */
+			else
+			{
+				passWrongCounter++;
+				changeState(STATE_WRONG_PASS);
+			}
+		}
+		break;
+
+	case STATE_WRONG_PASS:
+		if(event->type == EVENT_ENTRY)
+		{
+			LCD_clearScreen();
+			LCD_moveCursor(0, 0);
+			LCD_displayString("Wrong Password!!");
+			startStateTimer(WRONG_PASS_SHOW_MS);
+		}
+		else if(event->type == EVENT_TIMEOUT)
+		{
+			/* checks if you entered the password wrong for three times */
+			changeState((passWrongCounter == MAX_NUM_OF_WRONG_TRIES) ? STATE_ALARM : STATE_ENTER_PASS);
+		}
+		break;
+
+	case STATE_CHANGE_PASS:
+		if(event->type == EVENT_ENTRY)
+		{
+			LCD_clearScreen();
+			LCD_moveCursor(0, 0);
+			LCD_displayString("Change the pass");
+			startStateTimer(CHANGE_PASS_SHOW_MS);
+		}
+		else if(event->type == EVENT_TIMEOUT)
+		{
+			changeState(STATE_RESET_PASS);
+		}
+		break;
+
+	case STATE_RESET_PASS:
+		if(event->type == EVENT_ENTRY)
+		{
+			/* deletes the password in the EEPROM */
+			startRequest(RESET_PASS, NULL_PTR, 0);
+		}
+		else if(event->type == EVENT_RESPONSE)
+		{
+			/* after an ERROR the old password is still saved so the check leads back to the main menu */
+			changeState(STATE_CHECK_PASS_EXIST);
+		}
+		break;
+
+	default:
+		break;
 	}
-	if(UART_receiveByte() == PASS_CORRECT)
-		return RIGHT_PASSWORD;
-	else
-		return WRONG_PASSWORD;
 }
 
 
 
 
+
 /*------------------------------------------------------------------
-[Function Name]:  openDoor
-[Description]:  Function to Open the door
+[Function Name]:  handleDoor
+[Description]:  Function to handle the events of the door and alarm states,
+				'-' locks the door before the cycle ends and '+' re-opens it or holds it open
 [Args]:
-[in]	-NONE
+[in]	const APP_Event * event:
+					pointer to the event
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void openDoor(void)
+void handleDoor(const APP_Event * event)
 {
+	/* time the current door phase has run ... it follows the door phases of the Control ECU */
+	uint32 elapsed = SYSTICK_getTicks() - g_doorPhaseStart;
 
+	switch(event->type)
+	{
+	case EVENT_ENTRY:
+		g_doorPhaseStart = SYSTICK_getTicks();
+		if(g_state == STATE_DOOR_UNLOCKING)
+		{
+			startRequest(OPEN_DOOR, NULL_PTR, 0);
+		}
+		else if(g_state == STATE_ALARM)
+		{
+			startRequest(ACTIVATE_THE_ALERT, NULL_PTR, 0);
+			passWrongCounter = 0;
+		}
+		showDoorPhase(0);
+		break;
 
-	UART_sendByte(OPEN_DOOR);
-	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "Door is");
-	LCD_displayStringRowColumn(1, 0, "Unlocking");
-	delaySeconds(15);
+	case EVENT_RESUME:
+		/* the link is back ... the screen and the rest of the phase are shown again */
+		showDoorPhase(elapsed);
+		break;
 
-	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "Door is Open");
-	delaySeconds(3);
+	case EVENT_TIMEOUT:
+		switch(g_state)
+		{
+		case STATE_DOOR_UNLOCKING:
+			g_doorPosition = DOOR_MOVE_MS;
+			changeState(STATE_DOOR_OPEN);
+			break;
+
+		case STATE_DOOR_OPEN:
+			changeState(STATE_DOOR_LOCKING);
+			break;
+
+		default:
+			g_doorPosition = 0;
+			changeState(STATE_MAIN_MENU);
+			break;
+		}
+		break;
 
-	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "Door is Locking");
-	delaySeconds(15);
+	case EVENT_KEY:
+		if((event->key == '-') && ((g_state == STATE_DOOR_UNLOCKING) || (g_state == STATE_DOOR_OPEN)))
+		{
+			/* lock the door from where it is ... the command is sent after the state change that stops the old request */
+			if(g_state == STATE_DOOR_UNLOCKING)
+			{
+				g_doorPosition = ((g_doorPosition + elapsed) > DOOR_MOVE_MS) ? DOOR_MOVE_MS : (g_doorPosition + elapsed);
+			}
+			changeState(STATE_DOOR_LOCKING);
+			startRequest(ABORT_DOOR, NULL_PTR, 0);
+		}
+		else if((event->key == '+') && (g_state == STATE_DOOR_OPEN))
+		{
+			/* hold the door for another DOOR_HOLD_MS */
+			changeState(STATE_DOOR_OPEN);
+			startRequest(OPEN_DOOR, NULL_PTR, 0);
+		}
+		else if((event->key == '+') && (g_state == STATE_DOOR_LOCKING))
+		{
+			/* unlock the door from where it is ... STATE_DOOR_UNLOCKING sends OPEN_DOOR */
+			g_doorPosition = (elapsed >= g_doorPosition) ? 0 : (g_doorPosition - elapsed);
+			changeState(STATE_DOOR_UNLOCKING);
+		}
+		break;
+
+	default:
+		break;
+	}
 }
 
 
@@ -406,23 +877,131 @@ void openDoor(void)
 
 
 /*------------------------------------------------------------------
-[Function Name]:  activateAlarm
-[Description]:  Function to Activate the alarm
+[Function Name]:  showDoorPhase
+[Description]:  Function to show the screen of the current door or alarm state and
+				to start the timer of the rest of its phase
 [Args]:
-[in]	-NONE
+[in]	uint32 elapsed:
+					the time the phase has already run in milliseconds
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void activateAlarm(void)
+void showDoorPhase(uint32 elapsed)
 {
-	UART_sendByte(ACTIVATE_THE_ALERT);
-	passWrongCounter = 0;
+	/* time the whole phase takes */
+	uint32 phaseMs;
+
 	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "!!!! ERROR !!!!");
+	switch(g_state)
+	{
+	case STATE_DOOR_UNLOCKING:
+		LCD_displayStringRowColumn(0, 0, "Door is");
+		LCD_displayStringRowColumn(1, 0, "Unlocking -:Stop");
+		phaseMs = DOOR_MOVE_MS - g_doorPosition;
+		break;
+
+	case STATE_DOOR_OPEN:
+		LCD_displayStringRowColumn(0, 0, "Door is Open");
+		LCD_displayStringRowColumn(1, 0, "+:Hold -:Lock");
+		phaseMs = DOOR_HOLD_MS;
+		break;
+
+	case STATE_DOOR_LOCKING:
+		LCD_displayStringRowColumn(0, 0, "Door is Locking");
+		LCD_displayStringRowColumn(1, 0, "+:Re-open");
+		phaseMs = g_doorPosition;
+		break;
+
+	default:
+		/* keep alert on for a minute */
+		LCD_displayStringRowColumn(0, 0, "!!!! ERROR !!!!");
+		phaseMs = ALARM_SHOW_MS;
+		break;
+	}
+
+	startStateTimer((elapsed >= phaseMs) ? 0 : (phaseMs - elapsed));
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  handleService
+[Description]:  Function to show the link counters of both ECUs on the service screen,
+				'+' shows the next counters, '-' the previous page, '=' switches between
+				the Control ECU (C) and the HMI ECU (H) and Enter exits
+[Args]:
+[in]	const APP_Event * event:
+					pointer to the event
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void handleService(const APP_Event * event)
+{
+	/* holds the page of this ECU */
+	uint8 payload[FRAME_MAX_PAYLOAD_SIZE];
+
+	switch(event->type)
+	{
+	case EVENT_ENTRY:
+		g_diagPage = 0;
+		g_diagField = 0;
+		g_diagCount = 0;
+		g_diagRemote = TRUE;
+		break;
+
+	case EVENT_RESPONSE:
+		/* the page of the Control ECU has arrived */
+		showDiagnostics(event->frame.payload, (event->frame.type == DIAGNOSTICS) ? event->frame.length : 0);
+		return;
+
+	case EVENT_KEY:
+		switch(event->key)
+		{
+		case '+':
+			/* next two fields or the first fields of the next page */
+			g_diagField += 2;
+			if(g_diagField >= g_diagCount)
+			{
+				g_diagField = 0;
+				g_diagPage = (g_diagPage + 1) % DIAG_NUM_OF_PAGES;
+			}
+			break;
 
-	/* keep alert on for a minute */
-	delaySeconds(60);
+		case '-':
+			g_diagField = 0;
+			g_diagPage = (g_diagPage + DIAG_NUM_OF_PAGES - 1) % DIAG_NUM_OF_PAGES;
+			break;
+
+		case '=':
+			g_diagRemote = (g_diagRemote == TRUE) ? FALSE : TRUE;
+			break;
+
+		case ENTER_KEY:
+			changeState(STATE_MAIN_MENU);
+			return;
+
+		default:
+			return;
+		}
+		break;
+
+	default:
+		return;
+	}
+
+	/* read the page again every time so the counters are fresh */
+	if(g_diagRemote == TRUE)
+	{
+		startRequest(DIAGNOSTICS, &g_diagPage, 1);
+	}
+	else
+	{
+		showDiagnostics(payload, DIAG_fillPage(g_diagPage, payload));
+	}
 }
 
 
@@ -430,27 +1009,60 @@ void activateAlarm(void)
 
 
 /*------------------------------------------------------------------
-[Function Name]:  delaySeconds
-[Description]:  Function to wait a certain amount of seconds
+[Function Name]:  showDiagnostics
+[Description]:  Function to show two fields of the diagnostics page on the service screen
 [Args]:
-[in]	uint8 sec:
-					number of seconds you want to wait
+[in]	const uint8 * payload:
+					pointer to the page bytes
+		uint8 length:
+					number of page bytes
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void delaySeconds(uint8 sec)
+void showDiagnostics(const uint8 * payload, uint8 length)
 {
-	/* setting the callBack function to count seconds */
-	Timer1_setCallBack(countSec);
-	/* timer1 configurations to count sec per interrupt */
-	Timer1_ConfigType timer1Config = {0,31250,CLK_256,COMPARE_MODE};
+	uint8 row;
 
-	Timer1_init(&timer1Config);
-	while(g_sec < sec);
-	g_sec = 0;
-	Timer1_deInit();
+	g_diagCount = length / DIAG_getFieldSize(g_diagPage);
 
+	/* two fields per screen ... one per row */
+	LCD_clearScreen();
+	for(row=0;(row<2) && ((g_diagField + row) < g_diagCount);row++)
+	{
+		LCD_moveCursor(row, 0);
+		LCD_displayCharacter((g_diagRemote == TRUE) ? 'C' : 'H');
+		LCD_displayCharacter(' ');
+		LCD_displayString(g_diagNames[g_diagPage][g_diagField + row]);
+		LCD_displayCharacter(' ');
+		LCD_unsignedToString(DIAG_getField(g_diagPage, payload, g_diagField + row));
+
+		/* the longest time of a profiled region is marked if it is over its budget */
+		if((g_diagPage >= DIAG_PAGE_PROF) && ((g_diagField + row) == DIAG_PROF_MAX_FIELD) &&
+				(DIAG_getField(g_diagPage, payload, DIAG_PROF_MAX_FIELD) > PROF_getBudget(g_diagPage - DIAG_PAGE_PROF)))
+		{
+			LCD_displayCharacter('!');
+		}
+	}
 }
 
 
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  stateTimeoutCallback
+[Description]:  Function called by the software timer of the state when it expires
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void stateTimeoutCallback(void)
+{
+	APP_Event event;
+
+	event.type = EVENT_TIMEOUT;
+	dispatchEvent(&event);
+}
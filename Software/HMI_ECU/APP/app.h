@@ -14,6 +14,7 @@
 #define APP_H_
 
 #include "std_types.h"
+#include "frame.h"
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -27,7 +28,49 @@
 #define TWO_PASSWORDS_NOT_MATCHED   0
 #define PASS_EXIST					0xCC
 
-/* UART Commands */
+/* time to wait for the Control ECU to answer the HMI_READY frame before sending it again */
+#define HANDSHAKE_TIMEOUT_MS		100
+
+/* a key must be stable for this time before it is taken as pressed or released */
+#define KEY_DEBOUNCE_MS				20
+
+/*
+ * The keypad is on PORTB and its lines can't reach an external interrupt (INT2 is one of its rows)
+ * so it is scanned every this time, the CPU sleeps in between
+ */
+#define KEY_SCAN_PERIOD_MS			10
+
+/* time every entered digit is shown before it is hidden by '*' */
+#define DIGIT_SHOW_MS				500
+
+/* time every message is shown */
+#define WRONG_PASS_SHOW_MS			500
+#define CHANGE_PASS_SHOW_MS			1000
+#define DOOR_MOVE_MS				15000
+#define DOOR_HOLD_MS				3000
+#define ALARM_SHOW_MS				60000
+
+#define ENTER_KEY					13
+
+/* hidden key in the main menu that opens the diagnostics service screen */
+#define SERVICE_SCREEN_KEY			'%'
+
+/*
+ * address of this panel on the multi-drop bus of a Control ECU that serves more panels ... unique per
+ * panel (1 -> 255), UART_MASTER_ADDRESS (the default) is the point to point link of a single panel
+ */
+#ifndef PANEL_ADDRESS
+#define PANEL_ADDRESS				UART_MASTER_ADDRESS
+#endif
+
+#if(PANEL_ADDRESS == UART_MASTER_ADDRESS)
+#define PANEL_DATABITS				EIGHT_DATABITS
+#else
+#define PANEL_DATABITS				NINE_DATABITS
+#endif
+
+/* UART Commands ... carried in the TYPE field of a frame */
+#define DIAGNOSTICS					0xF0
 #define HMI_READY					0xFF
 #define SETTING_UP_A_NEW_PASS		0xF1
 #define NEW_PASS_SAVED				0xF2
@@ -38,6 +81,57 @@
 #define CHECK_IF_PASS_EXIST			0xF7
 #define RESET_PASS					0xF8
 #define RESET_COMPLETE				0xF9
+#define ABORT_DOOR					0xFE
+/* 0xFA -> 0xFD are used by the baud rate negotiation (baud.h) */
+/* DIAGNOSTICS carries a 1-byte page number (diag.h) and is answered with the page itself */
+/* OPEN_DOOR during the locking re-opens the door, ABORT_DOOR locks it before the cycle ends */
+/* OPEN_DOOR, ABORT_DOOR and ACTIVATE_THE_ALERT are answered with their own type once they are taken */
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[ENUM Name]: APP_State
+[ENUM Description]: it's used to define the screen the application is in
+------------------------------------------------------------------*/
+typedef enum
+{
+	STATE_SYNC,STATE_CHECK_PASS_EXIST,STATE_NEW_PASS,STATE_CONFIRM_PASS,STATE_SAVE_PASS,
+	STATE_MAIN_MENU,STATE_ENTER_PASS,STATE_CHECK_PASS,STATE_WRONG_PASS,STATE_CHANGE_PASS,
+	STATE_RESET_PASS,STATE_DOOR_UNLOCKING,STATE_DOOR_OPEN,STATE_DOOR_LOCKING,STATE_ALARM,
+	STATE_SERVICE
+}APP_State;
+
+
+/*------------------------------------------------------------------
+[ENUM Name]: APP_EventType
+[ENUM Description]: it's used to define the events that move the application between its states
+					EVENT_ENTRY    : the state has just been entered
+					EVENT_KEY      : a key is pressed
+					EVENT_TIMEOUT  : the timer of the state has expired
+					EVENT_RESPONSE : the response of the request sent by the state has arrived
+					EVENT_FRAME    : a frame that isn't a response has arrived
+					EVENT_RESUME   : the link is synced again and the request of the state is repeated
+------------------------------------------------------------------*/
+typedef enum
+{
+	EVENT_ENTRY,EVENT_KEY,EVENT_TIMEOUT,EVENT_RESPONSE,EVENT_FRAME,EVENT_RESUME
+}APP_EventType;
+
+
+/*------------------------------------------------------------------
+[Structure Name]: APP_Event
+[Structure Description]: it holds one event, key is valid for EVENT_KEY and
+						frame for EVENT_RESPONSE and EVENT_FRAME
+------------------------------------------------------------------*/
+typedef struct
+{
+	APP_EventType type;
+	uint8 key;
+	FRAME_Message frame;
+}APP_Event;
+
 
 /*******************************************************************************
  *                              Functions Prototypes                           *
@@ -58,120 +152,257 @@ void app(void);
 
 
 /*------------------------------------------------------------------
-[Function Name]:  countSec
-[Description]:  function to increase the number of seconds by one whenever it called
+[Function Name]:  dispatchEvent
+[Description]:  Function to handle one event in the current state, the event runs to completion
+				so it must never wait
 [Args]:
-[in]	-NONE
+[in]	const APP_Event * event:
+					pointer to the event
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void countSec(void);
+void dispatchEvent(const APP_Event * event);
 
 
 
 
 /*------------------------------------------------------------------
-[Function Name]:  getPassword
-[Description]:  function to get the password and store on an array
+[Function Name]:  changeState
+[Description]:  Function to leave the current state and enter a new one, the timers and the
+				request of the old state are stopped then the new state gets EVENT_ENTRY
 [Args]:
-[in]	uint8 * pass:
-					Pointer to the password array
+[in]	APP_State state:
+					the new state
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void getPassword(uint8 * pass);
+void changeState(APP_State state);
 
 
 
 
 /*------------------------------------------------------------------
-[Function Name]:  getPasswordConfirmation
-[Description]:  function to confirm that the password you entered
+[Function Name]:  startRequest
+[Description]:  function to send a command to the Control ECU without waiting, its answer comes
+				as EVENT_RESPONSE ... if the Control ECU stops answering the link is synced again
+				and the command is repeated
 [Args]:
-[in]	uint8 * pass:
-					Pointer to the password array
+[in]	uint8 command:
+					the command to be sent
+		const uint8 * payload:
+					pointer to the command data
+		uint8 length:
+					number of data bytes
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void startRequest(uint8 command, const uint8 * payload, uint8 length);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  startStateTimer
+[Description]:  Function to get EVENT_TIMEOUT in the current state after a certain time
+[Args]:
+[in]	uint32 timeoutMs:
+					the time in milliseconds
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void getPasswordConfirmation(uint8 * pass);
+void startStateTimer(uint32 timeoutMs);
 
 
 
 
 /*------------------------------------------------------------------
-[Function Name]:  checkPasswordsMatching
-[Description]:  function to check the two passwords Matched
+[Function Name]:  getKeyEvent
+[Description]:  function to scan the keypad once and debounce it
 [Args]:
-[in]	uint8 * pass1:
-					Pointer to the password1 array
-		uint8 * pass2:
-					Pointer to the password2 array
+[in]	-NONE
 [out]	-NONE
 [in/out] -NONE
-[Returns]: whether the passwords matched or not
+[Returns]: the key if it has just been pressed or KEYPAD_NO_KEY
 ------------------------------------------------------------------*/
-uint8 checkPasswordsMatching(uint8 * pass1,uint8 * pass2);
+uint8 getKeyEvent(void);
 
 
 
 
 /*------------------------------------------------------------------
-[Function Name]:  checkPassword
-[Description]:  function to check if the password is Right or Wrong
+[Function Name]:  startPasswordEntry
+[Description]:  function to start getting a password from the keypad
 [Args]:
-[in]	uint8 * pass:
+[in]	uint8 column:
+					the LCD column of the first digit on the second row
+[out]	uint8 * pass:
 					Pointer to the password array
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void startPasswordEntry(uint8 * pass, uint8 column);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  enterPasswordKey
+[Description]:  function to add a pressed key to the password being entered,
+				only digits are taken and Enter is taken only after the last digit
+[Args]:
+[in]	uint8 key:
+					the pressed key
 [out]	-NONE
 [in/out] -NONE
-[Returns]: whether the password is Right or Wrong
+[Returns]: TRUE if the password is complete and Enter is pressed, FALSE otherwise
 ------------------------------------------------------------------*/
-uint8 checkPassword(uint8 * pass);
+boolean enterPasswordKey(uint8 key);
 
 
 
 
 /*------------------------------------------------------------------
-[Function Name]:  openDoor
-[Description]:  Function to Open the door
+[Function Name]:  hideDigit
+[Description]:  function to replace the last shown digit by '*'
 [Args]:
 [in]	-NONE
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void openDoor(void);
+void hideDigit(void);
 
 
 
 
 /*------------------------------------------------------------------
-[Function Name]:  activateAlarm
-[Description]:  Function to Activate the alarm
+[Function Name]:  handleSync
+[Description]:  Function to handle the events of STATE_SYNC, HMI_READY is sent till the Control ECU
+				answers then the baud rate is negotiated
 [Args]:
-[in]	-NONE
+[in]	const APP_Event * event:
+					pointer to the event
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void handleSync(const APP_Event * event);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  handlePasswordSetup
+[Description]:  Function to handle the events of the states that set up a new password
+[Args]:
+[in]	const APP_Event * event:
+					pointer to the event
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void handlePasswordSetup(const APP_Event * event);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  handleMainMenu
+[Description]:  Function to handle the events of STATE_MAIN_MENU
+[Args]:
+[in]	const APP_Event * event:
+					pointer to the event
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void handleMainMenu(const APP_Event * event);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  handlePasswordCheck
+[Description]:  Function to handle the events of the states that check the password
+				before opening the door or changing the password
+[Args]:
+[in]	const APP_Event * event:
+					pointer to the event
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void handlePasswordCheck(const APP_Event * event);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  handleDoor
+[Description]:  Function to handle the events of the door and alarm states,
+				'-' locks the door before the cycle ends and '+' re-opens it or holds it open
+[Args]:
+[in]	const APP_Event * event:
+					pointer to the event
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void handleDoor(const APP_Event * event);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  showDoorPhase
+[Description]:  Function to show the screen of the current door or alarm state and
+				to start the timer of the rest of its phase
+[Args]:
+[in]	uint32 elapsed:
+					the time the phase has already run in milliseconds
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void showDoorPhase(uint32 elapsed);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  handleService
+[Description]:  Function to show the link counters of both ECUs on the service screen,
+				'+' shows the next counters, '-' the previous page, '=' switches between
+				the Control ECU (C) and the HMI ECU (H) and Enter exits
+[Args]:
+[in]	const APP_Event * event:
+					pointer to the event
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void activateAlarm(void);
+void handleService(const APP_Event * event);
 
 
 
 
 /*------------------------------------------------------------------
-[Function Name]:  delaySeconds
-[Description]:  Function to wait a certain amount of seconds
+[Function Name]:  showDiagnostics
+[Description]:  Function to show two fields of the diagnostics page on the service screen
 [Args]:
-[in]	uint8 sec:
-					number of seconds you want to wait
+[in]	const uint8 * payload:
+					pointer to the page bytes
+		uint8 length:
+					number of page bytes
 [out]	-NONE
 [in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void delaySeconds(uint8 sec);
+void showDiagnostics(const uint8 * payload, uint8 length);
 
 
 
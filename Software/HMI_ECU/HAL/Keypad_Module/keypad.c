@@ -38,8 +38,22 @@ static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number);
  *******************************************************************************/
 
 uint8 KEYPAD_getPressedKey(void)
+{
+	uint8 key;
+
+	/* keep scanning till a button is pressed */
+	do
+	{
+		key = KEYPAD_scan();
+	}while(key == KEYPAD_NO_KEY);
+
+	return key;
+}
+
+uint8 KEYPAD_scan(void)
 {
 	uint8 row,col;
+	uint8 key = KEYPAD_NO_KEY;
 	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+0, PIN_INPUT);
 	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+1, PIN_INPUT);
 	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+2, PIN_INPUT);
@@ -53,29 +67,30 @@ uint8 KEYPAD_getPressedKey(void)
 	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+3, PIN_INPUT);
 #endif
 
-	while(1)
+	for(row=0;(row<KEYPAD_NUM_ROWS) && (key == KEYPAD_NO_KEY);row++)
 	{
-		for(row=0;row<KEYPAD_NUM_ROWS;row++)
+		GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+row, PIN_OUTPUT);
+		GPIO_writePin(PORTB_ID, KEYPAD_FIRST_ROW_PIN_ID+row, KEYPAD_BUTTON_PRESSED);
+		for(col=0;col<KEYPAD_NUM_COLS;col++)
 		{
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+row, PIN_OUTPUT);
-			GPIO_writePin(PORTB_ID, KEYPAD_FIRST_ROW_PIN_ID+row, KEYPAD_BUTTON_PRESSED);
-			for(col=0;col<KEYPAD_NUM_COLS;col++)
+			if(GPIO_readPin(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+col) == KEYPAD_BUTTON_PRESSED)
 			{
-				if(GPIO_readPin(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+col) == KEYPAD_BUTTON_PRESSED)
-						#ifndef STANDARD_KEYPAD
-							#if KEYPAD_NUM_COLS == 3
-								return KEYPAD_4x3_adjustKeyNumber(row*KEYPAD_NUM_COLS + col +1);
-							#elif KEYPAD_NUM_COLS == 4
-								return KEYPAD_4x4_adjustKeyNumber(row*KEYPAD_NUM_COLS + col +1);
-							#endif
-
-						#else
-								return (row*KEYPAD_NUM_COLS + col +1);
+					#ifndef STANDARD_KEYPAD
+						#if KEYPAD_NUM_COLS == 3
+							key = KEYPAD_4x3_adjustKeyNumber(row*KEYPAD_NUM_COLS + col +1);
+						#elif KEYPAD_NUM_COLS == 4
+							key = KEYPAD_4x4_adjustKeyNumber(row*KEYPAD_NUM_COLS + col +1);
 						#endif
+
+					#else
+							key = (row*KEYPAD_NUM_COLS + col +1);
+					#endif
+				break;
 			}
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+row, PIN_INPUT);
 		}
+		GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+row, PIN_INPUT);
 	}
+	return key;
 }
 #ifndef STANDARD_KEYPAD
 
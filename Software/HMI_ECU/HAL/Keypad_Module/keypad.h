@@ -37,6 +37,9 @@
 #define KEYPAD_BUTTON_PRESSED            LOGIC_LOW
 #define KEYPAD_BUTTON_RELEASED           LOGIC_HIGH
 
+/* Returned by KEYPAD_scan when no button is pressed */
+#define KEYPAD_NO_KEY                    0xFF
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -47,4 +50,10 @@
  */
 uint8 KEYPAD_getPressedKey(void);
 
+/*
+ * Description :
+ * Scan the Keypad once without waiting and return the pressed button or KEYPAD_NO_KEY
+ */
+uint8 KEYPAD_scan(void);
+
 #endif /* KEYPAD_H_ */
@@ -12,6 +12,7 @@
 #include "lcd.h"
 #include "gpio.h"
 #include "common_macros.h"
+#include "prof.h"
 #include <stdlib.h>
 #include <util/delay.h>
 
@@ -76,6 +77,8 @@ void LCD_init(void)
 ------------------------------------------------------------------*/
 void LCD_sendCommand(uint8 command)
 {
+	PROF_BEGIN(PROF_LCD_COMMAND);
+
 	GPIO_writePin(LCD_RS_PORT_ID, LCD_RS_PIN_ID, LOGIC_LOW);
 	_delay_ms(1);/*Tas = 50ns*/
 	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_HIGH);
@@ -105,6 +108,8 @@ void LCD_sendCommand(uint8 command)
 	_delay_ms(1);/*Tdsw = 100ns*/
 	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_LOW);
 	_delay_ms(1);/*Th = 13ns*/
+
+	PROF_END(PROF_LCD_COMMAND);
 }
 
 
@@ -250,6 +255,25 @@ void LCD_intgerToString(int data)
 }
 
 
+/*------------------------------------------------------------------
+[Function Name]:  LCD_unsignedToString
+[Description]: Display the required unsigned 32-bit decimal value on the screen
+[Args]:
+[in]	 uint32 data:
+					Takes the required data to display it on the screen
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: Nothing
+
+------------------------------------------------------------------*/
+void LCD_unsignedToString(uint32 data)
+{
+	char buffer[16];
+	ultoa(data,buffer,10);
+	LCD_displayString(buffer);
+}
+
+
 /*------------------------------------------------------------------
 [Function Name]:  LCD_clearScreen
 [Description]: Send the clear screen command
@@ -193,6 +193,23 @@ void LCD_intgerToString(int data);
 
 
 
+/*------------------------------------------------------------------
+[Function Name]:  LCD_unsignedToString
+[Description]: Display the required unsigned 32-bit decimal value on the screen
+[Args]:
+[in]	 uint32 data:
+					Takes the required data to display it on the screen
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: Nothing
+
+------------------------------------------------------------------*/
+void LCD_unsignedToString(uint32 data);
+
+
+
+
+
 /*------------------------------------------------------------------
 [Function Name]:  LCD_clearScreen
 [Description]: Send the clear screen command
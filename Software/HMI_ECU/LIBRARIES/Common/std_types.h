@@ -13,6 +13,8 @@
 #ifndef STD_TYPES_H_
 #define STD_TYPES_H_
 
+#include <stdint.h>
+
 /*Boolean Data Type*/
 typedef unsigned char boolean;
 
@@ -32,14 +34,15 @@ typedef unsigned char boolean;
 #define NULL_PTR 			((void*)0)
 
 
-typedef unsigned char 			uint8;
-typedef signed char 			sint8;
-typedef unsigned short 			uint16;
-typedef signed short 			sint16;
-typedef unsigned long 			uint32;
-typedef signed long 			sint32;
-typedef unsigned long long 		uint64;
-typedef signed long long 		sint64;
+/* fixed width types so the sizes are the same on the AVR and on the host build */
+typedef uint8_t 				uint8;
+typedef int8_t 					sint8;
+typedef uint16_t 				uint16;
+typedef int16_t 				sint16;
+typedef uint32_t 				uint32;
+typedef int32_t 				sint32;
+typedef uint64_t 				uint64;
+typedef int64_t 				sint64;
 typedef float 					float32;
 typedef double     				float64;
 
@@ -0,0 +1,358 @@
+ /******************************************************************************
+ *
+ * Module: SysTick
+ *
+ * File Name: systick.c
+ *
+ * Description: Source file for the millisecond system tick built on Timer1
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "systick.h"
+#include "timer.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* milliseconds counter ... incremented by the Timer1 compare interrupt */
+static volatile uint32 g_ticks = 0;
+
+/* ticks the next compare interrupt ends ... more than one while SYSTICK_sleepUntil stretches the period */
+static volatile uint16 g_pendingTicks = 1;
+
+/* Timer1 count at which the last tick ended */
+static volatile uint16 g_lastCompare = 0;
+
+/* sleep residency counters */
+static SYSTICK_SleepStatistics g_sleepStats;
+
+/* slept counts that haven't made a whole tick yet */
+static uint16 g_sleepRemainder = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static inline void SYSTICK_tick(void);
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+#if(TIMER1_STATIC_COMPARE_A == TRUE)
+/* the tick is bound at compile time ... SYSTICK_tick is inlined here with no call through a pointer */
+ISR(TIMER1_COMPA_vect)
+{
+	SYSTICK_tick();
+}
+#endif
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_init
+[Description]: start Timer1 to count one tick every millisecond,
+				Timer1 must not be re-initialized by anyone else after that
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SYSTICK_init(void)
+{
+	/* timer1 configurations to run freely with the first compare after one millisecond */
+	Timer1_ConfigType timer1Config = {0,SYSTICK_COUNTS_PER_TICK,CLK_8,NORMAL_MODE};
+
+	g_ticks = 0;
+	g_pendingTicks = 1;
+	g_lastCompare = 0;
+	g_sleepStats.sleepTicks = 0;
+	g_sleepStats.sleeps = 0;
+	g_sleepStats.timerWakeups = 0;
+	g_sleepRemainder = 0;
+#if(TIMER1_STATIC_COMPARE_A == FALSE)
+	Timer1_setCallBack(TIMER1_COMPARE_A,SYSTICK_tick);
+#endif
+	Timer1_init(&timer1Config);
+	Timer1_enableEvent(TIMER1_COMPARE_A);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_getTicks
+[Description]: get the number of milliseconds since SYSTICK_init (wraps after ~49 days)
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the tick counter
+------------------------------------------------------------------*/
+uint32 SYSTICK_getTicks(void)
+{
+	uint32 ticks;
+	uint8 sreg = SREG;
+
+	/* the counter is 32-bit so it must be read with the interrupts disabled */
+	cli();
+	ticks = g_ticks;
+	SREG = sreg;
+
+	return ticks;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_getCounts
+[Description]: get the number of Timer1 counts since SYSTICK_init (SYSTICK_COUNTS_TO_US converts them),
+				used to measure short intervals finer than a tick
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the Timer1 counts (wraps after ~71 minutes at 8 MHz)
+------------------------------------------------------------------*/
+uint32 SYSTICK_getCounts(void)
+{
+	uint32 ticks;
+	uint16 count;
+	uint8 sreg = SREG;
+
+	/*
+	 * counts since the last tick ... still right if the compare interrupt is pending
+	 * as the counter doesn't restart at the compare value
+	 */
+	cli();
+	ticks = g_ticks;
+	count = Timer1_getCount() - g_lastCompare;
+	SREG = sreg;
+
+	return (ticks * SYSTICK_COUNTS_PER_TICK) + count;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_getMicros
+[Description]: get a free running microseconds time stamp, intervals are measured by
+				subtracting two time stamps so the wrap around doesn't matter
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the microseconds since SYSTICK_init (wraps after ~71 minutes)
+------------------------------------------------------------------*/
+uint32 SYSTICK_getMicros(void)
+{
+	uint32 ticks;
+	uint16 count;
+	uint8 sreg = SREG;
+
+	cli();
+	ticks = g_ticks;
+	count = Timer1_getCount() - g_lastCompare;
+	SREG = sreg;
+
+	/*
+	 * the counts since SYSTICK_init times SYSTICK_PRESCALER over the MHz ... a tick is 1000 us
+	 * whatever F_CPU is so only the counts since the last tick are converted, the stamp wraps
+	 * at 2^32 us and stays exact where the 32-bit counts would wrap first (0.5 us a count at 16 MHz)
+	 */
+	return (ticks * 1000UL) + SYSTICK_COUNTS_TO_US(count);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_sleepUntil
+[Description]: put the CPU in the idle sleep mode without waking up every tick,
+				the tick period is stretched till the wake tick (SYSTICK_MAX_SLEEP_TICKS at most)
+				and any other interrupt wakes the CPU up earlier ... the tick counter is
+				corrected before returning either way
+[Args]:
+[in]	uint32 wakeTick:
+					the tick at which the CPU must be awake
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SYSTICK_sleepUntil(uint32 wakeTick)
+{
+	uint32 start;
+	uint32 ticks;
+	uint32 elapsedCounts;
+	uint16 compare;
+	uint16 elapsed;
+
+	start = SYSTICK_getCounts();
+
+	cli();
+	ticks = wakeTick - g_ticks;
+	if(((sint32)ticks > 1) && (g_pendingTicks == 1) && BIT_IS_CLEAR(TIFR,OCF1A))
+	{
+		if(ticks > SYSTICK_MAX_SLEEP_TICKS)
+		{
+			ticks = SYSTICK_MAX_SLEEP_TICKS;
+		}
+
+		/* the current tick is made longer so its compare interrupt comes at the wake tick */
+		g_pendingTicks = (uint16)ticks;
+		Timer1_setCompare(TIMER1_COMPARE_A, g_lastCompare + ((uint16)ticks * SYSTICK_COUNTS_PER_TICK));
+
+		/* the tick has ended while the compare value was changed ... let it end normally */
+		if(BIT_IS_SET(TIFR,OCF1A))
+		{
+			g_pendingTicks = 1;
+			Timer1_setCompare(TIMER1_COMPARE_A, g_lastCompare + SYSTICK_COUNTS_PER_TICK);
+		}
+	}
+
+	/* the instruction after sei is always executed so no interrupt is lost before sleeping */
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	sleep_enable();
+	sei();
+	sleep_cpu();
+	sleep_disable();
+
+	cli();
+	if((g_pendingTicks != 1) && BIT_IS_CLEAR(TIFR,OCF1A))
+	{
+		/* another interrupt came first ... count the whole ticks passed and end the current one normally */
+		elapsed = (uint16)(Timer1_getCount() - g_lastCompare) / SYSTICK_COUNTS_PER_TICK;
+		g_ticks += elapsed;
+		g_lastCompare += elapsed * SYSTICK_COUNTS_PER_TICK;
+		g_pendingTicks = 1;
+		compare = g_lastCompare + SYSTICK_COUNTS_PER_TICK;
+
+		/* too close to the compare value (or already past it) ... it may be passed before OCR1A is written */
+		if((sint16)(compare - Timer1_getCount()) < SYSTICK_MIN_COMPARE_COUNTS)
+		{
+			compare += SYSTICK_COUNTS_PER_TICK;
+			g_pendingTicks = 2;
+		}
+		Timer1_setCompare(TIMER1_COMPARE_A, compare);
+
+		/* the stretched compare value may have been reached meanwhile ... its flag is stale now */
+		TIFR = (1<<OCF1A);
+	}
+
+	g_sleepStats.sleeps++;
+	if((sint32)(g_ticks - wakeTick) >= 0)
+	{
+		g_sleepStats.timerWakeups++;
+	}
+	sei();
+
+	/* the slept time is kept in ticks so it doesn't wrap with the counts */
+	elapsedCounts = (SYSTICK_getCounts() - start) + g_sleepRemainder;
+	g_sleepStats.sleepTicks += elapsedCounts / SYSTICK_COUNTS_PER_TICK;
+	g_sleepRemainder = (uint16)(elapsedCounts % SYSTICK_COUNTS_PER_TICK);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_getSleepStatistics
+[Description]: take a copy of the sleep residency counters
+[Args]:
+[in]	-NONE
+[out]	SYSTICK_SleepStatistics * stats:
+					pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void SYSTICK_getSleepStatistics(SYSTICK_SleepStatistics * stats)
+{
+	*stats = g_sleepStats;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_getDeadline
+[Description]: get the tick value at which a timeout starting now expires
+[Args]:
+[in]	uint32 timeoutMs:
+					the timeout in milliseconds
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the deadline tick
+------------------------------------------------------------------*/
+uint32 SYSTICK_getDeadline(uint32 timeoutMs)
+{
+	return SYSTICK_getTicks() + timeoutMs;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_isExpired
+[Description]: check if a deadline is reached ... safe across the counter wrap around
+[Args]:
+[in]	uint32 deadline:
+					the deadline tick
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the deadline is reached, FALSE otherwise
+------------------------------------------------------------------*/
+boolean SYSTICK_isExpired(uint32 deadline)
+{
+	/* the difference is read as signed so the wrap around of the counter doesn't matter */
+	if((sint32)(SYSTICK_getTicks() - deadline) >= 0)
+	{
+		return TRUE;
+	}
+	return FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  SYSTICK_tick
+[Description]: end the current tick, called by the Timer1 COMPARE_A interrupt
+				(directly or as its call back function, see TIMER1_STATIC_COMPARE_A)
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static inline void SYSTICK_tick(void)
+{
+	/* the volatile variables are read once ... the interrupts are already disabled here */
+	uint16 pending = g_pendingTicks;
+	uint16 compare = g_lastCompare + (pending * SYSTICK_COUNTS_PER_TICK);
+
+	g_ticks += pending;
+	g_lastCompare = compare;
+
+	/* back to one tick per compare after a stretched or a corrected period */
+	g_pendingTicks = 1;
+	OCR1A = compare + SYSTICK_COUNTS_PER_TICK;
+}
@@ -11,43 +11,73 @@
  *******************************************************************************/
 
 #include "timer.h"
+#include "common_macros.h"
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* all the Timer1 interrupt enable bits in TIMSK ... the other bits belong to Timer0 and Timer2 */
+#define TIMER1_INTERRUPTS_MASK		((1<<TICIE1)|(1<<OCIE1A)|(1<<OCIE1B)|(1<<TOIE1))
 
 /*******************************************************************************
  *                           Global Variables                                  *
  *******************************************************************************/
 
-/* callback function pointer */
-static volatile void (*g_callBackPtr)(void) = NULL_PTR;
+/* callback function pointer of every event */
+static void (* volatile g_callBacks[TIMER1_NUM_OF_EVENTS])(void) = {NULL_PTR};
+
+/* TIMSK enable bit and TIFR flag bit of every event */
+static const uint8 g_eventBits[TIMER1_NUM_OF_EVENTS] = {OCIE1A,OCIE1B,TOIE1,TICIE1};
+static const uint8 g_flagBits[TIMER1_NUM_OF_EVENTS] = {OCF1A,OCF1B,TOV1,ICF1};
 
 /*******************************************************************************
  *                       Interrupt Service Routines                            *
  *******************************************************************************/
+#if(TIMER1_STATIC_COMPARE_A == FALSE)
 ISR(TIMER1_COMPA_vect)
 {
-	if(g_callBackPtr != NULL_PTR)
+	if(g_callBacks[TIMER1_COMPARE_A] != NULL_PTR)
+	{
+		(* g_callBacks[TIMER1_COMPARE_A])();
+	}
+}
+#endif
+
+ISR(TIMER1_COMPB_vect)
+{
+	if(g_callBacks[TIMER1_COMPARE_B] != NULL_PTR)
 	{
-		(* g_callBackPtr)();
+		(* g_callBacks[TIMER1_COMPARE_B])();
 	}
 }
 
 ISR(TIMER1_OVF_vect)
 {
-	if(g_callBackPtr != NULL_PTR)
+	if(g_callBacks[TIMER1_OVERFLOW] != NULL_PTR)
+	{
+		(* g_callBacks[TIMER1_OVERFLOW])();
+	}
+}
+
+ISR(TIMER1_CAPT_vect)
+{
+	if(g_callBacks[TIMER1_CAPTURE] != NULL_PTR)
 	{
-		(* g_callBackPtr)();
+		(* g_callBacks[TIMER1_CAPTURE])();
 	}
 }
 
 /*******************************************************************************
- *                              Functions Prototypes                           *
+ *                      Functions Definitions                                  *
  *******************************************************************************/
 
 /*------------------------------------------------------------------
 [Function Name]:  Timer1_init
-[Description]: Function to initialize the Timer driver
+[Description]: Function to initialize the Timer driver, no interrupt is enabled
+				till Timer1_enableEvent is called
 [Args]:
 [in]	Timer1_ConfigType * config:
 					pointer to configuration structure
@@ -57,43 +87,38 @@ ISR(TIMER1_OVF_vect)
 ------------------------------------------------------------------*/
 void Timer1_init(const Timer1_ConfigType * config)
 {
+	/* non PWM mode ... OC1A and OC1B pins are disconnected */
+	TCCR1A = (1<<FOC1A) | (1<<FOC1B);
+
 	if(config->mode == NORMAL_MODE)
 	{
-		TCCR1A = 0x0C;
+		TCCR1B = 0;
 	}
 	else
 	{
-		/* compare mode configurations */
-		TCCR1A = 0x0C;
-		TCCR1B = 0x08;
-		OCR1A = config->compare_value;
+		/* compare mode configurations ... clear the counter on OCR1A */
+		TCCR1B = (1<<WGM12);
 	}
+	OCR1A = config->compare_value;
+
 	/* sets initial value in TCNT1 register */
 	TCNT1 = config->initial_value;
 
+	/* start with the interrupts of Timer1 disabled and its old flags cleared */
+	TIMSK &= ~TIMER1_INTERRUPTS_MASK;
+	TIFR = TIMER1_INTERRUPTS_MASK;
+
 	/* setup prescaller */
 	TCCR1B = (TCCR1B & 0xF8) | (config->prescaler & 0x07);
-
-	if(config->mode == NORMAL_MODE)
-	{
-		/* Enable Over Flow interrupt for Normal mode configurations */
-		TIMSK = (1<<TOIE1);
-	}
-	else
-	{
-		/* Enable Compare interrupt for Compare mode configurations */
-		TIMSK = (1<<OCIE1A);
-	}
 }
 
 
 
 
 
-
 /*------------------------------------------------------------------
 [Function Name]:  Timer1_deInit
-[Description]: Function to disable the Timer1
+[Description]: Function to disable the Timer1 with all its events and call back functions
 [Args]:
 [in]	-NONE
 [out]	-NONE
@@ -102,12 +127,20 @@ void Timer1_init(const Timer1_ConfigType * config)
 ------------------------------------------------------------------*/
 void Timer1_deInit(void)
 {
+	uint8 event;
+
 	/* Disable Timer1 */
 	TCCR1B = 0;
 	TCCR1A = 0;
-	TCCR1B = 0;
+	TIMSK &= ~TIMER1_INTERRUPTS_MASK;
 	OCR1A = 0;
+	OCR1B = 0;
 	TCNT1 = 0;
+
+	for(event=0;event<TIMER1_NUM_OF_EVENTS;event++)
+	{
+		g_callBacks[event] = NULL_PTR;
+	}
 }
 
 
@@ -116,14 +149,188 @@ void Timer1_deInit(void)
 
 /*------------------------------------------------------------------
 [Function Name]:  Timer1_setCallBack
-[Description]: Function to set the Call Back function address
+[Description]: Function to set the Call Back function address of one event,
+				the other events keep their call back functions
+[Args]:
+[in]	Timer1_Event event:
+					the interrupt source
+		void(*a_ptr)(void):
+					the call back function (NULL_PTR to remove it)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void Timer1_setCallBack(Timer1_Event event, void(*a_ptr)(void))
+{
+	if(event < TIMER1_NUM_OF_EVENTS)
+	{
+		g_callBacks[event] = a_ptr;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  Timer1_enableEvent
+[Description]: Function to enable the interrupt of one event
+[Args]:
+[in]	Timer1_Event event:
+					the interrupt source
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void Timer1_enableEvent(Timer1_Event event)
+{
+	uint8 sreg;
+
+	if(event < TIMER1_NUM_OF_EVENTS)
+	{
+		/* an old flag would fire the event at once */
+		TIFR = (1<<g_flagBits[event]);
+
+		/* TIMSK is shared with the other timers so it is changed with the interrupts disabled */
+		sreg = SREG;
+		cli();
+		SET_BIT(TIMSK,g_eventBits[event]);
+		SREG = sreg;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  Timer1_disableEvent
+[Description]: Function to disable the interrupt of one event
+[Args]:
+[in]	Timer1_Event event:
+					the interrupt source
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void Timer1_disableEvent(Timer1_Event event)
+{
+	uint8 sreg;
+
+	if(event < TIMER1_NUM_OF_EVENTS)
+	{
+		sreg = SREG;
+		cli();
+		CLEAR_BIT(TIMSK,g_eventBits[event]);
+		SREG = sreg;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  Timer1_setCompare
+[Description]: Function to set the counter value at which a compare channel interrupts next
+[Args]:
+[in]	Timer1_Event channel:
+					TIMER1_COMPARE_A or TIMER1_COMPARE_B
+		uint16 value:
+					the compare value
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void Timer1_setCompare(Timer1_Event channel, uint16 value)
+{
+	uint8 sreg = SREG;
+
+	/* 16-bit registers are written through the shared TEMP register so no interrupt may come in between */
+	cli();
+	if(channel == TIMER1_COMPARE_A)
+	{
+		OCR1A = value;
+	}
+	else if(channel == TIMER1_COMPARE_B)
+	{
+		OCR1B = value;
+	}
+	SREG = sreg;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  Timer1_getCount
+[Description]: Function to read the counter
 [Args]:
 [in]	-NONE
 [out]	-NONE
 [in/out] -NONE
+[Returns]: the TCNT1 value
+------------------------------------------------------------------*/
+uint16 Timer1_getCount(void)
+{
+	uint16 count;
+	uint8 sreg = SREG;
+
+	cli();
+	count = TCNT1;
+	SREG = sreg;
+	return count;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  Timer1_setCaptureEdge
+[Description]: Function to choose the ICP1 pin edge that captures the counter
+[Args]:
+[in]	Timer1_Edge edge:
+					the edge
+[out]	-NONE
+[in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void Timer1_setCallBack(void(*a_ptr)(void))
+void Timer1_setCaptureEdge(Timer1_Edge edge)
+{
+	if(edge == RISING_EDGE)
+	{
+		SET_BIT(TCCR1B,ICES1);
+	}
+	else
+	{
+		CLEAR_BIT(TCCR1B,ICES1);
+	}
+	/* changing the edge may set the capture flag */
+	TIFR = (1<<ICF1);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  Timer1_getCapture
+[Description]: Function to read the counter value captured by the last ICP1 edge
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the ICR1 value
+------------------------------------------------------------------*/
+uint16 Timer1_getCapture(void)
 {
-	g_callBackPtr = (volatile void (*)(void))a_ptr;
+	uint16 capture;
+	uint8 sreg = SREG;
+
+	cli();
+	capture = ICR1;
+	SREG = sreg;
+	return capture;
 }
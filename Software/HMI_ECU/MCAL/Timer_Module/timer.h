@@ -15,6 +15,28 @@
 
 #include "std_types.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * COMPARE_A interrupt handler configuration, its value should be TRUE or FALSE
+ *   FALSE : the interrupt calls the call back function set by Timer1_setCallBack
+ *   TRUE  : the interrupt is served by the SysTick directly (its ISR is in systick.c) so the tick
+ *           is compiled inside the ISR body and only the registers it uses are saved instead of
+ *           all the call-clobbered ones ... Timer1_setCallBack has no effect on TIMER1_COMPARE_A then
+ *           (make -f makefile.release isr lists the interrupt with both settings to compare them)
+ */
+#ifndef TIMER1_STATIC_COMPARE_A
+#define TIMER1_STATIC_COMPARE_A		TRUE
+#endif
+
+#if((TIMER1_STATIC_COMPARE_A != TRUE) && (TIMER1_STATIC_COMPARE_A != FALSE))
+
+#error "TIMER1_STATIC_COMPARE_A should be TRUE or FALSE"
+
+#endif
+
 /*******************************************************************************
  *                               Types Declaration                             *
  *******************************************************************************/
@@ -35,12 +57,34 @@ typedef enum
 /*------------------------------------------------------------------
 [ENUM Name]: Timer1_Mode
 [ENUM Description]: it's used to define timer1 Mode
+					NORMAL_MODE  : the counter runs freely from 0 to 0xFFFF so all the events can be
+					               used at the same time, every compare channel schedules its next
+					               event by adding its period to its compare value
+					COMPARE_MODE : the counter is cleared at the OCR1A compare value (one user only)
 ------------------------------------------------------------------*/
 typedef enum
 {
 	NORMAL_MODE,COMPARE_MODE
 }Timer1_Mode;
 
+/*------------------------------------------------------------------
+[ENUM Name]: Timer1_Event
+[ENUM Description]: it's used to define the timer1 interrupt sources ... every one has its own callback
+------------------------------------------------------------------*/
+typedef enum
+{
+	TIMER1_COMPARE_A,TIMER1_COMPARE_B,TIMER1_OVERFLOW,TIMER1_CAPTURE,TIMER1_NUM_OF_EVENTS
+}Timer1_Event;
+
+/*------------------------------------------------------------------
+[ENUM Name]: Timer1_Edge
+[ENUM Description]: it's used to define the ICP1 pin edge that captures the counter
+------------------------------------------------------------------*/
+typedef enum
+{
+	FALLING_EDGE,RISING_EDGE
+}Timer1_Edge;
+
 /*------------------------------------------------------------------
 [Structure Name]: Timer1_ConfigType
 [Structure Description]: it's used to define Timer1 configurations
@@ -61,7 +105,8 @@ typedef struct {
 
 /*------------------------------------------------------------------
 [Function Name]:  Timer1_init
-[Description]: Function to initialize the Timer driver
+[Description]: Function to initialize the Timer driver, no interrupt is enabled
+				till Timer1_enableEvent is called
 [Args]:
 [in]	Timer1_ConfigType * config:
 					pointer to configuration structure
@@ -77,7 +122,7 @@ void Timer1_init(const Timer1_ConfigType * config);
 
 /*------------------------------------------------------------------
 [Function Name]:  Timer1_deInit
-[Description]: Function to disable the Timer1
+[Description]: Function to disable the Timer1 with all its events and call back functions
 [Args]:
 [in]	-NONE
 [out]	-NONE
@@ -92,14 +137,114 @@ void Timer1_deInit(void);
 
 /*------------------------------------------------------------------
 [Function Name]:  Timer1_setCallBack
-[Description]: Function to set the Call Back function address
+[Description]: Function to set the Call Back function address of one event,
+				the other events keep their call back functions
+[Args]:
+[in]	Timer1_Event event:
+					the interrupt source
+		void(*a_ptr)(void):
+					the call back function (NULL_PTR to remove it)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void Timer1_setCallBack(Timer1_Event event, void(*a_ptr)(void));
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  Timer1_enableEvent
+[Description]: Function to enable the interrupt of one event
+[Args]:
+[in]	Timer1_Event event:
+					the interrupt source
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void Timer1_enableEvent(Timer1_Event event);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  Timer1_disableEvent
+[Description]: Function to disable the interrupt of one event
+[Args]:
+[in]	Timer1_Event event:
+					the interrupt source
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void Timer1_disableEvent(Timer1_Event event);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  Timer1_setCompare
+[Description]: Function to set the counter value at which a compare channel interrupts next
+[Args]:
+[in]	Timer1_Event channel:
+					TIMER1_COMPARE_A or TIMER1_COMPARE_B
+		uint16 value:
+					the compare value
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void Timer1_setCompare(Timer1_Event channel, uint16 value);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  Timer1_getCount
+[Description]: Function to read the counter
 [Args]:
 [in]	-NONE
 [out]	-NONE
 [in/out] -NONE
+[Returns]: the TCNT1 value
+------------------------------------------------------------------*/
+uint16 Timer1_getCount(void);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  Timer1_setCaptureEdge
+[Description]: Function to choose the ICP1 pin edge that captures the counter
+[Args]:
+[in]	Timer1_Edge edge:
+					the edge
+[out]	-NONE
+[in/out] -NONE
 [Returns]: Nothing
 ------------------------------------------------------------------*/
-void Timer1_setCallBack(void(*a_ptr)(void));
+void Timer1_setCaptureEdge(Timer1_Edge edge);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  Timer1_getCapture
+[Description]: Function to read the counter value captured by the last ICP1 edge
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the ICR1 value
+------------------------------------------------------------------*/
+uint16 Timer1_getCapture(void);
 
 
 #endif /* TIMER_H_ */
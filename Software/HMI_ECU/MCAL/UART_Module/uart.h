@@ -15,7 +15,28 @@
 
 #include "std_types.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Size of the Rx/Tx ring buffers used in interrupt mode ... must be a power of two and <= 128 */
+#define UART_RX_BUFFER_SIZE			32
+#define UART_TX_BUFFER_SIZE			32
+
+#if((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) || (UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)))
+
+#error "UART buffer sizes should be a power of two"
 
+#endif
+
+/*
+ * Multi-drop bus (NINE_DATABITS): the 9th bit marks an address frame sent by the master
+ * with UART_sendAddress. A slave (address != UART_MASTER_ADDRESS) uses the MPCM mode so
+ * its RXC ISR sees only the address frames till its own address is sent, then it receives
+ * the data frames and may transmit till another slave is addressed.
+ * The multi-drop bus needs UART_INTERRUPT_MODE.
+ */
+#define UART_MASTER_ADDRESS			0
 
 /*******************************************************************************
  *                               Types Declaration                             *
@@ -47,14 +68,62 @@ typedef enum
 ------------------------------------------------------------------*/
 typedef enum
 {
-	FIVE_DATABITS,SIX_DATABITS,SEVEN_DATABITS,EIGHT_DATABITS
+	FIVE_DATABITS,SIX_DATABITS,SEVEN_DATABITS,EIGHT_DATABITS,NINE_DATABITS=7
 }UART_DATABITS;
 
 
 
+/*------------------------------------------------------------------
+[ENUM Name]: UART_Mode
+[ENUM Description]: it's used to define how the driver moves the data
+					UART_POLLING_MODE   : every call spins on the UCSRA flags
+					UART_INTERRUPT_MODE : RXC/UDRE interrupts fill and drain the ring buffers
+------------------------------------------------------------------*/
+typedef enum
+{
+	UART_POLLING_MODE,UART_INTERRUPT_MODE
+}UART_Mode;
+
+
+/*------------------------------------------------------------------
+[ENUM Name]: UART_Status
+[ENUM Description]: it's used to report the result of the non-blocking and timed calls
+					UART_FRAMING_ERROR : a byte had a wrong stop bit (FE)
+					UART_OVERRUN_ERROR : a byte was lost before it was read (DOR)
+					UART_PARITY_ERROR  : a byte had a wrong parity bit (PE)
+------------------------------------------------------------------*/
+typedef enum
+{
+	UART_SUCCESS,UART_NO_DATA,UART_BUFFER_FULL,UART_TIMEOUT,
+	UART_FRAMING_ERROR,UART_OVERRUN_ERROR,UART_PARITY_ERROR
+}UART_Status;
+
+
+
+/*------------------------------------------------------------------
+[Structure Name]: UART_Statistics
+[Structure Description]: it's used to report the driver counters since power up
+					rxBytes      : bytes read from UDR (good or bad)
+					txBytes      : bytes written to UDR
+					frameErrors  : bytes dropped because of a wrong stop bit (FE)
+					parityErrors : bytes dropped because of a wrong parity bit (PE)
+					rxOverruns   : bytes lost by the hardware (DOR) or because the Rx buffer was full
+					txOverruns   : bytes dropped by UART_sendByteNonBlocking because the Tx buffer was full
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint32 rxBytes;
+	uint32 txBytes;
+	uint16 frameErrors;
+	uint16 parityErrors;
+	uint16 rxOverruns;
+	uint16 txOverruns;
+}UART_Statistics;
+
 /*------------------------------------------------------------------
 [Structure Name]: UART_ConfigType
-[Structure Description]: it's used to define UART configurations like parity,stop bits,data bits & baudrate
+[Structure Description]: it's used to define UART configurations like parity,stop bits,data bits,baudrate & mode,
+						the address is used only with NINE_DATABITS (UART_MASTER_ADDRESS if not used)
 ------------------------------------------------------------------*/
 typedef struct
 {
@@ -62,6 +131,8 @@ typedef struct
 	UART_STOPBIT stopbit;
 	UART_DATABITS databits;
 	uint32 baudrate;
+	UART_Mode mode;
+	uint8 address;
 
 }UART_ConfigType;
 
@@ -92,14 +163,16 @@ void UART_init(UART_ConfigType * config);
 /*------------------------------------------------------------------
 [Function Name]:  UART_sendByte
 [Description]: responsible for send byte to another UART device.
+				In interrupt mode it waits only if the Tx buffer is full, a slave that is
+				not selected can't drain the buffer so the byte is dropped instead.
 [Args]:
 [in]	uint8 data:
 				the byte you want to send through UART
 [out]	-NONE
 [in/out] -NONE
-[Returns]: Nothing
+[Returns]: TRUE if the byte is sent or queued, FALSE if it is dropped
 ------------------------------------------------------------------*/
-void UART_sendByte(uint8 data);
+boolean UART_sendByte(uint8 data);
 
 
 
@@ -108,6 +181,7 @@ void UART_sendByte(uint8 data);
 /*------------------------------------------------------------------
 [Function Name]:  UART_receiveByte
 [Description]: responsible for receive byte from another UART device.
+				In interrupt mode it waits only if the Rx buffer is empty.
 [Args]:
 [in]	 -NONE
 [out]	 -NONE
@@ -148,4 +222,186 @@ void UART_sendString(const uint8 * str);
 ------------------------------------------------------------------*/
 void UART_receiveString(uint8 * str);
 
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_sendByteNonBlocking
+[Description]: queue a byte in the Tx buffer without waiting (interrupt mode only).
+[Args]:
+[in]	uint8 data:
+				the byte you want to send through UART
+[out]	-NONE
+[in/out] -NONE
+[Returns]: UART_SUCCESS if the byte is queued or UART_BUFFER_FULL if it is dropped
+------------------------------------------------------------------*/
+UART_Status UART_sendByteNonBlocking(uint8 data);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_receiveByteNonBlocking
+[Description]: take a byte from the Rx buffer without waiting (interrupt mode only).
+				Errors seen by the RXC ISR since the last call are reported first,
+				the corrupted bytes themselves are never put in the buffer.
+[Args]:
+[in]	 -NONE
+[out]	 uint8 * data:
+				pointer to the variable you want to save the received byte in
+[in/out] -NONE
+[Returns]: UART_SUCCESS if a byte is returned, UART_NO_DATA if the buffer is empty
+			or the error (FE, DOR, PE) if one happened
+------------------------------------------------------------------*/
+UART_Status UART_receiveByteNonBlocking(uint8 * data);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_receiveByteTimeout
+[Description]: wait for a received byte till a system tick deadline (works in both modes).
+[Args]:
+[in]	 uint32 deadline:
+				the SysTick value at which the wait is given up (see SYSTICK_getDeadline)
+[out]	 uint8 * data:
+				pointer to the variable you want to save the received byte in
+[in/out] -NONE
+[Returns]: UART_SUCCESS if a byte is returned, UART_TIMEOUT if the deadline is reached
+			or the error (FE, DOR, PE) if one happened
+------------------------------------------------------------------*/
+UART_Status UART_receiveByteTimeout(uint8 * data, uint32 deadline);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_getRxOverrunCount
+[Description]: get how many received bytes were lost because the Rx buffer
+				was full or the hardware data overrun flag (DOR) was set.
+[Args]:
+[in]	 -NONE
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: the number of lost received bytes
+------------------------------------------------------------------*/
+uint16 UART_getRxOverrunCount(void);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_getTxOverrunCount
+[Description]: get how many bytes were dropped by UART_sendByteNonBlocking
+				because the Tx buffer was full.
+[Args]:
+[in]	 -NONE
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: the number of dropped transmitted bytes
+------------------------------------------------------------------*/
+uint16 UART_getTxOverrunCount(void);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_getFrameErrorCount
+[Description]: get how many received bytes were dropped because of a
+				framing error (wrong stop bit), usually a baud rate mismatch.
+[Args]:
+[in]	 -NONE
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: the number of bytes received with a framing error
+------------------------------------------------------------------*/
+uint16 UART_getFrameErrorCount(void);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_getStatistics
+[Description]: take a copy of all the driver counters at once.
+[Args]:
+[in]	 -NONE
+[out]	 UART_Statistics * stats:
+				pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void UART_getStatistics(UART_Statistics * stats);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_sendAddress
+[Description]: (master) send an address frame on the multi-drop bus after the queued bytes,
+				the addressed slave gets all the next data bytes till another address is sent.
+[Args]:
+[in]	uint8 address:
+				the address of the slave
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void UART_sendAddress(uint8 address);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_flush
+[Description]: wait till every queued byte is completely shifted out on the Tx line,
+				must be called before changing the frame format or the baud rate.
+[Args]:
+[in]	 -NONE
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void UART_flush(void);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_canSend
+[Description]: check if a number of bytes can be sent now without being dropped,
+				used to send a whole frame or nothing while the slave is not selected.
+[Args]:
+[in]	 uint8 count:
+				the number of bytes
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: TRUE if they fit in the Tx buffer or the buffer is being drained, FALSE otherwise
+------------------------------------------------------------------*/
+boolean UART_canSend(uint8 count);
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_waitForData
+[Description]: sleep till a byte is received or a system tick deadline is reached,
+				it returns at once if a byte is already waiting or in the polling mode.
+[Args]:
+[in]	 uint32 deadline:
+				the SysTick value at which the CPU must be awake (see SYSTICK_getDeadline)
+[out]	 -NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void UART_waitForData(uint32 deadline);
+
 #endif /* UART_H_ */
@@ -0,0 +1,293 @@
+ /******************************************************************************
+ *
+ * Module: BAUD
+ *
+ * File Name: baud.c
+ *
+ * Description: Source file for the baud rate negotiation between the HMI_ECU and the Control_ECU
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "baud.h"
+#include <util/delay.h>
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* rates sorted from the fastest to the default one */
+static const uint32 g_baudRates[BAUD_NUM_OF_RATES] = {500000,250000,125000,38400,19200,9600};
+
+/* the test pattern ... toggling bits, all zeros, all ones and the SYNC byte */
+static const uint8 g_testPattern[BAUD_TEST_PATTERN_SIZE] = {0x55,0xAA,0x00,0xFF,0x0F,0xF0,0x7E,0x81};
+
+/* the UART configurations with the baud rate in use */
+static UART_ConfigType g_uartConfig;
+
+/* index of the baud rate in use */
+static uint8 g_rateIndex = BAUD_DEFAULT_INDEX;
+
+/* framing errors count at the last link check */
+static uint16 g_lastFrameErrors = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void BAUD_switch(uint8 index);
+
+static boolean BAUD_isTestPattern(const FRAME_Message * frame);
+
+static boolean BAUD_waitFrame(uint8 type, FRAME_Message * frame, uint16 timeoutMs);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_init
+[Description]: initialize the UART at the default baud rate
+[Args]:
+[in]	const UART_ConfigType * config:
+					the UART configurations, its baud rate is replaced by the default one
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void BAUD_init(const UART_ConfigType * config)
+{
+	g_uartConfig = *config;
+	g_uartConfig.baudrate = g_baudRates[BAUD_DEFAULT_INDEX];
+	g_rateIndex = BAUD_DEFAULT_INDEX;
+
+	UART_init(&g_uartConfig);
+
+	g_lastFrameErrors = UART_getFrameErrorCount();
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_negotiate
+[Description]: (HMI_ECU) try the rates from BAUD_FIRST_INDEX to the slowest
+				and keep the first one that passes the test pattern exchange
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the agreed baud rate
+------------------------------------------------------------------*/
+uint32 BAUD_negotiate(void)
+{
+	uint8 index;
+	FRAME_Message frame;
+
+	for(index=BAUD_FIRST_INDEX;index<BAUD_DEFAULT_INDEX;index++)
+	{
+		/* propose the rate at the default rate */
+		FRAME_send(BAUD_PROPOSE, 0, &index, 1);
+		if(BAUD_waitFrame(BAUD_ACCEPT, &frame, BAUD_REPLY_TIMEOUT_MS) == FALSE)
+		{
+			continue;
+		}
+
+		/* give the Control ECU the time to switch too */
+		BAUD_switch(index);
+		_delay_ms(BAUD_SWITCH_GUARD_MS);
+
+		/* the Control ECU must echo the pattern without errors */
+		FRAME_send(BAUD_TEST, 0, g_testPattern, BAUD_TEST_PATTERN_SIZE);
+		if((BAUD_waitFrame(BAUD_TEST, &frame, BAUD_TEST_TIMEOUT_MS) == TRUE) && (BAUD_isTestPattern(&frame) == TRUE))
+		{
+			FRAME_send(BAUD_CONFIRM, 0, NULL_PTR, 0);
+			if(BAUD_waitFrame(BAUD_CONFIRM, &frame, BAUD_TEST_TIMEOUT_MS) == TRUE)
+			{
+				return g_baudRates[index];
+			}
+		}
+
+		/* the rate failed ... go back and wait till the Control ECU gives up too */
+		BAUD_switch(BAUD_DEFAULT_INDEX);
+		_delay_ms(2 * BAUD_TEST_TIMEOUT_MS + BAUD_SWITCH_GUARD_MS);
+	}
+
+	return g_baudRates[BAUD_DEFAULT_INDEX];
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_handleProposal
+[Description]: (Control_ECU) answer a BAUD_PROPOSE frame and run the test pattern exchange,
+				the default rate is restored if the exchange fails
+[Args]:
+[in]	const FRAME_Message * frame:
+					the received BAUD_PROPOSE frame
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void BAUD_handleProposal(const FRAME_Message * frame)
+{
+	uint8 index = frame->payload[0];
+	FRAME_Message reply;
+
+	/* unknown rate ... no answer so the HMI ECU proposes the next one */
+	if((frame->length != 1) || (index >= BAUD_NUM_OF_RATES))
+	{
+		return;
+	}
+
+	FRAME_send(BAUD_ACCEPT, 0, &index, 1);
+	BAUD_switch(index);
+
+	if((BAUD_waitFrame(BAUD_TEST, &reply, BAUD_TEST_TIMEOUT_MS) == TRUE) && (BAUD_isTestPattern(&reply) == TRUE))
+	{
+		/* echo the pattern and wait for the confirmation */
+		FRAME_send(BAUD_TEST, 0, reply.payload, reply.length);
+		if(BAUD_waitFrame(BAUD_CONFIRM, &reply, BAUD_TEST_TIMEOUT_MS) == TRUE)
+		{
+			FRAME_send(BAUD_CONFIRM, 0, NULL_PTR, 0);
+			return;
+		}
+	}
+
+	BAUD_switch(BAUD_DEFAULT_INDEX);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_checkLink
+[Description]: (Control_ECU) go back to the default rate if framing errors show that
+				the HMI_ECU is talking at another rate (after a reset for example)
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void BAUD_checkLink(void)
+{
+	uint16 frameErrors = UART_getFrameErrorCount();
+
+	if((g_rateIndex != BAUD_DEFAULT_INDEX) && ((uint16)(frameErrors - g_lastFrameErrors) >= BAUD_MAX_FRAME_ERRORS))
+	{
+		BAUD_switch(BAUD_DEFAULT_INDEX);
+	}
+
+	g_lastFrameErrors = frameErrors;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_getBaudrate
+[Description]: get the baud rate in use
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the current baud rate
+------------------------------------------------------------------*/
+uint32 BAUD_getBaudrate(void)
+{
+	return g_baudRates[g_rateIndex];
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_switch
+[Description]: re-initialize the UART at another rate after the last byte is sent
+[Args]:
+[in]	uint8 index:
+					index of the new rate
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void BAUD_switch(uint8 index)
+{
+	UART_flush();
+
+	g_uartConfig.baudrate = g_baudRates[index];
+	g_rateIndex = index;
+
+	UART_init(&g_uartConfig);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_isTestPattern
+[Description]: check that a frame carries the test pattern without errors
+[Args]:
+[in]	const FRAME_Message * frame:
+					the received BAUD_TEST frame
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the pattern is correct, FALSE otherwise
+------------------------------------------------------------------*/
+static boolean BAUD_isTestPattern(const FRAME_Message * frame)
+{
+	uint8 i;
+
+	if(frame->length != BAUD_TEST_PATTERN_SIZE)
+	{
+		return FALSE;
+	}
+
+	for(i=0;i<BAUD_TEST_PATTERN_SIZE;i++)
+	{
+		if(frame->payload[i] != g_testPattern[i])
+		{
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  BAUD_waitFrame
+[Description]: wait for a frame of a certain type, other frames (like a late
+				HMI_READY answer) are dropped
+[Args]:
+[in]	uint8 type:
+					the expected frame type
+		uint16 timeoutMs:
+					maximum time to wait for each frame in milliseconds
+[out]	FRAME_Message * frame:
+					pointer to the structure you want to save the frame in
+[in/out] -NONE
+[Returns]: TRUE if the frame is received or FALSE if the time is out
+------------------------------------------------------------------*/
+static boolean BAUD_waitFrame(uint8 type, FRAME_Message * frame, uint16 timeoutMs)
+{
+	while(FRAME_receiveTimeout(frame, timeoutMs) == TRUE)
+	{
+		if(frame->type == type)
+		{
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
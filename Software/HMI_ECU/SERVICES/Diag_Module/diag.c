@@ -0,0 +1,279 @@
+ /******************************************************************************
+ *
+ * Module: Diag
+ *
+ * File Name: diag.c
+ *
+ * Description: Source file for packing the UART, frame and link counters in diagnostics pages
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "diag.h"
+#include "uart.h"
+#include "frame.h"
+#include "link.h"
+#include "systick.h"
+#include "stack.h"
+
+/* only the Control_ECU has the I2C driver */
+#if __has_include("i2c.h")
+#include "i2c.h"
+#define DIAG_I2C_ENABLE				TRUE
+#else
+#define DIAG_I2C_ENABLE				FALSE
+#endif
+
+/* half of the histogram must fit in one page */
+#if(LINK_RTT_BUCKETS > FRAME_MAX_PAYLOAD_SIZE)
+#error "LINK_RTT_BUCKETS doesn't fit in the two RTT pages"
+#endif
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* longest main loop iteration in Timer1 counts and the number of iterations */
+static uint32 g_maxLoopCounts = 0;
+static uint32 g_loops = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static uint8 DIAG_putField(uint8 * payload, uint8 offset, uint32 value, uint8 size);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  DIAG_fillPage
+[Description]: pack the current counters of a page in a frame payload
+[Args]:
+[in]	uint8 page:
+					the page number (DIAG_PAGE_xxx)
+[out]	uint8 * payload:
+					pointer to a buffer of FRAME_MAX_PAYLOAD_SIZE bytes
+[in/out] -NONE
+[Returns]: the number of bytes written or 0 if the page doesn't exist
+------------------------------------------------------------------*/
+uint8 DIAG_fillPage(uint8 page, uint8 * payload)
+{
+	UART_Statistics uartStats;
+	FRAME_Statistics frameStats;
+	LINK_Statistics linkStats;
+	SYSTICK_SleepStatistics sleepStats;
+	STACK_Usage stackUsage;
+	uint32 sleepMs;
+	uint32 ticks;
+	uint8 size = DIAG_getFieldSize(page);
+	uint8 length = 0;
+	uint8 first;
+	uint8 i;
+#if(PROF_ENABLE == TRUE)
+	PROF_Region region;
+#endif
+#if(DIAG_I2C_ENABLE == TRUE)
+	I2C_Statistics i2cStats;
+#endif
+
+	UART_getStatistics(&uartStats);
+	FRAME_getStatistics(&frameStats);
+	LINK_getStatistics(&linkStats);
+
+	switch(page)
+	{
+	case DIAG_PAGE_BYTES:
+		length = DIAG_putField(payload, length, uartStats.rxBytes, size);
+		length = DIAG_putField(payload, length, uartStats.txBytes, size);
+		break;
+
+	case DIAG_PAGE_ERRORS:
+		length = DIAG_putField(payload, length, uartStats.frameErrors, size);
+		length = DIAG_putField(payload, length, uartStats.parityErrors, size);
+		length = DIAG_putField(payload, length, uartStats.rxOverruns, size);
+		length = DIAG_putField(payload, length, uartStats.txOverruns, size);
+		length = DIAG_putField(payload, length, frameStats.badFrames, size);
+		break;
+
+	case DIAG_PAGE_LINK:
+		length = DIAG_putField(payload, length, frameStats.rxFrames, size);
+		length = DIAG_putField(payload, length, frameStats.txFrames, size);
+		length = DIAG_putField(payload, length, linkStats.retransmissions, size);
+		length = DIAG_putField(payload, length, linkStats.timeouts, size);
+		length = DIAG_putField(payload, length, linkStats.droppedFrames, size);
+		break;
+
+	case DIAG_PAGE_RTT_LOW:
+	case DIAG_PAGE_RTT_HIGH:
+		/* the high page starts from the middle of the histogram */
+		first = (page == DIAG_PAGE_RTT_HIGH) ? (LINK_RTT_BUCKETS / 2) : 0;
+		for(i=first;i<(first + (LINK_RTT_BUCKETS / 2));i++)
+		{
+			length = DIAG_putField(payload, length, linkStats.rttHistogram[i], size);
+		}
+		break;
+
+	case DIAG_PAGE_LOOP:
+		length = DIAG_putField(payload, length, SYSTICK_COUNTS_TO_US(g_maxLoopCounts), size);
+		length = DIAG_putField(payload, length, g_loops, size);
+		break;
+
+	case DIAG_PAGE_SLEEP:
+		SYSTICK_getSleepStatistics(&sleepStats);
+		sleepMs = sleepStats.sleepTicks;
+		ticks = SYSTICK_getTicks();
+		length = DIAG_putField(payload, length, (ticks < 100) ? 0 : (sleepMs / (ticks / 100)), size);
+		length = DIAG_putField(payload, length, sleepMs, size);
+		length = DIAG_putField(payload, length, sleepStats.sleeps, size);
+		length = DIAG_putField(payload, length, sleepStats.timerWakeups, size);
+		break;
+
+	case DIAG_PAGE_RAM:
+		STACK_getUsage(&stackUsage);
+		length = DIAG_putField(payload, length, stackUsage.staticRam, size);
+		length = DIAG_putField(payload, length, stackUsage.stackSize, size);
+		length = DIAG_putField(payload, length, stackUsage.maxUsed, size);
+		length = DIAG_putField(payload, length, stackUsage.neverUsed, size);
+		break;
+
+	case DIAG_PAGE_I2C:
+#if(DIAG_I2C_ENABLE == TRUE)
+		I2C_getStatistics(&i2cStats);
+		length = DIAG_putField(payload, length, i2cStats.timeouts, size);
+		length = DIAG_putField(payload, length, i2cStats.nacks, size);
+		length = DIAG_putField(payload, length, i2cStats.busErrors, size);
+		length = DIAG_putField(payload, length, i2cStats.recoveries, size);
+#endif
+		break;
+
+	default:
+#if(PROF_ENABLE == TRUE)
+		/* one page per profiled region */
+		if((page >= DIAG_PAGE_PROF) && (page < DIAG_NUM_OF_PAGES))
+		{
+			PROF_getRegion(page - DIAG_PAGE_PROF, &region);
+			length = DIAG_putField(payload, length, region.count, size);
+			length = DIAG_putField(payload, length, region.min, size);
+			length = DIAG_putField(payload, length, region.max, size);
+			length = DIAG_putField(payload, length, region.total, size);
+		}
+#endif
+		break;
+	}
+	return length;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  DIAG_getFieldSize
+[Description]: get the size of the fields of a page
+[Args]:
+[in]	uint8 page:
+					the page number (DIAG_PAGE_xxx)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the field size in bytes
+------------------------------------------------------------------*/
+uint8 DIAG_getFieldSize(uint8 page)
+{
+	if((page == DIAG_PAGE_BYTES) || (page == DIAG_PAGE_LOOP) || (page == DIAG_PAGE_SLEEP) || (page >= DIAG_PAGE_PROF))
+	{
+		return sizeof(uint32);
+	}
+	return sizeof(uint16);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  DIAG_getField
+[Description]: unpack one field of a page filled by DIAG_fillPage (on this ECU or the other one)
+[Args]:
+[in]	uint8 page:
+					the page number (DIAG_PAGE_xxx)
+		const uint8 * payload:
+					pointer to the page bytes
+		uint8 index:
+					the field number in the page
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the field value
+------------------------------------------------------------------*/
+uint32 DIAG_getField(uint8 page, const uint8 * payload, uint8 index)
+{
+	uint8 size = DIAG_getFieldSize(page);
+	uint32 value = 0;
+	uint8 i;
+
+	/* least significant byte first */
+	for(i=size;i>0;i--)
+	{
+		value = (value << 8) | payload[(index * size) + i - 1];
+	}
+	return value;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  DIAG_recordLoop
+[Description]: count one main loop iteration and keep the longest one,
+				it must be called at the end of every iteration
+[Args]:
+[in]	uint32 start:
+					SYSTICK_getCounts value at the start of the iteration
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void DIAG_recordLoop(uint32 start)
+{
+	uint32 duration = SYSTICK_getCounts() - start;
+
+	if(duration > g_maxLoopCounts)
+	{
+		g_maxLoopCounts = duration;
+	}
+	g_loops++;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  DIAG_putField
+[Description]: write a field in the payload least significant byte first
+[Args]:
+[in]	uint8 offset:
+					the index of the first byte of the field
+		uint32 value:
+					the field value
+		uint8 size:
+					the field size in bytes
+[out]	uint8 * payload:
+					pointer to the page bytes
+[in/out] -NONE
+[Returns]: the offset of the next field
+------------------------------------------------------------------*/
+static uint8 DIAG_putField(uint8 * payload, uint8 offset, uint32 value, uint8 size)
+{
+	uint8 i;
+
+	for(i=0;i<size;i++)
+	{
+		payload[offset + i] = (uint8)value;
+		value >>= 8;
+	}
+	return offset + size;
+}
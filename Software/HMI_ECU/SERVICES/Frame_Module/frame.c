@@ -0,0 +1,310 @@
+ /******************************************************************************
+ *
+ * Module: FRAME
+ *
+ * File Name: frame.c
+ *
+ * Description: Source file for the framed message layer used between the HMI_ECU and the Control_ECU
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "frame.h"
+#include "uart.h"
+#include "systick.h"
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* frame counters ... all the parsers share them */
+static FRAME_Statistics g_stats;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static uint8 FRAME_updateCrc(uint8 crc, uint8 data);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_send
+[Description]: build a frame around the payload and send it through UART
+[Args]:
+[in]	uint8 type:
+					the command or the response carried by the frame
+		uint8 seq:
+					the sequence number of the frame (0 if untagged)
+		const uint8 * payload:
+					pointer to the payload bytes (can be NULL_PTR if length is 0)
+		uint8 length:
+					number of payload bytes, must not exceed FRAME_MAX_PAYLOAD_SIZE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the frame is sent, FALSE if it is dropped (too long, or the panel is
+			not selected on the bus and its Tx buffer has no room for the whole frame)
+------------------------------------------------------------------*/
+boolean FRAME_send(uint8 type, uint8 seq, const uint8 * payload, uint8 length)
+{
+	uint8 i;
+	uint8 crc = 0;
+	boolean sent;
+
+	/* a panel that is not selected sends the whole frame later or nothing ... never a part of it */
+	if((length > FRAME_MAX_PAYLOAD_SIZE) || (UART_canSend(length + FRAME_OVERHEAD_SIZE) == FALSE))
+	{
+		return FALSE;
+	}
+
+	sent = UART_sendByte(FRAME_SYNC_BYTE);
+
+	sent &= UART_sendByte(type);
+	crc = FRAME_updateCrc(crc, type);
+
+	sent &= UART_sendByte(seq);
+	crc = FRAME_updateCrc(crc, seq);
+
+	sent &= UART_sendByte(length);
+	crc = FRAME_updateCrc(crc, length);
+
+	for(i=0;i<length;i++)
+	{
+		sent &= UART_sendByte(payload[i]);
+		crc = FRAME_updateCrc(crc, payload[i]);
+	}
+
+	/* the panel may be deselected while waiting for room ... the receiver drops the cut frame by its CRC */
+	sent &= UART_sendByte(crc);
+	if(sent == TRUE)
+	{
+		g_stats.txFrames++;
+	}
+	return sent;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_receive
+[Description]: wait till a valid frame is received through UART,
+				corrupted frames are dropped and the parser resyncs on the next SYNC byte
+[Args]:
+[in]	-NONE
+[out]	FRAME_Message * message:
+					pointer to the structure you want to save the frame in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void FRAME_receive(FRAME_Message * message)
+{
+	FRAME_Parser parser;
+
+	FRAME_initParser(&parser);
+
+	/* keep feeding the parser till a whole valid frame is received */
+	while(FRAME_parseByte(&parser, UART_receiveByte()) == FALSE);
+
+	*message = parser.message;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_receiveTimeout
+[Description]: wait for a valid frame but give up after a certain time,
+				UART errors drop the partial frame so the parser resyncs
+[Args]:
+[in]	uint16 timeoutMs:
+					maximum time to wait in milliseconds
+[out]	FRAME_Message * message:
+					pointer to the structure you want to save the frame in
+[in/out] -NONE
+[Returns]: TRUE if a frame is received or FALSE if the time is out
+------------------------------------------------------------------*/
+boolean FRAME_receiveTimeout(FRAME_Message * message, uint16 timeoutMs)
+{
+	FRAME_Parser parser;
+	UART_Status status;
+	uint8 data;
+	uint32 deadline = SYSTICK_getDeadline(timeoutMs);
+
+	FRAME_initParser(&parser);
+
+	do
+	{
+		status = UART_receiveByteTimeout(&data, deadline);
+
+		if(status == UART_SUCCESS)
+		{
+			if(FRAME_parseByte(&parser, data) == TRUE)
+			{
+				*message = parser.message;
+				return TRUE;
+			}
+		}
+		else if(status != UART_TIMEOUT)
+		{
+			/* a byte is lost or corrupted ... drop the partial frame and resync */
+			FRAME_initParser(&parser);
+		}
+	}while(status != UART_TIMEOUT);
+
+	return FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_initParser
+[Description]: reset the parser to wait for a new SYNC byte
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] FRAME_Parser * parser:
+					pointer to the parser
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void FRAME_initParser(FRAME_Parser * parser)
+{
+	parser->state = FRAME_WAIT_SYNC;
+	parser->index = 0;
+	parser->crc = 0;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_parseByte
+[Description]: feed one received byte to the parser
+[Args]:
+[in]	uint8 data:
+					the received byte
+[out]	-NONE
+[in/out] FRAME_Parser * parser:
+					pointer to the parser, parser->message holds the frame when TRUE is returned
+[Returns]: TRUE if the byte completed a valid frame, FALSE otherwise
+------------------------------------------------------------------*/
+boolean FRAME_parseByte(FRAME_Parser * parser, uint8 data)
+{
+	switch(parser->state)
+	{
+	case FRAME_WAIT_SYNC:
+		/* any byte outside a frame is ignored till the SYNC byte */
+		if(data == FRAME_SYNC_BYTE)
+		{
+			parser->crc = 0;
+			parser->state = FRAME_WAIT_TYPE;
+		}
+		break;
+
+	case FRAME_WAIT_TYPE:
+		parser->message.type = data;
+		parser->crc = FRAME_updateCrc(parser->crc, data);
+		parser->state = FRAME_WAIT_SEQ;
+		break;
+
+	case FRAME_WAIT_SEQ:
+		parser->message.seq = data;
+		parser->crc = FRAME_updateCrc(parser->crc, data);
+		parser->state = FRAME_WAIT_LENGTH;
+		break;
+
+	case FRAME_WAIT_LENGTH:
+		if(data > FRAME_MAX_PAYLOAD_SIZE)
+		{
+			/* can't be a valid frame ... resync */
+			g_stats.badFrames++;
+			FRAME_initParser(parser);
+			break;
+		}
+		parser->message.length = data;
+		parser->crc = FRAME_updateCrc(parser->crc, data);
+		parser->index = 0;
+		parser->state = (data == 0) ? FRAME_WAIT_CRC : FRAME_WAIT_PAYLOAD;
+		break;
+
+	case FRAME_WAIT_PAYLOAD:
+		parser->message.payload[parser->index] = data;
+		parser->crc = FRAME_updateCrc(parser->crc, data);
+		parser->index++;
+		if(parser->index == parser->message.length)
+		{
+			parser->state = FRAME_WAIT_CRC;
+		}
+		break;
+
+	case FRAME_WAIT_CRC:
+		/* the frame is done ... valid or not the parser waits for a new SYNC byte */
+		parser->state = FRAME_WAIT_SYNC;
+		if(data == parser->crc)
+		{
+			g_stats.rxFrames++;
+			return TRUE;
+		}
+		g_stats.badFrames++;
+		break;
+	}
+	return FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_getStatistics
+[Description]: take a copy of the frame counters
+[Args]:
+[in]	-NONE
+[out]	FRAME_Statistics * stats:
+					pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void FRAME_getStatistics(FRAME_Statistics * stats)
+{
+	*stats = g_stats;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_updateCrc
+[Description]: add one byte to a CRC-8 (polynomial 0x07)
+[Args]:
+[in]	uint8 crc:
+					the CRC calculated so far
+		uint8 data:
+					the new byte
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the updated CRC
+------------------------------------------------------------------*/
+static uint8 FRAME_updateCrc(uint8 crc, uint8 data)
+{
+	uint8 i;
+
+	crc ^= data;
+	for(i=0;i<8;i++)
+	{
+		if(crc & 0x80)
+			crc = (uint8)((crc << 1) ^ 0x07);
+		else
+			crc <<= 1;
+	}
+	return crc;
+}
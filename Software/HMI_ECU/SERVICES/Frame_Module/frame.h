@@ -0,0 +1,192 @@
+ /******************************************************************************
+ *
+ * Module: FRAME
+ *
+ * File Name: frame.h
+ *
+ * Description: Header file for the framed message layer used between the HMI_ECU and the Control_ECU
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Frame format on the UART line:
+ *
+ *   | SYNC | TYPE | SEQ | LENGTH | PAYLOAD (LENGTH bytes) | CRC |
+ *
+ * SEQ tags a request and its response (see link.h), 0 means untagged.
+ * CRC is a CRC-8 (polynomial 0x07) over TYPE, SEQ, LENGTH and PAYLOAD.
+ */
+#define FRAME_SYNC_BYTE				0x7E
+#define FRAME_MAX_PAYLOAD_SIZE		16
+#define FRAME_OVERHEAD_SIZE			5
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: FRAME_Message
+[Structure Description]: it holds one decoded frame
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint8 type;
+	uint8 seq;
+	uint8 length;
+	uint8 payload[FRAME_MAX_PAYLOAD_SIZE];
+}FRAME_Message;
+
+
+/*------------------------------------------------------------------
+[ENUM Name]: FRAME_ParserState
+[ENUM Description]: it's used to define which field the parser waits for
+------------------------------------------------------------------*/
+typedef enum
+{
+	FRAME_WAIT_SYNC,FRAME_WAIT_TYPE,FRAME_WAIT_SEQ,FRAME_WAIT_LENGTH,FRAME_WAIT_PAYLOAD,FRAME_WAIT_CRC
+}FRAME_ParserState;
+
+
+/*------------------------------------------------------------------
+[Structure Name]: FRAME_Parser
+[Structure Description]: it holds the state of a byte by byte frame parser
+------------------------------------------------------------------*/
+typedef struct
+{
+	FRAME_ParserState state;
+	uint8 index;
+	uint8 crc;
+	FRAME_Message message;
+}FRAME_Parser;
+
+
+/*------------------------------------------------------------------
+[Structure Name]: FRAME_Statistics
+[Structure Description]: it's used to report the frame counters since power up
+					txFrames  : frames sent
+					rxFrames  : valid frames received
+					badFrames : frames dropped because of a wrong CRC or length
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint16 txFrames;
+	uint16 rxFrames;
+	uint16 badFrames;
+}FRAME_Statistics;
+
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_send
+[Description]: build a frame around the payload and send it through UART
+[Args]:
+[in]	uint8 type:
+					the command or the response carried by the frame
+		uint8 seq:
+					the sequence number of the frame (0 if untagged)
+		const uint8 * payload:
+					pointer to the payload bytes (can be NULL_PTR if length is 0)
+		uint8 length:
+					number of payload bytes, must not exceed FRAME_MAX_PAYLOAD_SIZE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the frame is sent, FALSE if it is dropped (too long, or the panel is
+			not selected on the bus and its Tx buffer has no room for the whole frame)
+------------------------------------------------------------------*/
+boolean FRAME_send(uint8 type, uint8 seq, const uint8 * payload, uint8 length);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_receive
+[Description]: wait till a valid frame is received through UART,
+				corrupted frames are dropped and the parser resyncs on the next SYNC byte
+[Args]:
+[in]	-NONE
+[out]	FRAME_Message * message:
+					pointer to the structure you want to save the frame in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void FRAME_receive(FRAME_Message * message);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_receiveTimeout
+[Description]: wait for a valid frame but give up after a certain time,
+				UART errors drop the partial frame so the parser resyncs
+[Args]:
+[in]	uint16 timeoutMs:
+					maximum time to wait in milliseconds
+[out]	FRAME_Message * message:
+					pointer to the structure you want to save the frame in
+[in/out] -NONE
+[Returns]: TRUE if a frame is received or FALSE if the time is out
+------------------------------------------------------------------*/
+boolean FRAME_receiveTimeout(FRAME_Message * message, uint16 timeoutMs);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_initParser
+[Description]: reset the parser to wait for a new SYNC byte
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] FRAME_Parser * parser:
+					pointer to the parser
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void FRAME_initParser(FRAME_Parser * parser);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_parseByte
+[Description]: feed one received byte to the parser
+[Args]:
+[in]	uint8 data:
+					the received byte
+[out]	-NONE
+[in/out] FRAME_Parser * parser:
+					pointer to the parser, parser->message holds the frame when TRUE is returned
+[Returns]: TRUE if the byte completed a valid frame, FALSE otherwise
+------------------------------------------------------------------*/
+boolean FRAME_parseByte(FRAME_Parser * parser, uint8 data);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  FRAME_getStatistics
+[Description]: take a copy of the frame counters
+[Args]:
+[in]	-NONE
+[out]	FRAME_Statistics * stats:
+					pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void FRAME_getStatistics(FRAME_Statistics * stats);
+
+
+
+#endif /* FRAME_H_ */
@@ -0,0 +1,64 @@
+ /******************************************************************************
+ *
+ * Module: IDLE
+ *
+ * File Name: idle.c
+ *
+ * Description: Source file for the idle manager that sleeps till the next event
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "idle.h"
+#include "systick.h"
+#include "swtimer.h"
+#include <avr/io.h>
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  IDLE_init
+[Description]: turn off the unused analog blocks so they don't draw current while sleeping,
+				SYSTICK_init and SWTIMER_init must be called first
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void IDLE_init(void)
+{
+	/* the ADC and the analog comparator aren't used by any ECU */
+	CLEAR_BIT(ADCSRA,ADEN);
+	SET_BIT(ACSR,ACD);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  IDLE_enter
+[Description]: sleep till the next software timer expires or an interrupt comes,
+				it must be called when the main loop has nothing to do
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void IDLE_enter(void)
+{
+	uint32 wakeTick;
+
+	if(SWTIMER_getNextExpiry(&wakeTick) == FALSE)
+	{
+		wakeTick = SYSTICK_getDeadline(IDLE_MAX_SLEEP_MS);
+	}
+
+	SYSTICK_sleepUntil(wakeTick);
+}
@@ -0,0 +1,67 @@
+ /******************************************************************************
+ *
+ * Module: IDLE
+ *
+ * File Name: idle.h
+ *
+ * Description: Header file for the idle manager that sleeps till the next event
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef IDLE_H_
+#define IDLE_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * The idle sleep mode is the deepest one that is safe here: the USART and Timer1 (the SysTick)
+ * run from the CPU clock and stop in the deeper modes, so the UART Rx and the timers couldn't
+ * wake the CPU up anymore. The saving comes from not waking up every tick, the CPU sleeps till
+ * the next software timer expires or an interrupt (UART, external interrupt) comes.
+ */
+
+/* longest sleep if no software timer is running */
+#define IDLE_MAX_SLEEP_MS			500
+
+/* the sleep residency is counted by the SysTick (SYSTICK_getSleepStatistics) */
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  IDLE_init
+[Description]: turn off the unused analog blocks so they don't draw current while sleeping,
+				SYSTICK_init and SWTIMER_init must be called first
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void IDLE_init(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  IDLE_enter
+[Description]: sleep till the next software timer expires or an interrupt comes,
+				it must be called when the main loop has nothing to do
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void IDLE_enter(void);
+
+
+
+#endif /* IDLE_H_ */
@@ -0,0 +1,183 @@
+ /******************************************************************************
+ *
+ * Module: Prof
+ *
+ * File Name: prof.h
+ *
+ * Description: Header file for timing the hot code regions
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef PROF_H_
+#define PROF_H_
+
+#include "std_types.h"
+#include "systick.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Profiling configuration, its value should be TRUE or FALSE ... it can be set from the project symbols,
+ * when it is FALSE PROF_BEGIN and PROF_END compile to nothing and the table is removed
+ */
+#ifndef PROF_ENABLE
+#define PROF_ENABLE					FALSE
+#endif
+
+#if((PROF_ENABLE != TRUE) && (PROF_ENABLE != FALSE))
+
+#error "PROF_ENABLE should be TRUE or FALSE"
+
+#endif
+
+/*
+ * profiled regions ... every region has its own row in the table and its own diagnostics page,
+ * the code regions are timed by PROF_BEGIN/PROF_END and the user visible flows of the HMI_ECU by PROF_START/PROF_STOP
+ */
+#define PROF_CHECK_PASSWORD			0	/* checkPassword on the Control_ECU */
+#define PROF_EEPROM_READ			1	/* EEPROM_readByte */
+#define PROF_LCD_COMMAND			2	/* LCD_sendCommand */
+#define PROF_KEY_TO_ECHO			3	/* a debounced key till the screen is updated */
+#define PROF_ENTER_TO_PASS_CORRECT	4	/* Enter after the password till PASS_CORRECT arrives */
+#define PROF_NEW_PASS_TO_SAVED		5	/* SETTING_UP_A_NEW_PASS sent till NEW_PASS_SAVED arrives */
+#define PROF_POWER_ON_TO_MENU		6	/* SYSTICK_init till the main menu is shown the first time */
+#define PROF_EEPROM_WRITE_CYCLE		7	/* the STOP of an EEPROM write till the first ACK of its address */
+#define PROF_NUM_OF_REGIONS			8
+
+/*
+ * Latency budget of every region in microseconds, a longest time above it is a regression
+ * (the HMI service screen marks it with '!') ... the flows are estimated at 9600 baud:
+ * a password check is one sequential EEPROM read (about 0.3 ms at 400 kHz),
+ * a new password is two page writes with a write cycle of 5 ms at most each and
+ * a key that changes the screen redraws its 32 characters (about 4 ms each, lcd.c)
+ */
+#define PROF_BUDGETS_US				{5000UL, 1000UL, 5000UL, 150000UL, 50000UL, 70000UL, 2000000UL, 5000UL}
+
+/*
+ * PROF_BEGIN and PROF_END must be used in pairs in the same block,
+ * the time between them in microseconds is added to the row of the region.
+ * PROF_START and PROF_STOP can be in different functions, a PROF_STOP without
+ * a PROF_START before it is ignored. PROF_RECORD adds a time measured by the
+ * caller, its argument isn't evaluated if PROF_ENABLE is FALSE
+ */
+#if(PROF_ENABLE == TRUE)
+#define PROF_BEGIN(region)			uint32 profStart##region = SYSTICK_getCounts()
+#define PROF_END(region)			PROF_record((region), SYSTICK_COUNTS_TO_US(SYSTICK_getCounts() - profStart##region))
+#define PROF_START(region)			PROF_start(region)
+#define PROF_STOP(region)			PROF_stop(region)
+#define PROF_RECORD(region,timeUs)	PROF_record((region), (timeUs))
+#else
+#define PROF_BEGIN(region)
+#define PROF_END(region)
+#define PROF_START(region)
+#define PROF_STOP(region)
+#define PROF_RECORD(region,timeUs)
+#endif
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: PROF_Region
+[Structure Description]: it holds the times of one region in microseconds
+					count : times the region is passed
+					min   : shortest time
+					max   : longest time
+					total : sum of all the times (sticks at its maximum)
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint32 count;
+	uint32 min;
+	uint32 max;
+	uint32 total;
+}PROF_Region;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  PROF_record
+[Description]: add one time to the row of a region, used by PROF_END and PROF_RECORD
+[Args]:
+[in]	uint8 region:
+					the region (PROF_xxx)
+		uint32 timeUs:
+					the time in microseconds
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void PROF_record(uint8 region, uint32 timeUs);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  PROF_getRegion
+[Description]: take a copy of the row of a region
+[Args]:
+[in]	uint8 region:
+					the region (PROF_xxx)
+[out]	PROF_Region * row:
+					pointer to the structure you want to save the row in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void PROF_getRegion(uint8 region, PROF_Region * row);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  PROF_start
+[Description]: keep the start time of a region, used by PROF_START
+[Args]:
+[in]	uint8 region:
+					the region (PROF_xxx)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void PROF_start(uint8 region);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  PROF_stop
+[Description]: add the time since PROF_start to the row of a region, used by PROF_STOP
+[Args]:
+[in]	uint8 region:
+					the region (PROF_xxx)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void PROF_stop(uint8 region);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  PROF_getBudget
+[Description]: get the latency budget of a region (see PROF_BUDGETS_US),
+				it is available even if PROF_ENABLE is FALSE
+[Args]:
+[in]	uint8 region:
+					the region (PROF_xxx)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the budget in microseconds or 0 if the region doesn't exist
+------------------------------------------------------------------*/
+uint32 PROF_getBudget(uint8 region);
+
+
+
+#endif /* PROF_H_ */
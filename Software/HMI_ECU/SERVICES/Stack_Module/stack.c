@@ -0,0 +1,88 @@
+ /******************************************************************************
+ *
+ * Module: Stack
+ *
+ * File Name: stack.c
+ *
+ * Description: Source file for measuring the RAM used by the stack
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "stack.h"
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* linker symbols ... start of .data and end of .bss */
+extern uint8 __data_start;
+extern uint8 _end;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*
+ * it is placed in .init3 so the startup code runs it after the stack pointer and
+ * the zero register are set and before main ... it is never called
+ */
+static void STACK_paint(void) __attribute__((naked, used, section(".init3")));
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  STACK_getUsage
+[Description]: measure the stack high water mark by counting the painted bytes
+				that are still untouched above the end of .bss
+[Args]:
+[in]	-NONE
+[out]	STACK_Usage * usage:
+					pointer to the structure you want to save the usage in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void STACK_getUsage(STACK_Usage * usage)
+{
+	const uint8 * p = &_end;
+
+	/* the stack grows down from RAMEND so the untouched bytes are the lowest ones */
+	while((p <= (const uint8 *)RAMEND) && (*p == STACK_PAINT_BYTE))
+	{
+		p++;
+	}
+
+	usage->staticRam = (uint16)(&_end - &__data_start);
+	usage->stackSize = (uint16)(((const uint8 *)RAMEND + 1) - &_end);
+	usage->neverUsed = (uint16)(p - &_end);
+	usage->maxUsed = usage->stackSize - usage->neverUsed;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  STACK_paint
+[Description]: fill the RAM from the end of .bss to RAMEND with STACK_PAINT_BYTE,
+				nothing is on the stack yet when it runs
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void STACK_paint(void)
+{
+	uint8 * p = &_end;
+
+	while(p <= (uint8 *)RAMEND)
+	{
+		*p = STACK_PAINT_BYTE;
+		p++;
+	}
+}
@@ -0,0 +1,25 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: interrupt.h
+ *
+ * Description: avr-libc interrupt macros for the host build
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+/* an ISR is a plain function, the vector names are mapped to functions in io.h */
+#define ISR(vector)					void vector(void)
+
+/* the I-bit of SREG is set and cleared in the register file so the models see it */
+#define sei()						(SREG |= (1<<7))
+#define cli()						(SREG &= (uint8)~(1<<7))
+
+#endif /* HOST_AVR_INTERRUPT_H_ */
@@ -0,0 +1,207 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: io.h
+ *
+ * Description: ATmega32 registers and bits for the host build ... every register is a
+ *              place in the emulated register file (host.h) at its data space address
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+
+#include "host.h"
+
+/*******************************************************************************
+ *                                Registers                                    *
+ *******************************************************************************/
+
+#define SREG		HOST_REGISTER8(0x5F)
+#define SPH			HOST_REGISTER8(0x5E)
+#define SPL			HOST_REGISTER8(0x5D)
+#define OCR0		HOST_REGISTER8(0x5C)
+#define GICR		HOST_REGISTER8(0x5B)
+#define GIFR		HOST_REGISTER8(0x5A)
+#define TIMSK		HOST_REGISTER8(0x59)
+#define TIFR		HOST_REGISTER8(0x58)
+#define TWCR		HOST_REGISTER8(0x56)
+#define MCUCR		HOST_REGISTER8(0x55)
+#define MCUCSR		HOST_REGISTER8(0x54)
+#define TCCR0		HOST_REGISTER8(0x53)
+#define TCNT0		HOST_REGISTER8(0x52)
+#define SFIOR		HOST_REGISTER8(0x50)
+#define TCCR1A		HOST_REGISTER8(0x4F)
+#define TCCR1B		HOST_REGISTER8(0x4E)
+#define TCNT1		HOST_REGISTER16(0x4C)
+#define OCR1A		HOST_REGISTER16(0x4A)
+#define OCR1B		HOST_REGISTER16(0x48)
+#define ICR1		HOST_REGISTER16(0x46)
+#define TCCR2		HOST_REGISTER8(0x45)
+#define TCNT2		HOST_REGISTER8(0x44)
+#define OCR2		HOST_REGISTER8(0x43)
+#define ASSR		HOST_REGISTER8(0x42)
+#define UBRRH		HOST_REGISTER8(0x40)
+#define UCSRC		HOST_REGISTER8(0x40)
+#define PORTA		HOST_REGISTER8(0x3B)
+#define DDRA		HOST_REGISTER8(0x3A)
+#define PINA		HOST_REGISTER8(0x39)
+#define PORTB		HOST_REGISTER8(0x38)
+#define DDRB		HOST_REGISTER8(0x37)
+#define PINB		HOST_REGISTER8(0x36)
+#define PORTC		HOST_REGISTER8(0x35)
+#define DDRC		HOST_REGISTER8(0x34)
+#define PINC		HOST_REGISTER8(0x33)
+#define PORTD		HOST_REGISTER8(0x32)
+#define DDRD		HOST_REGISTER8(0x31)
+#define PIND		HOST_REGISTER8(0x30)
+#define UDR			HOST_REGISTER8(0x2C)
+#define UCSRA		HOST_REGISTER8(0x2B)
+#define UCSRB		HOST_REGISTER8(0x2A)
+#define UBRRL		HOST_REGISTER8(0x29)
+#define ACSR		HOST_REGISTER8(0x28)
+#define ADCSRA		HOST_REGISTER8(0x26)
+#define TWDR		HOST_REGISTER8(0x23)
+#define TWAR		HOST_REGISTER8(0x22)
+#define TWSR		HOST_REGISTER8(0x21)
+#define TWBR		HOST_REGISTER8(0x20)
+
+/*******************************************************************************
+ *                                  Bits                                       *
+ *******************************************************************************/
+
+/* TIMSK & TIFR */
+#define OCIE2		7
+#define TOIE2		6
+#define TICIE1		5
+#define OCIE1A		4
+#define OCIE1B		3
+#define TOIE1		2
+#define OCIE0		1
+#define TOIE0		0
+#define OCF2		7
+#define TOV2		6
+#define ICF1		5
+#define OCF1A		4
+#define OCF1B		3
+#define TOV1		2
+#define OCF0		1
+#define TOV0		0
+
+/* TCCR1A & TCCR1B */
+#define COM1A1		7
+#define COM1A0		6
+#define COM1B1		5
+#define COM1B0		4
+#define FOC1A		3
+#define FOC1B		2
+#define WGM11		1
+#define WGM10		0
+#define ICNC1		7
+#define ICES1		6
+#define WGM13		4
+#define WGM12		3
+#define CS12		2
+#define CS11		1
+#define CS10		0
+
+/* TCCR0 */
+#define FOC0		7
+#define WGM00		6
+#define COM01		5
+#define COM00		4
+#define WGM01		3
+#define CS02		2
+#define CS01		1
+#define CS00		0
+
+/* UCSRA, UCSRB & UCSRC */
+#define RXC			7
+#define TXC			6
+#define UDRE		5
+#define FE			4
+#define DOR			3
+#define PE			2
+#define U2X			1
+#define MPCM		0
+#define RXCIE		7
+#define TXCIE		6
+#define UDRIE		5
+#define RXEN		4
+#define TXEN		3
+#define UCSZ2		2
+#define RXB8		1
+#define TXB8		0
+#define URSEL		7
+#define UMSEL		6
+#define UPM1		5
+#define UPM0		4
+#define USBS		3
+#define UCSZ1		2
+#define UCSZ0		1
+#define UCPOL		0
+
+/* TWCR */
+#define TWINT		7
+#define TWEA		6
+#define TWSTA		5
+#define TWSTO		4
+#define TWWC		3
+#define TWEN		2
+#define TWIE		0
+
+/* PORTC, DDRC & PINC */
+#define PC7			7
+#define PC6			6
+#define PC5			5
+#define PC4			4
+#define PC3			3
+#define PC2			2
+#define PC1			1
+#define PC0			0
+
+/* GICR, MCUCR & MCUCSR */
+#define INT1		7
+#define INT0		6
+#define INT2		5
+#define SE			7
+#define SM2			6
+#define SM1			5
+#define SM0			4
+#define ISC11		3
+#define ISC10		2
+#define ISC01		1
+#define ISC00		0
+#define ISC2		6
+
+/* ADCSRA & ACSR */
+#define ADEN		7
+#define ACD			7
+
+/*******************************************************************************
+ *                           Interrupt Vectors                                 *
+ *******************************************************************************/
+
+/* every vector is a plain function the device models call through HOST_interrupt */
+#define TIMER1_CAPT_vect			HOST_timer1CaptureIsr
+#define TIMER1_COMPA_vect			HOST_timer1CompareAIsr
+#define TIMER1_COMPB_vect			HOST_timer1CompareBIsr
+#define TIMER1_OVF_vect				HOST_timer1OverflowIsr
+#define USART_RXC_vect				HOST_usartRxcIsr
+#define USART_UDRE_vect				HOST_usartUdreIsr
+#define USART_TXC_vect				HOST_usartTxcIsr
+#define TWI_vect					HOST_twiIsr
+
+void TIMER1_CAPT_vect(void);
+void TIMER1_COMPA_vect(void);
+void TIMER1_COMPB_vect(void);
+void TIMER1_OVF_vect(void);
+void USART_RXC_vect(void);
+void USART_UDRE_vect(void);
+void USART_TXC_vect(void);
+void TWI_vect(void);
+
+#endif /* HOST_AVR_IO_H_ */
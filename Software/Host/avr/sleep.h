@@ -0,0 +1,27 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: sleep.h
+ *
+ * Description: avr-libc sleep macros for the host build ... sleeping lets the time pass till an interrupt
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef HOST_AVR_SLEEP_H_
+#define HOST_AVR_SLEEP_H_
+
+#include "host.h"
+
+#define SLEEP_MODE_IDLE				0
+#define SLEEP_MODE_PWR_DOWN			2
+#define SLEEP_MODE_PWR_SAVE			3
+
+#define set_sleep_mode(mode)
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()					HOST_sleep()
+
+#endif /* HOST_AVR_SLEEP_H_ */
@@ -0,0 +1,614 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: host.c
+ *
+ * Description: Source file for the emulated ATmega32 register file used by the host build
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "host.h"
+#include "common_macros.h"
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define HOST_MAX_MODELS				8
+
+/* SREG and its I-bit */
+#define HOST_SREG_ADDRESS			0x5F
+#define HOST_I_BIT					7
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+volatile uint8 HOST_registers[HOST_IO_LAST + 1];
+
+/* the plugged models */
+static const HOST_Model * g_models[HOST_MAX_MODELS];
+static uint8 g_numOfModels = 0;
+
+/* CPU cycles passed, cycles waiting to be passed to the models and whether they are being passed now */
+static uint64 g_cycles = 0;
+static uint32 g_pendingCycles = 0;
+static boolean g_advancing = FALSE;
+
+/* number of the interrupts served ... HOST_sleep waits for it to change */
+static uint32 g_interrupts = 0;
+
+/* the CPU is in HOST_sleep and no interrupt has been served since it has slept */
+static boolean g_sleeping = FALSE;
+
+/* the cycle the interrupt that ended the sleep is served at, the cycles slept and the number of sleeps */
+static uint64 g_wakeCycle = 0;
+static uint64 g_sleptCycles = 0;
+static uint32 g_sleeps = 0;
+
+/*
+ * The watched registers ... every one has its own page (the register is its first byte) kept read only
+ * till the firmware writes it, the SIGSEGV handler then makes it writable and marks it faulted so
+ * the next access or step takes the value to the register file and protects the page again
+ */
+static uint8 g_watchedAddresses[HOST_MAX_WATCHED];
+static uint8 g_numOfWatched = 0;
+static volatile uint8 * g_watchPages = NULL_PTR;
+static uint32 g_pageSize = 0;
+static volatile sig_atomic_t g_watchFaulted[HOST_MAX_WATCHED];
+static boolean g_watchWritten[HOST_MAX_WATCHED];
+static struct sigaction g_oldSegvAction;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void HOST_segvHandler(int signal, siginfo_t * info, void * context);
+static void HOST_collectWrites(void);
+static sint8 HOST_findWatched(uint8 address);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_addModel
+[Description]: plug a device model in, the model structure must stay alive
+[Args]:
+[in]	const HOST_Model * model:
+					pointer to the model hooks
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is added or FALSE if there is no room for more models
+------------------------------------------------------------------*/
+boolean HOST_addModel(const HOST_Model * model)
+{
+	if(g_numOfModels == HOST_MAX_MODELS)
+	{
+		return FALSE;
+	}
+	g_models[g_numOfModels] = model;
+	g_numOfModels++;
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_watchWrites
+[Description]: let a model tell the writes of a register from its reads, needed for the registers
+				that have no spare bit to mark the model value like TWCR (UDR for example) ...
+				the register is given to the firmware in a read only page and the first write
+				to it is caught by the SIGSEGV handler
+[Args]:
+[in]	uint8 address:
+					data space address of the register
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is watched or FALSE if there is no room for more registers
+------------------------------------------------------------------*/
+boolean HOST_watchWrites(uint8 address)
+{
+	struct sigaction action;
+	void * pages;
+
+	if(HOST_findWatched(address) >= 0)
+	{
+		return TRUE;
+	}
+	if(g_numOfWatched == HOST_MAX_WATCHED)
+	{
+		return FALSE;
+	}
+
+	/* the pages and the handler are set up with the first watched register */
+	if(g_watchPages == NULL_PTR)
+	{
+		g_pageSize = (uint32)sysconf(_SC_PAGESIZE);
+		pages = mmap(NULL_PTR, HOST_MAX_WATCHED * g_pageSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(pages == MAP_FAILED)
+		{
+			return FALSE;
+		}
+		g_watchPages = (volatile uint8 *)pages;
+
+		action.sa_sigaction = HOST_segvHandler;
+		action.sa_flags = SA_SIGINFO | SA_NODEFER;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGSEGV, &action, &g_oldSegvAction);
+	}
+
+	g_watchedAddresses[g_numOfWatched] = address;
+	g_watchFaulted[g_numOfWatched] = 0;
+	g_watchWritten[g_numOfWatched] = FALSE;
+	g_numOfWatched++;
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_isWritten
+[Description]: check if the firmware has written a watched register since the last call,
+				the written value is already in the register file
+[Args]:
+[in]	uint8 address:
+					data space address of the register
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is written or FALSE if it is only read (or not watched)
+------------------------------------------------------------------*/
+boolean HOST_isWritten(uint8 address)
+{
+	sint8 watched;
+
+	HOST_collectWrites();
+	watched = HOST_findWatched(address);
+	if((watched < 0) || (g_watchWritten[watched] == FALSE))
+	{
+		return FALSE;
+	}
+	g_watchWritten[watched] = FALSE;
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_access
+[Description]: let the time pass and the models update then give the register to the firmware
+[Args]:
+[in]	uint8 address:
+					data space address of the register
+[out]	-NONE
+[in/out] -NONE
+[Returns]: pointer to the register in the register file
+------------------------------------------------------------------*/
+volatile uint8 * HOST_access(uint8 address)
+{
+	volatile uint8 * page;
+	sint8 watched;
+	uint8 i;
+
+	/* a write since the last access is in the register file before the time passes */
+	HOST_collectWrites();
+	HOST_advance(HOST_CYCLES_PER_ACCESS);
+
+	for(i=0;i<g_numOfModels;i++)
+	{
+		if(g_models[i]->access != NULL_PTR)
+		{
+			g_models[i]->access(address);
+		}
+	}
+
+	watched = HOST_findWatched(address);
+	if(watched < 0)
+	{
+		return &HOST_registers[address];
+	}
+
+	/* the page is opened only if a model has changed the value */
+	page = g_watchPages + (uint32)watched * g_pageSize;
+	if(*page != HOST_registers[address])
+	{
+		mprotect((void *)page, g_pageSize, PROT_READ | PROT_WRITE);
+		*page = HOST_registers[address];
+		mprotect((void *)page, g_pageSize, PROT_READ);
+	}
+	return page;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_advance
+[Description]: let a number of CPU cycles pass for all the models,
+				the cycles passed inside an interrupt are added after the current ones
+[Args]:
+[in]	uint32 cycles:
+					the CPU cycles
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_advance(uint32 cycles)
+{
+	uint32 now;
+	uint8 i;
+
+	g_pendingCycles += cycles;
+
+	/* an ISR called by a model is passing its own cycles ... the outer call passes them */
+	if(g_advancing == TRUE)
+	{
+		return;
+	}
+
+	g_advancing = TRUE;
+	while(g_pendingCycles != 0)
+	{
+		now = (g_pendingCycles > HOST_ADVANCE_STEP) ? HOST_ADVANCE_STEP : g_pendingCycles;
+		g_pendingCycles -= now;
+		g_cycles += now;
+
+		/* an ISR served in the last step may have written a watched register */
+		HOST_collectWrites();
+
+		for(i=0;i<g_numOfModels;i++)
+		{
+			if(g_models[i]->advance != NULL_PTR)
+			{
+				g_models[i]->advance(now);
+			}
+		}
+	}
+	g_advancing = FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_sleep
+[Description]: let the time pass till an interrupt is served, used by sleep_cpu
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_sleep(void)
+{
+	uint32 interrupts = g_interrupts;
+	uint64 start = g_cycles;
+
+	g_sleeping = TRUE;
+	while(g_interrupts == interrupts)
+	{
+		HOST_advance(HOST_SLEEP_STEP);
+	}
+	g_sleeping = FALSE;
+
+	/* the ISR that woke the CPU up is awake time */
+	g_sleptCycles += g_wakeCycle - start;
+	g_sleeps++;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_getSleepCycles
+[Description]: get the CPU cycles the firmware is going to sleep for at least, no model
+				raises an interrupt sooner (used by the wire to let the other ECUs run ahead)
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the cycles, 0 if the CPU isn't sleeping or HOST_NO_EVENT if nothing can wake it
+------------------------------------------------------------------*/
+uint32 HOST_getSleepCycles(void)
+{
+	uint32 sleepCycles = HOST_NO_EVENT;
+	uint32 event;
+	uint8 i;
+
+	if(g_sleeping == FALSE)
+	{
+		return 0;
+	}
+
+	for(i=0;i<g_numOfModels;i++)
+	{
+		if(g_models[i]->nextEvent != NULL_PTR)
+		{
+			event = g_models[i]->nextEvent();
+		}
+		else
+		{
+			/* a model that can't tell may raise one now */
+			event = (g_models[i]->advance != NULL_PTR) ? 0 : HOST_NO_EVENT;
+		}
+		if(event < sleepCycles)
+		{
+			sleepCycles = event;
+		}
+	}
+	return sleepCycles;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_getSleptCycles
+[Description]: get the CPU cycles spent in HOST_sleep since the start, the ISRs that
+				ended the sleeps are not counted
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the cycles
+------------------------------------------------------------------*/
+uint64 HOST_getSleptCycles(void)
+{
+	return g_sleptCycles;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_getSleeps
+[Description]: get the times the CPU has slept since the start ... every one ends with a wake-up
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the number of sleeps
+------------------------------------------------------------------*/
+uint32 HOST_getSleeps(void)
+{
+	return g_sleeps;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_interrupt
+[Description]: serve an interrupt like the CPU does, the I-bit is cleared while the ISR runs
+[Args]:
+[in]	void (*isr)(void):
+					the ISR
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is served or FALSE if the interrupts are disabled
+------------------------------------------------------------------*/
+boolean HOST_interrupt(void (*isr)(void))
+{
+	if(BIT_IS_CLEAR(HOST_registers[HOST_SREG_ADDRESS],HOST_I_BIT))
+	{
+		return FALSE;
+	}
+
+	CLEAR_BIT(HOST_registers[HOST_SREG_ADDRESS],HOST_I_BIT);
+	if(g_sleeping == TRUE)
+	{
+		g_wakeCycle = g_cycles;
+		g_sleeping = FALSE;
+	}
+	isr();
+	SET_BIT(HOST_registers[HOST_SREG_ADDRESS],HOST_I_BIT);
+	g_interrupts++;
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_getCycles
+[Description]: get the CPU cycles passed since the start
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the cycles
+------------------------------------------------------------------*/
+uint64 HOST_getCycles(void)
+{
+	return g_cycles;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_segvHandler
+[Description]: open the page of a watched register the firmware is writing, the write is done
+				again when the handler returns ... any other fault goes to the old handler
+[Args]:
+[in]	int signal:
+					SIGSEGV
+		siginfo_t * info:
+					the faulting address
+		void * context:
+					not used
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void HOST_segvHandler(int signal, siginfo_t * info, void * context)
+{
+	uint8 * fault = (uint8 *)info->si_addr;
+	uint8 * pages = (uint8 *)g_watchPages;
+	uint32 watched;
+
+	(void)signal;
+	(void)context;
+
+	if((fault >= pages) && (fault < (pages + g_numOfWatched * g_pageSize)))
+	{
+		watched = (uint32)(fault - pages) / g_pageSize;
+		mprotect(pages + watched * g_pageSize, g_pageSize, PROT_READ | PROT_WRITE);
+		g_watchFaulted[watched] = 1;
+		return;
+	}
+
+	/* a real crash ... the access faults again with the old handler */
+	sigaction(SIGSEGV, &g_oldSegvAction, NULL_PTR);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_collectWrites
+[Description]: take the values of the written watched registers to the register file
+				and protect their pages again
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void HOST_collectWrites(void)
+{
+	volatile uint8 * page;
+	uint8 i;
+
+	for(i=0;i<g_numOfWatched;i++)
+	{
+		if(g_watchFaulted[i] != 0)
+		{
+			page = g_watchPages + i * g_pageSize;
+			HOST_registers[g_watchedAddresses[i]] = *page;
+			g_watchWritten[i] = TRUE;
+			g_watchFaulted[i] = 0;
+			mprotect((void *)page, g_pageSize, PROT_READ);
+		}
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_findWatched
+[Description]: get the place of a register in the watched registers
+[Args]:
+[in]	uint8 address:
+					data space address of the register
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the place or -1 if it isn't watched
+------------------------------------------------------------------*/
+static sint8 HOST_findWatched(uint8 address)
+{
+	uint8 i;
+
+	for(i=0;i<g_numOfWatched;i++)
+	{
+		if(g_watchedAddresses[i] == address)
+		{
+			return (sint8)i;
+		}
+	}
+	return -1;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  ultoa
+[Description]: convert an unsigned number to a string like avr-libc
+[Args]:
+[in]	unsigned long value:
+					the number
+		int radix:
+					the base (2 -> 36)
+[out]	char * buffer:
+					the string
+[in/out] -NONE
+[Returns]: the buffer
+------------------------------------------------------------------*/
+char * ultoa(unsigned long value, char * buffer, int radix)
+{
+	char digits[33];
+	uint8 count = 0;
+	uint8 i;
+
+	do
+	{
+		digits[count] = "0123456789abcdefghijklmnopqrstuvwxyz"[value % (unsigned long)radix];
+		value /= (unsigned long)radix;
+		count++;
+	}while((value != 0) && (count < sizeof(digits)));
+
+	for(i=0;i<count;i++)
+	{
+		buffer[i] = digits[count - i - 1];
+	}
+	buffer[count] = '\0';
+	return buffer;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  itoa
+[Description]: convert a signed number to a string like avr-libc
+				(the minus sign is used in base 10 only)
+[Args]:
+[in]	int value:
+					the number
+		int radix:
+					the base (2 -> 36)
+[out]	char * buffer:
+					the string
+[in/out] -NONE
+[Returns]: the buffer
+------------------------------------------------------------------*/
+char * itoa(int value, char * buffer, int radix)
+{
+	if((radix == 10) && (value < 0))
+	{
+		buffer[0] = '-';
+		ultoa((unsigned long)(-(long)value), buffer + 1, radix);
+	}
+	else
+	{
+		/* the other bases show the 16-bit pattern of the number like on the AVR */
+		ultoa((unsigned long)(uint16)value, buffer, radix);
+	}
+	return buffer;
+}
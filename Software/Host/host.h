@@ -0,0 +1,254 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: host.h
+ *
+ * Description: Header file for the emulated ATmega32 register file used by the host build
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef HOST_H_
+#define HOST_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* data space address of the last I/O register of the ATmega32 (the first one is 0x20) */
+#define HOST_IO_LAST				0x5F
+
+/* CPU cycles every register access takes ... so the time passes in the polling loops too */
+#define HOST_CYCLES_PER_ACCESS		2
+
+/* CPU cycles passed at a time while sleeping till an interrupt comes */
+#define HOST_SLEEP_STEP				8
+
+/*
+ * Most CPU cycles passed to the models at a time ... a long delay is cut in steps so the
+ * interrupts of the models and the bytes on the emulated wire come on time
+ */
+#define HOST_ADVANCE_STEP			16
+
+/* number of registers whose writes can be watched by the models (HOST_watchWrites) */
+#define HOST_MAX_WATCHED			4
+
+/* the nextEvent of a model that raises no interrupt by itself now */
+#define HOST_NO_EVENT				0xFFFFFFFFUL
+
+/*
+ * Every register access of the firmware goes through HOST_access so the device models can
+ * update the register file before it is read or written ... the 16-bit registers are kept
+ * low byte first like the AVR
+ */
+#define HOST_REGISTER8(address)		(*HOST_access(address))
+#define HOST_REGISTER16(address)	(*(volatile uint16 *)HOST_access(address))
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: HOST_Model
+[Structure Description]: it holds the hooks of a device model, any of them can be NULL_PTR
+					access    : called before the firmware reads or writes a register
+					advance   : called when CPU cycles pass, it can raise interrupts by HOST_interrupt
+					nextEvent : gives the CPU cycles till the model may raise an interrupt by itself
+								or HOST_NO_EVENT ... without it a model with advance may raise one any time
+------------------------------------------------------------------*/
+typedef struct
+{
+	void (*access)(uint8 address);
+	void (*advance)(uint32 cycles);
+	uint32 (*nextEvent)(void);
+}HOST_Model;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* the register file ... the models use it directly so they don't pass through the hooks */
+extern volatile uint8 HOST_registers[HOST_IO_LAST + 1];
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_addModel
+[Description]: plug a device model in, the model structure must stay alive
+[Args]:
+[in]	const HOST_Model * model:
+					pointer to the model hooks
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is added or FALSE if there is no room for more models
+------------------------------------------------------------------*/
+boolean HOST_addModel(const HOST_Model * model);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_watchWrites
+[Description]: let a model tell the writes of a register from its reads, needed for the registers
+				that have no spare bit to mark the model value like TWCR (UDR for example) ...
+				the register is given to the firmware in a read only page and the first write
+				to it is caught by the SIGSEGV handler
+[Args]:
+[in]	uint8 address:
+					data space address of the register
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is watched or FALSE if there is no room for more registers
+------------------------------------------------------------------*/
+boolean HOST_watchWrites(uint8 address);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_isWritten
+[Description]: check if the firmware has written a watched register since the last call,
+				the written value is already in the register file
+[Args]:
+[in]	uint8 address:
+					data space address of the register
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is written or FALSE if it is only read (or not watched)
+------------------------------------------------------------------*/
+boolean HOST_isWritten(uint8 address);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_access
+[Description]: let the time pass and the models update then give the register to the firmware
+[Args]:
+[in]	uint8 address:
+					data space address of the register
+[out]	-NONE
+[in/out] -NONE
+[Returns]: pointer to the register in the register file
+------------------------------------------------------------------*/
+volatile uint8 * HOST_access(uint8 address);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_advance
+[Description]: let a number of CPU cycles pass for all the models,
+				the cycles passed inside an interrupt are added after the current ones
+[Args]:
+[in]	uint32 cycles:
+					the CPU cycles
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_advance(uint32 cycles);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_sleep
+[Description]: let the time pass till an interrupt is served, used by sleep_cpu
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_sleep(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_getSleepCycles
+[Description]: get the CPU cycles the firmware is going to sleep for at least, no model
+				raises an interrupt sooner (used by the wire to let the other ECUs run ahead)
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the cycles, 0 if the CPU isn't sleeping or HOST_NO_EVENT if nothing can wake it
+------------------------------------------------------------------*/
+uint32 HOST_getSleepCycles(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_getSleptCycles
+[Description]: get the CPU cycles spent in HOST_sleep since the start, the ISRs that
+				ended the sleeps are not counted
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the cycles
+------------------------------------------------------------------*/
+uint64 HOST_getSleptCycles(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_getSleeps
+[Description]: get the times the CPU has slept since the start ... every one ends with a wake-up
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the number of sleeps
+------------------------------------------------------------------*/
+uint32 HOST_getSleeps(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_interrupt
+[Description]: serve an interrupt like the CPU does, the I-bit is cleared while the ISR runs
+[Args]:
+[in]	void (*isr)(void):
+					the ISR
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is served or FALSE if the interrupts are disabled
+------------------------------------------------------------------*/
+boolean HOST_interrupt(void (*isr)(void));
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_getCycles
+[Description]: get the CPU cycles passed since the start
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the cycles
+------------------------------------------------------------------*/
+uint64 HOST_getCycles(void);
+
+
+
+
+/* avr-libc conversions missing from the host C library */
+char * itoa(int value, char * buffer, int radix);
+char * ultoa(unsigned long value, char * buffer, int radix);
+
+
+
+#endif /* HOST_H_ */
@@ -0,0 +1,126 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: host_keypad.c
+ *
+ * Description: 4x4 keypad device model for the host build, a pressed button connects its row
+ *              to its column so the column reads low while the row is driven low
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "host.h"
+#include "host_keypad.h"
+#include "common_macros.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define KEYPAD_PINB_ADDRESS			0x36
+#define KEYPAD_DDRB_ADDRESS			0x37
+#define KEYPAD_PORTB_ADDRESS		0x38
+
+#define KEYPAD_FIRST_ROW_PIN		0
+#define KEYPAD_FIRST_COL_PIN		4
+#define KEYPAD_NUM_OF_COLS			4
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* the pressed button or HOST_KEYPAD_RELEASED */
+static uint8 g_button = HOST_KEYPAD_RELEASED;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void KEYPAD_access(uint8 address);
+
+/* the hooks of the model ... plugged in before main */
+static const HOST_Model g_model = {KEYPAD_access, NULL_PTR};
+
+static void KEYPAD_plug(void) __attribute__((constructor));
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  KEYPAD_plug
+[Description]: plug the model in before the firmware starts
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void KEYPAD_plug(void)
+{
+	HOST_addModel(&g_model);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_keypadPress
+[Description]: press one button of the keypad and keep it pressed till another call
+[Args]:
+[in]	uint8 button:
+					the button number (row * 4 + column + 1, 1 -> 16) or HOST_KEYPAD_RELEASED
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_keypadPress(uint8 button)
+{
+	g_button = button;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  KEYPAD_access
+[Description]: show the levels of PORTB in PINB before it is read ... an output pin reads
+				its own level, an input pin is pulled up unless the button connects it
+				to a row driven low
+[Args]:
+[in]	uint8 address:
+					data space address of the register
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void KEYPAD_access(uint8 address)
+{
+	uint8 ddrb;
+	uint8 pins;
+	uint8 row;
+	uint8 col;
+
+	if(address != KEYPAD_PINB_ADDRESS)
+	{
+		return;
+	}
+
+	ddrb = HOST_registers[KEYPAD_DDRB_ADDRESS];
+	pins = (HOST_registers[KEYPAD_PORTB_ADDRESS] & ddrb) | (uint8)~ddrb;
+
+	if(g_button != HOST_KEYPAD_RELEASED)
+	{
+		row = KEYPAD_FIRST_ROW_PIN + (g_button - 1) / KEYPAD_NUM_OF_COLS;
+		col = KEYPAD_FIRST_COL_PIN + (g_button - 1) % KEYPAD_NUM_OF_COLS;
+		if(BIT_IS_CLEAR(pins,row))
+		{
+			CLEAR_BIT(pins,col);
+		}
+	}
+	HOST_registers[KEYPAD_PINB_ADDRESS] = pins;
+}
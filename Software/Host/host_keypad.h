@@ -0,0 +1,44 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: host_keypad.h
+ *
+ * Description: Header file for the 4x4 keypad device model of the host build
+ *              (rows on PB0 -> PB3 and columns on PB4 -> PB7 like the HMI_ECU)
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef HOST_KEYPAD_H_
+#define HOST_KEYPAD_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* HOST_keypadPress value that releases the pressed button */
+#define HOST_KEYPAD_RELEASED		0
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_keypadPress
+[Description]: press one button of the keypad and keep it pressed till another call
+[Args]:
+[in]	uint8 button:
+					the button number (row * 4 + column + 1, 1 -> 16) or HOST_KEYPAD_RELEASED
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_keypadPress(uint8 button);
+
+
+
+#endif /* HOST_KEYPAD_H_ */
@@ -0,0 +1,35 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: host_stack.c
+ *
+ * Description: Stack module for the host build ... the host stack isn't painted so no usage is reported
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "stack.h"
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  STACK_getUsage
+[Description]: report an empty usage, the real one is measured on the target only
+[Args]:
+[in]	-NONE
+[out]	STACK_Usage * usage:
+					pointer to the structure you want to save the usage in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void STACK_getUsage(STACK_Usage * usage)
+{
+	usage->staticRam = 0;
+	usage->stackSize = 0;
+	usage->maxUsed = 0;
+	usage->neverUsed = 0;
+}
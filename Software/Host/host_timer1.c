@@ -0,0 +1,291 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: host_timer1.c
+ *
+ * Description: Timer1 device model for the host build
+ *              (normal and CTC modes, both compare channels, overflow and their interrupts)
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "host.h"
+#include "common_macros.h"
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define TIMER1_TCCR1B_ADDRESS		0x4E
+#define TIMER1_TCNT1_ADDRESS		0x4C
+#define TIMER1_OCR1A_ADDRESS		0x4A
+#define TIMER1_OCR1B_ADDRESS		0x48
+#define TIMER1_TIMSK_ADDRESS		0x59
+#define TIMER1_TIFR_ADDRESS			0x58
+#define TIMER1_FLAGS_MASK			((1<<ICF1)|(1<<OCF1A)|(1<<OCF1B)|(1<<TOV1))
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* CPU cycles per count of every clock select value */
+static const uint16 g_dividers[8] = {0,1,8,64,256,1024,0,0};
+
+/* CPU cycles that haven't made a whole count yet */
+static uint32 g_prescalerCycles = 0;
+
+/*
+ * The flags are kept by the model and copied to TIFR before every access, they are cleared
+ * when their ISR is served ... clearing them by writing 1 isn't emulated as the model can't
+ * tell a write from a read
+ */
+static uint8 g_flags = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void TIMER1_access(uint8 address);
+static void TIMER1_advance(uint32 cycles);
+static uint32 TIMER1_nextEvent(void);
+static uint32 TIMER1_countsTo(uint16 value);
+static void TIMER1_serve(void);
+static uint16 TIMER1_read16(uint8 address);
+
+/* the hooks of the model ... plugged in before main */
+static const HOST_Model g_model = {TIMER1_access, TIMER1_advance, TIMER1_nextEvent};
+
+static void TIMER1_plug(void) __attribute__((constructor));
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  TIMER1_plug
+[Description]: plug the model in before the firmware starts
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void TIMER1_plug(void)
+{
+	HOST_addModel(&g_model);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TIMER1_access
+[Description]: show the flags of the model in TIFR before the firmware uses it
+[Args]:
+[in]	uint8 address:
+					data space address of the register
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void TIMER1_access(uint8 address)
+{
+	if(address == TIMER1_TIFR_ADDRESS)
+	{
+		HOST_registers[TIMER1_TIFR_ADDRESS] = (HOST_registers[TIMER1_TIFR_ADDRESS] & (uint8)~TIMER1_FLAGS_MASK) | g_flags;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TIMER1_advance
+[Description]: count the passed cycles and raise the enabled interrupts
+[Args]:
+[in]	uint32 cycles:
+					the CPU cycles
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void TIMER1_advance(uint32 cycles)
+{
+	uint16 divider = g_dividers[HOST_registers[TIMER1_TCCR1B_ADDRESS] & 0x07];
+	uint16 count;
+
+	/* a flag waiting for the I-bit is served as soon as the interrupts are enabled */
+	TIMER1_serve();
+
+	if(divider == 0)
+	{
+		return;
+	}
+
+	g_prescalerCycles += cycles;
+	while(g_prescalerCycles >= divider)
+	{
+		g_prescalerCycles -= divider;
+		count = TIMER1_read16(TIMER1_TCNT1_ADDRESS);
+
+		if(BIT_IS_SET(HOST_registers[TIMER1_TCCR1B_ADDRESS],WGM12) && (count == TIMER1_read16(TIMER1_OCR1A_ADDRESS)))
+		{
+			/* CTC mode ... cleared on the compare value */
+			count = 0;
+		}
+		else
+		{
+			count++;
+			if(count == 0)
+			{
+				SET_BIT(g_flags,TOV1);
+			}
+		}
+
+		if(count == TIMER1_read16(TIMER1_OCR1A_ADDRESS))
+		{
+			SET_BIT(g_flags,OCF1A);
+		}
+		if(count == TIMER1_read16(TIMER1_OCR1B_ADDRESS))
+		{
+			SET_BIT(g_flags,OCF1B);
+		}
+
+		HOST_registers[TIMER1_TCNT1_ADDRESS] = (uint8)count;
+		HOST_registers[TIMER1_TCNT1_ADDRESS + 1] = (uint8)(count >> 8);
+
+		TIMER1_serve();
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TIMER1_nextEvent
+[Description]: get the CPU cycles till the counter reaches the value of the next enabled
+				interrupt, an enabled flag is served now ... a compare value that is never reached
+				(above OCR1A in the CTC mode) only makes it sooner
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the cycles or HOST_NO_EVENT
+------------------------------------------------------------------*/
+static uint32 TIMER1_nextEvent(void)
+{
+	uint16 divider = g_dividers[HOST_registers[TIMER1_TCCR1B_ADDRESS] & 0x07];
+	uint8 enabled = HOST_registers[TIMER1_TIMSK_ADDRESS];
+	uint32 counts = HOST_NO_EVENT;
+
+	if((g_flags & enabled & TIMER1_FLAGS_MASK) != 0)
+	{
+		return 0;
+	}
+	if(divider == 0)
+	{
+		return HOST_NO_EVENT;
+	}
+
+	if(BIT_IS_SET(enabled,OCIE1A))
+	{
+		counts = TIMER1_countsTo(TIMER1_read16(TIMER1_OCR1A_ADDRESS));
+	}
+	if(BIT_IS_SET(enabled,OCIE1B) && (TIMER1_countsTo(TIMER1_read16(TIMER1_OCR1B_ADDRESS)) < counts))
+	{
+		counts = TIMER1_countsTo(TIMER1_read16(TIMER1_OCR1B_ADDRESS));
+	}
+	if(BIT_IS_SET(enabled,TOIE1) && (TIMER1_countsTo(0) < counts))
+	{
+		counts = TIMER1_countsTo(0);
+	}
+
+	if(counts == HOST_NO_EVENT)
+	{
+		return HOST_NO_EVENT;
+	}
+	return (counts * divider) - g_prescalerCycles;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TIMER1_countsTo
+[Description]: get the counts till TCNT1 is on a value, the value it is on now is given one count
+				(it takes a whole turn or the CTC mode clears the counter before)
+[Args]:
+[in]	uint16 value:
+					the value
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the counts
+------------------------------------------------------------------*/
+static uint32 TIMER1_countsTo(uint16 value)
+{
+	uint16 distance = (uint16)(value - TIMER1_read16(TIMER1_TCNT1_ADDRESS));
+
+	return (distance == 0) ? 1 : distance;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TIMER1_serve
+[Description]: serve the raised flags whose interrupts are enabled, in the AVR vectors order
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void TIMER1_serve(void)
+{
+	uint8 enabled = HOST_registers[TIMER1_TIMSK_ADDRESS];
+
+	/* TIMSK has the enable bit of every flag at the same place as TIFR */
+	if(BIT_IS_SET(g_flags,ICF1) && BIT_IS_SET(enabled,TICIE1) && HOST_interrupt(TIMER1_CAPT_vect))
+	{
+		CLEAR_BIT(g_flags,ICF1);
+	}
+	if(BIT_IS_SET(g_flags,OCF1A) && BIT_IS_SET(enabled,OCIE1A) && HOST_interrupt(TIMER1_COMPA_vect))
+	{
+		CLEAR_BIT(g_flags,OCF1A);
+	}
+	if(BIT_IS_SET(g_flags,OCF1B) && BIT_IS_SET(enabled,OCIE1B) && HOST_interrupt(TIMER1_COMPB_vect))
+	{
+		CLEAR_BIT(g_flags,OCF1B);
+	}
+	if(BIT_IS_SET(g_flags,TOV1) && BIT_IS_SET(enabled,TOIE1) && HOST_interrupt(TIMER1_OVF_vect))
+	{
+		CLEAR_BIT(g_flags,TOV1);
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TIMER1_read16
+[Description]: read a 16-bit register of the register file without the hooks
+[Args]:
+[in]	uint8 address:
+					data space address of the low byte
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the register value
+------------------------------------------------------------------*/
+static uint16 TIMER1_read16(uint8 address)
+{
+	return (uint16)(HOST_registers[address] | (HOST_registers[address + 1] << 8));
+}
@@ -0,0 +1,607 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: host_twi.c
+ *
+ * Description: TWI device model for the host build with a 24C16 EEPROM on the bus
+ *              (master transmitter and receiver, ACK polling, SCL/SDA pins and the fault injection)
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "host.h"
+#include "host_twi.h"
+#include "common_macros.h"
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define TWI_TWCR_ADDRESS			0x56
+#define TWI_TWDR_ADDRESS			0x23
+#define TWI_TWSR_ADDRESS			0x21
+#define TWI_TWBR_ADDRESS			0x20
+#define TWI_PINC_ADDRESS			0x33
+#define TWI_DDRC_ADDRESS			0x34
+#define TWI_PORTC_ADDRESS			0x35
+
+/* the TWI pins on PORTC */
+#define TWI_SCL_PIN					0
+#define TWI_SDA_PIN					1
+
+/*
+ * The model can't tell a read of TWCR from a write, so it sets the reserved bit 1 (always 0 on the AVR)
+ * with TWINT ... the firmware never writes it so the bit is still there if TWCR is only read
+ */
+#define TWI_MODEL_MARK				1
+
+/* the status of the steps */
+#define TWI_START					0x08
+#define TWI_REP_START				0x10
+#define TWI_MT_SLA_W_ACK			0x18
+#define TWI_MT_SLA_W_NACK			0x20
+#define TWI_MT_DATA_ACK				0x28
+#define TWI_MT_DATA_NACK			0x30
+#define TWI_MR_SLA_R_ACK			0x40
+#define TWI_MR_SLA_R_NACK			0x48
+#define TWI_MR_DATA_ACK				0x50
+#define TWI_MR_DATA_NACK			0x58
+
+#define TWI_WRITE_CYCLE_CYCLES		(HOST_TWI_WRITE_CYCLE_MS * (F_CPU / 1000UL))
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[ENUM Name]: TWI_Mode
+[ENUM Description]: what the EEPROM does with the next byte
+------------------------------------------------------------------*/
+typedef enum
+{
+	TWI_IDLE,TWI_WRITE,TWI_READ
+}TWI_Mode;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* the EEPROM ... the page bytes are saved at the STOP */
+static uint8 g_memory[HOST_TWI_EEPROM_SIZE];
+static uint8 g_page[HOST_TWI_PAGE_SIZE];
+static uint16 g_pageMask = 0;
+static uint16 g_pointer = 0;
+static uint32 g_busyCycles = 0;
+
+/* the bus state of the EEPROM */
+static TWI_Mode g_mode = TWI_IDLE;
+static boolean g_inTransfer = FALSE;
+static boolean g_expectAddress = FALSE;
+static boolean g_gotWordAddress = FALSE;
+static uint8 g_block = 0;
+
+/* the step on the bus, the TWCR value that started it and the cycles left till it is done */
+static boolean g_stepRunning = FALSE;
+static uint8 g_command = 0;
+static uint32 g_stepCycles = 0;
+
+/* the registers the firmware has used since the last advance */
+static boolean g_twcrAccessed = FALSE;
+static boolean g_ddrcAccessed = FALSE;
+static uint8 g_lastDdrc = 0;
+
+/* the TWI has been enabled ... PINC isn't changed for an ECU that doesn't use it */
+static boolean g_used = FALSE;
+
+/* the injected faults */
+static boolean g_present = TRUE;
+static uint8 g_sdaHeldClocks = 0;
+static uint8 g_injectedStatus = HOST_TWI_NO_FAULT;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void TWI_access(uint8 address);
+static void TWI_advance(uint32 cycles);
+static uint32 TWI_nextEvent(void);
+static void TWI_command(uint8 twcr);
+static void TWI_step(uint8 twcr);
+static void TWI_stop(void);
+static void TWI_setStatus(uint8 status);
+static void TWI_updatePins(void);
+static uint32 TWI_getStepCycles(uint8 twcr);
+
+/* the hooks of the model ... plugged in before main */
+static const HOST_Model g_model = {TWI_access, TWI_advance, TWI_nextEvent};
+
+static void TWI_plug(void) __attribute__((constructor));
+
+/* the HMI_ECU has no TWI ISR */
+void TWI_vect(void) __attribute__((weak));
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  TWI_plug
+[Description]: erase the EEPROM and plug the model in before the firmware starts
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void TWI_plug(void)
+{
+	uint16 i;
+
+	for(i=0;i<HOST_TWI_EEPROM_SIZE;i++)
+	{
+		g_memory[i] = 0xFF;
+	}
+	HOST_addModel(&g_model);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TWI_access
+[Description]: note the TWCR and DDRC accesses and show the bus lines in PINC
+[Args]:
+[in]	uint8 address:
+					data space address of the register
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void TWI_access(uint8 address)
+{
+	switch(address)
+	{
+	case TWI_TWCR_ADDRESS:
+		g_twcrAccessed = TRUE;
+		break;
+	case TWI_DDRC_ADDRESS:
+		g_ddrcAccessed = TRUE;
+		break;
+	case TWI_PINC_ADDRESS:
+		TWI_updatePins();
+		break;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TWI_advance
+[Description]: take the values the firmware has written, pass the cycles to the step on
+				the bus and the write cycle then raise the TWI interrupt if it is enabled
+[Args]:
+[in]	uint32 cycles:
+					the CPU cycles
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void TWI_advance(uint32 cycles)
+{
+	uint8 ddrc;
+	uint8 twcr;
+
+	if(g_ddrcAccessed == TRUE)
+	{
+		/* SCL is pulled low by hand ... every clock frees one bit of a held SDA */
+		g_ddrcAccessed = FALSE;
+		ddrc = HOST_registers[TWI_DDRC_ADDRESS];
+		if(BIT_IS_SET(ddrc,TWI_SCL_PIN) && BIT_IS_CLEAR(g_lastDdrc,TWI_SCL_PIN) &&
+				(g_sdaHeldClocks != 0) && (g_sdaHeldClocks != HOST_TWI_HOLD_FOREVER))
+		{
+			g_sdaHeldClocks--;
+		}
+		g_lastDdrc = ddrc;
+	}
+
+	if(g_twcrAccessed == TRUE)
+	{
+		g_twcrAccessed = FALSE;
+		TWI_command(HOST_registers[TWI_TWCR_ADDRESS]);
+	}
+
+	g_busyCycles = (g_busyCycles > cycles) ? (g_busyCycles - cycles) : 0;
+
+	/* nothing moves on the bus while SDA is held low */
+	if((g_stepRunning == TRUE) && (g_sdaHeldClocks == 0))
+	{
+		if(g_stepCycles > cycles)
+		{
+			g_stepCycles -= cycles;
+		}
+		else
+		{
+			g_stepRunning = FALSE;
+			TWI_step(g_command);
+		}
+	}
+
+	twcr = HOST_registers[TWI_TWCR_ADDRESS];
+	if(BIT_IS_SET(twcr,TWINT) && BIT_IS_SET(twcr,TWIE) && (g_stepRunning == FALSE) && (TWI_vect != NULL_PTR))
+	{
+		HOST_interrupt(TWI_vect);
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TWI_nextEvent
+[Description]: get the CPU cycles till the step on the bus ends, a command not taken yet
+				or an enabled TWINT is served now and a held SDA stops the bus
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the cycles or HOST_NO_EVENT
+------------------------------------------------------------------*/
+static uint32 TWI_nextEvent(void)
+{
+	uint8 twcr = HOST_registers[TWI_TWCR_ADDRESS];
+
+	if((g_twcrAccessed == TRUE) || (g_ddrcAccessed == TRUE) ||
+			(BIT_IS_SET(twcr,TWINT) && BIT_IS_SET(twcr,TWIE) && (g_stepRunning == FALSE)))
+	{
+		return 0;
+	}
+	if((g_stepRunning == TRUE) && (g_sdaHeldClocks == 0))
+	{
+		return g_stepCycles;
+	}
+	return HOST_NO_EVENT;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TWI_command
+[Description]: act on a value written to TWCR, writing TWINT starts the next step
+[Args]:
+[in]	uint8 twcr:
+					the TWCR value
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void TWI_command(uint8 twcr)
+{
+	if(BIT_IS_SET(twcr,TWI_MODEL_MARK))
+	{
+		/* only read */
+		return;
+	}
+
+	if(BIT_IS_CLEAR(twcr,TWEN))
+	{
+		/* the TWI is off ... the transfer on the bus is lost */
+		g_stepRunning = FALSE;
+		g_inTransfer = FALSE;
+		g_expectAddress = FALSE;
+		g_mode = TWI_IDLE;
+		g_pageMask = 0;
+		return;
+	}
+	g_used = TRUE;
+
+	if(BIT_IS_CLEAR(twcr,TWINT))
+	{
+		return;
+	}
+
+	/* TWINT is cleared by writing 1 and TWSTO is cleared by the TWI once the STOP is sent */
+	HOST_registers[TWI_TWCR_ADDRESS] = twcr & (uint8)~((1<<TWINT) | (1<<TWSTO));
+
+	if(BIT_IS_SET(twcr,TWSTO))
+	{
+		TWI_stop();
+		if(BIT_IS_CLEAR(twcr,TWSTA))
+		{
+			return;
+		}
+	}
+
+	g_command = twcr;
+	g_stepCycles = TWI_getStepCycles(twcr);
+	g_stepRunning = TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TWI_step
+[Description]: end a step, the EEPROM takes or gives the byte and the status is set
+[Args]:
+[in]	uint8 twcr:
+					the TWCR value that started the step
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void TWI_step(uint8 twcr)
+{
+	uint8 data = HOST_registers[TWI_TWDR_ADDRESS];
+
+	if(g_injectedStatus != HOST_TWI_NO_FAULT)
+	{
+		/* the EEPROM loses the transfer too */
+		TWI_setStatus(g_injectedStatus);
+		g_injectedStatus = HOST_TWI_NO_FAULT;
+		g_inTransfer = FALSE;
+		g_mode = TWI_IDLE;
+		g_pageMask = 0;
+		return;
+	}
+
+	if(BIT_IS_SET(twcr,TWSTA))
+	{
+		TWI_setStatus((g_inTransfer == TRUE) ? TWI_REP_START : TWI_START);
+		g_inTransfer = TRUE;
+		g_expectAddress = TRUE;
+		g_mode = TWI_IDLE;
+		g_pageMask = 0;
+	}
+	else if(g_expectAddress == TRUE)
+	{
+		g_expectAddress = FALSE;
+		if((((data >> 1) & 0x78) != HOST_TWI_EEPROM_ADDRESS) || (g_present == FALSE) || (g_busyCycles != 0))
+		{
+			TWI_setStatus(BIT_IS_SET(data,0) ? TWI_MR_SLA_R_NACK : TWI_MT_SLA_W_NACK);
+			g_mode = TWI_IDLE;
+		}
+		else if(BIT_IS_SET(data,0))
+		{
+			TWI_setStatus(TWI_MR_SLA_R_ACK);
+			g_mode = TWI_READ;
+		}
+		else
+		{
+			TWI_setStatus(TWI_MT_SLA_W_ACK);
+			g_mode = TWI_WRITE;
+			g_gotWordAddress = FALSE;
+			g_block = (data >> 1) & 0x07;
+		}
+	}
+	else if(g_mode == TWI_WRITE)
+	{
+		if(g_gotWordAddress == FALSE)
+		{
+			g_pointer = (uint16)(((uint16)g_block << 8) | data);
+			g_gotWordAddress = TRUE;
+		}
+		else
+		{
+			/* the bytes roll over inside the page */
+			g_page[g_pointer % HOST_TWI_PAGE_SIZE] = data;
+			g_pageMask |= (uint16)(1 << (g_pointer % HOST_TWI_PAGE_SIZE));
+			g_pointer = (g_pointer & (uint16)~(HOST_TWI_PAGE_SIZE - 1)) | ((g_pointer + 1) % HOST_TWI_PAGE_SIZE);
+		}
+		TWI_setStatus(TWI_MT_DATA_ACK);
+	}
+	else if(g_mode == TWI_READ)
+	{
+		/* the sequential read goes on across the blocks */
+		HOST_registers[TWI_TWDR_ADDRESS] = g_memory[g_pointer];
+		g_pointer = (g_pointer + 1) % HOST_TWI_EEPROM_SIZE;
+		TWI_setStatus(BIT_IS_SET(twcr,TWEA) ? TWI_MR_DATA_ACK : TWI_MR_DATA_NACK);
+	}
+	else
+	{
+		/* nobody is addressed */
+		TWI_setStatus(TWI_MT_DATA_NACK);
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TWI_stop
+[Description]: end the transfer, a written page is saved and the write cycle starts
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void TWI_stop(void)
+{
+	uint16 base = g_pointer & (uint16)~(HOST_TWI_PAGE_SIZE - 1);
+	uint8 i;
+
+	if((g_mode == TWI_WRITE) && (g_pageMask != 0))
+	{
+		for(i=0;i<HOST_TWI_PAGE_SIZE;i++)
+		{
+			if(BIT_IS_SET(g_pageMask,i))
+			{
+				g_memory[base + i] = g_page[i];
+			}
+		}
+		g_busyCycles = TWI_WRITE_CYCLE_CYCLES;
+	}
+	g_pageMask = 0;
+	g_inTransfer = FALSE;
+	g_expectAddress = FALSE;
+	g_mode = TWI_IDLE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TWI_setStatus
+[Description]: put the status in TWSR and set TWINT
+[Args]:
+[in]	uint8 status:
+					the status
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void TWI_setStatus(uint8 status)
+{
+	/* the prescaler bits are kept */
+	HOST_registers[TWI_TWSR_ADDRESS] = (HOST_registers[TWI_TWSR_ADDRESS] & 0x03) | status;
+	HOST_registers[TWI_TWCR_ADDRESS] |= (1<<TWINT) | (1<<TWI_MODEL_MARK);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TWI_updatePins
+[Description]: show the bus lines in PINC, a line is low if its pin pulls it low
+				(output with PORT bit 0) or SDA is held by the EEPROM
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void TWI_updatePins(void)
+{
+	uint8 ddrc = HOST_registers[TWI_DDRC_ADDRESS];
+	uint8 portc = HOST_registers[TWI_PORTC_ADDRESS];
+	uint8 pinc = HOST_registers[TWI_PINC_ADDRESS] | (1<<TWI_SCL_PIN) | (1<<TWI_SDA_PIN);
+
+	if(g_used == FALSE)
+	{
+		return;
+	}
+
+	if(BIT_IS_SET(ddrc,TWI_SCL_PIN) && BIT_IS_CLEAR(portc,TWI_SCL_PIN))
+	{
+		CLEAR_BIT(pinc,TWI_SCL_PIN);
+	}
+	if((BIT_IS_SET(ddrc,TWI_SDA_PIN) && BIT_IS_CLEAR(portc,TWI_SDA_PIN)) || (g_sdaHeldClocks != 0))
+	{
+		CLEAR_BIT(pinc,TWI_SDA_PIN);
+	}
+	HOST_registers[TWI_PINC_ADDRESS] = pinc;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  TWI_getStepCycles
+[Description]: get the CPU cycles a step takes at the bit rate of TWBR and TWSR
+				(a START is one bit, a byte is 8 bits and the ACK)
+[Args]:
+[in]	uint8 twcr:
+					the TWCR value that starts the step
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the cycles
+------------------------------------------------------------------*/
+static uint32 TWI_getStepCycles(uint8 twcr)
+{
+	uint32 bitCycles = 16UL + (2UL * HOST_registers[TWI_TWBR_ADDRESS] * (1UL << (2 * (HOST_registers[TWI_TWSR_ADDRESS] & 0x03))));
+
+	return BIT_IS_SET(twcr,TWSTA) ? bitCycles : (9UL * bitCycles);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_twiGetMemory
+[Description]: get the EEPROM memory so a test can check it or corrupt it
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: pointer to the HOST_TWI_EEPROM_SIZE bytes of the EEPROM (erased to 0xFF at the start)
+------------------------------------------------------------------*/
+uint8 * HOST_twiGetMemory(void)
+{
+	return g_memory;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_twiSetPresent
+[Description]: connect or disconnect the EEPROM, a disconnected EEPROM doesn't acknowledge its address
+[Args]:
+[in]	boolean present:
+					TRUE to connect it, FALSE to disconnect it
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_twiSetPresent(boolean present)
+{
+	g_present = present;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_twiHoldSda
+[Description]: make the EEPROM hold SDA low like a slave reset in the middle of a byte,
+				no START or byte is done on the bus till SDA is released ... it is released
+				after SCL is clocked by hand (through DDRC) a number of times
+[Args]:
+[in]	uint8 clocks:
+					the clocks needed to release SDA, 0 releases it now and
+					HOST_TWI_HOLD_FOREVER never releases it
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_twiHoldSda(uint8 clocks)
+{
+	g_sdaHeldClocks = clocks;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_twiInjectStatus
+[Description]: end the next step on the bus with a status instead of the right one
+				(I2C_BUS_ERROR or I2C_ARBITRATION_LOST for example), it is used once
+[Args]:
+[in]	uint8 status:
+					the TWSR status or HOST_TWI_NO_FAULT to cancel it
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_twiInjectStatus(uint8 status)
+{
+	g_injectedStatus = status;
+}
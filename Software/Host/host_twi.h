@@ -0,0 +1,103 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: host_twi.h
+ *
+ * Description: Header file for the TWI and 24C16 EEPROM device model of the host build,
+ *              a test driver uses it to look at the EEPROM and to inject the bus faults
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef HOST_TWI_H_
+#define HOST_TWI_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* 24C16 ... 8 blocks of 256 bytes at the addresses 0x50 -> 0x57 */
+#define HOST_TWI_EEPROM_ADDRESS		0x50
+#define HOST_TWI_EEPROM_SIZE		2048
+#define HOST_TWI_PAGE_SIZE			16
+
+/* the EEPROM doesn't acknowledge its address while it saves a page */
+#define HOST_TWI_WRITE_CYCLE_MS		5
+
+/* HOST_twiHoldSda value that never releases SDA */
+#define HOST_TWI_HOLD_FOREVER		0xFF
+
+/* HOST_twiInjectStatus value that injects nothing */
+#define HOST_TWI_NO_FAULT			0xFF
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_twiGetMemory
+[Description]: get the EEPROM memory so a test can check it or corrupt it
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: pointer to the HOST_TWI_EEPROM_SIZE bytes of the EEPROM (erased to 0xFF at the start)
+------------------------------------------------------------------*/
+uint8 * HOST_twiGetMemory(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_twiSetPresent
+[Description]: connect or disconnect the EEPROM, a disconnected EEPROM doesn't acknowledge its address
+[Args]:
+[in]	boolean present:
+					TRUE to connect it, FALSE to disconnect it
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_twiSetPresent(boolean present);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_twiHoldSda
+[Description]: make the EEPROM hold SDA low like a slave reset in the middle of a byte,
+				no START or byte is done on the bus till SDA is released ... it is released
+				after SCL is clocked by hand (through DDRC) a number of times
+[Args]:
+[in]	uint8 clocks:
+					the clocks needed to release SDA, 0 releases it now and
+					HOST_TWI_HOLD_FOREVER never releases it
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_twiHoldSda(uint8 clocks);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_twiInjectStatus
+[Description]: end the next step on the bus with a status instead of the right one
+				(I2C_BUS_ERROR or I2C_ARBITRATION_LOST for example), it is used once
+[Args]:
+[in]	uint8 status:
+					the TWSR status or HOST_TWI_NO_FAULT to cancel it
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_twiInjectStatus(uint8 status);
+
+
+
+#endif /* HOST_TWI_H_ */
@@ -0,0 +1,612 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: host_uart.c
+ *
+ * Description: USART device model for the host build (frame formats, baud rates with U2X,
+ *              the Tx holding and shift registers, the 2-byte Rx FIFO, FE/DOR/PE, the multi-processor
+ *              mode and the RXC/UDRE/TXC interrupts)
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "host.h"
+#include "host_uart.h"
+#include "common_macros.h"
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define UART_UDR_ADDRESS			0x2C
+#define UART_UCSRA_ADDRESS			0x2B
+#define UART_UCSRB_ADDRESS			0x2A
+#define UART_UBRRL_ADDRESS			0x29
+#define UART_UCSRC_ADDRESS			0x40
+
+/* the bits of UCSRA the firmware sets, the others are flags of the model */
+#define UART_UCSRA_CONTROL_MASK		((1<<U2X) | (1<<MPCM))
+
+/* UCSRC after a reset ... 8 data bits, no parity and one stop bit */
+#define UART_UCSRC_RESET			((1<<URSEL) | (1<<UCSZ1) | (1<<UCSZ0))
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: UART_Received
+[Structure Description]: one byte in the receive FIFO with its flags
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint16 data;
+	uint8 flags;
+}UART_Received;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* the parts of UCSRA, UCSRC and UBRRH the firmware has written */
+static uint8 g_control = 0;
+static uint8 g_ucsrc = UART_UCSRC_RESET;
+static uint8 g_ubrrh = 0;
+
+/* the Tx holding register (UDR) and the shift register */
+static boolean g_holdingFull = FALSE;
+static uint8 g_holding = 0;
+static boolean g_shifting = FALSE;
+static uint64 g_shiftEnd = 0;
+static boolean g_txComplete = FALSE;
+
+/* the receive FIFO, its first byte is the one in UDR */
+static UART_Received g_fifo[HOST_UART_RX_FIFO_SIZE];
+static uint8 g_fifoCount = 0;
+
+/* the frames on the Rx line not received yet, in the order of their reception time */
+static HOST_UartFrame g_pending[HOST_UART_MAX_PENDING];
+static uint8 g_pendingCount = 0;
+static uint32 g_lateFrames = 0;
+
+/* UDR was used since the last advance ... a read takes the byte out of the FIFO */
+static boolean g_udrAccessed = FALSE;
+
+/* the wire the Tx line is connected to */
+static void (*g_line)(const HOST_UartFrame * frame) = NULL_PTR;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void UART_access(uint8 address);
+static void UART_advance(uint32 cycles);
+static uint32 UART_nextEvent(void);
+static void UART_takeWrites(void);
+static void UART_startShift(uint64 start);
+static void UART_receive(const HOST_UartFrame * frame);
+static void UART_serve(void);
+static void UART_fillFrame(HOST_UartFrame * frame);
+
+/* the hooks of the model ... plugged in before main */
+static const HOST_Model g_model = {UART_access, UART_advance, UART_nextEvent};
+
+static void UART_plug(void) __attribute__((constructor));
+
+/* a test driver may not have the UART driver and the TXC ISR isn't used */
+void USART_RXC_vect(void) __attribute__((weak));
+void USART_UDRE_vect(void) __attribute__((weak));
+void USART_TXC_vect(void) __attribute__((weak));
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_plug
+[Description]: watch the registers that have no spare bit to tell a write from a read
+				and plug the model in before the firmware starts
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_plug(void)
+{
+	HOST_watchWrites(UART_UDR_ADDRESS);
+	HOST_watchWrites(UART_UCSRA_ADDRESS);
+	HOST_watchWrites(UART_UCSRC_ADDRESS);
+	HOST_registers[UART_UCSRA_ADDRESS] = (1<<UDRE);
+	HOST_registers[UART_UCSRC_ADDRESS] = UART_UCSRC_RESET;
+	HOST_addModel(&g_model);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_uartSetLine
+[Description]: give the frames the USART puts on the Tx line to a function (the wire),
+				without one they are sent to nowhere
+[Args]:
+[in]	void (*send)(const HOST_UartFrame * frame):
+					the function or NULL_PTR
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_uartSetLine(void (*send)(const HOST_UartFrame * frame))
+{
+	g_line = send;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_uartDeliver
+[Description]: put a frame of another device on the Rx line, it is received
+				HOST_UART_RX_CYCLES after its start with the settings of the USART then
+[Args]:
+[in]	const HOST_UartFrame * frame:
+					pointer to the frame
+[out]	-NONE
+[in/out] -NONE
+[Returns]: FALSE if there are HOST_UART_MAX_PENDING frames not received yet, TRUE otherwise
+------------------------------------------------------------------*/
+boolean HOST_uartDeliver(const HOST_UartFrame * frame)
+{
+	uint64 reception = frame->start + HOST_UART_RX_CYCLES(frame);
+	uint8 i;
+
+	if(g_pendingCount == HOST_UART_MAX_PENDING)
+	{
+		return FALSE;
+	}
+	if(reception < HOST_getCycles())
+	{
+		g_lateFrames++;
+	}
+
+	/* keep them in the order of their reception time */
+	i = g_pendingCount;
+	while((i > 0) && ((g_pending[i - 1].start + HOST_UART_RX_CYCLES(&g_pending[i - 1])) > reception))
+	{
+		g_pending[i] = g_pending[i - 1];
+		i--;
+	}
+	g_pending[i] = *frame;
+	g_pendingCount++;
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_uartGetRxCycles
+[Description]: get the CPU cycles from the start of a frame sent with the current settings
+				till it is received, no frame of this device can reach another one sooner
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the cycles
+------------------------------------------------------------------*/
+uint32 HOST_uartGetRxCycles(void)
+{
+	HOST_UartFrame frame;
+
+	UART_fillFrame(&frame);
+	return HOST_UART_RX_CYCLES(&frame);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_uartGetLateFrames
+[Description]: get how many frames were delivered after the time they should have been received,
+				they are received at once ... a late frame means the wire let the time run too far
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the number of late frames
+------------------------------------------------------------------*/
+uint32 HOST_uartGetLateFrames(void)
+{
+	return g_lateFrames;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_access
+[Description]: take the last writes then show the flags and the received byte in the registers
+[Args]:
+[in]	uint8 address:
+					data space address of the register
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_access(uint8 address)
+{
+	UART_takeWrites();
+
+	switch(address)
+	{
+	case UART_UDR_ADDRESS:
+		g_udrAccessed = TRUE;
+		if(g_fifoCount != 0)
+		{
+			HOST_registers[UART_UDR_ADDRESS] = (uint8)g_fifo[0].data;
+		}
+		break;
+
+	case UART_UCSRA_ADDRESS:
+		HOST_registers[UART_UCSRA_ADDRESS] = g_control |
+				((g_fifoCount != 0) ? ((1<<RXC) | g_fifo[0].flags) : 0) |
+				((g_txComplete == TRUE) ? (1<<TXC) : 0) |
+				((g_holdingFull == FALSE) ? (1<<UDRE) : 0);
+		break;
+
+	case UART_UCSRB_ADDRESS:
+		/* RXB8 is the 9th bit of the byte in UDR */
+		if((g_fifoCount != 0) && BIT_IS_SET(g_fifo[0].data,8))
+		{
+			SET_BIT(HOST_registers[UART_UCSRB_ADDRESS],RXB8);
+		}
+		else
+		{
+			CLEAR_BIT(HOST_registers[UART_UCSRB_ADDRESS],RXB8);
+		}
+		break;
+
+	case UART_UCSRC_ADDRESS:
+		/* reading the shared place gives UCSRC (the AVR gives it on the second read in a row) */
+		HOST_registers[UART_UCSRC_ADDRESS] = g_ucsrc;
+		break;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_advance
+[Description]: take the last writes, end the frames on the lines whose time has come
+				and raise the enabled interrupts
+[Args]:
+[in]	uint32 cycles:
+					the CPU cycles
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_advance(uint32 cycles)
+{
+	uint64 now = HOST_getCycles();
+	uint8 i;
+
+	(void)cycles;
+	UART_takeWrites();
+
+	/* the shift register is free ... the next byte starts right after the last stop bit */
+	if((g_shifting == TRUE) && (g_shiftEnd <= now))
+	{
+		g_shifting = FALSE;
+		if(g_holdingFull == TRUE)
+		{
+			UART_startShift(g_shiftEnd);
+		}
+		else
+		{
+			g_txComplete = TRUE;
+		}
+	}
+
+	/* the frames received till now */
+	while((g_pendingCount != 0) && ((g_pending[0].start + HOST_UART_RX_CYCLES(&g_pending[0])) <= now))
+	{
+		UART_receive(&g_pending[0]);
+		g_pendingCount--;
+		for(i=0;i<g_pendingCount;i++)
+		{
+			g_pending[i] = g_pending[i + 1];
+		}
+	}
+
+	UART_serve();
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_nextEvent
+[Description]: get the CPU cycles till the end of the frame being sent or the reception
+				of the next frame on the Rx line, an enabled flag is served now
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the cycles or HOST_NO_EVENT
+------------------------------------------------------------------*/
+static uint32 UART_nextEvent(void)
+{
+	uint64 now = HOST_getCycles();
+	uint64 event = HOST_NO_EVENT;
+	uint64 reception;
+	uint8 ucsrb = HOST_registers[UART_UCSRB_ADDRESS];
+
+	if((g_udrAccessed == TRUE) || ((g_fifoCount != 0) && BIT_IS_SET(ucsrb,RXCIE)) ||
+			((g_holdingFull == FALSE) && BIT_IS_SET(ucsrb,UDRIE)) || ((g_txComplete == TRUE) && BIT_IS_SET(ucsrb,TXCIE)))
+	{
+		return 0;
+	}
+
+	if(g_shifting == TRUE)
+	{
+		event = (g_shiftEnd > now) ? (g_shiftEnd - now) : 0;
+	}
+	if(g_pendingCount != 0)
+	{
+		reception = g_pending[0].start + HOST_UART_RX_CYCLES(&g_pending[0]);
+		reception = (reception > now) ? (reception - now) : 0;
+		if(reception < event)
+		{
+			event = reception;
+		}
+	}
+	return (uint32)event;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_takeWrites
+[Description]: act on the values the firmware has written to UDR, UCSRA and UCSRC/UBRRH,
+				a UDR access that isn't a write is a read that takes the byte out of the FIFO
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_takeWrites(void)
+{
+	uint8 value;
+	uint8 i;
+
+	if(HOST_isWritten(UART_UCSRA_ADDRESS) == TRUE)
+	{
+		value = HOST_registers[UART_UCSRA_ADDRESS];
+		g_control = value & UART_UCSRA_CONTROL_MASK;
+
+		/* TXC is cleared by writing 1 to it */
+		if(BIT_IS_SET(value,TXC))
+		{
+			g_txComplete = FALSE;
+		}
+	}
+
+	if(HOST_isWritten(UART_UCSRC_ADDRESS) == TRUE)
+	{
+		/* URSEL selects the register written at the shared place */
+		value = HOST_registers[UART_UCSRC_ADDRESS];
+		if(BIT_IS_SET(value,URSEL))
+		{
+			g_ucsrc = value;
+		}
+		else
+		{
+			g_ubrrh = value & 0x0F;
+		}
+	}
+
+	if(g_udrAccessed == FALSE)
+	{
+		return;
+	}
+	g_udrAccessed = FALSE;
+
+	if(HOST_isWritten(UART_UDR_ADDRESS) == TRUE)
+	{
+		/* a byte written while the transmitter is off or the holding register is full is lost */
+		if(BIT_IS_SET(HOST_registers[UART_UCSRB_ADDRESS],TXEN) && (g_holdingFull == FALSE))
+		{
+			g_holding = HOST_registers[UART_UDR_ADDRESS];
+			g_holdingFull = TRUE;
+			if(g_shifting == FALSE)
+			{
+				UART_startShift(HOST_getCycles());
+			}
+		}
+	}
+	else if(g_fifoCount != 0)
+	{
+		g_fifoCount--;
+		for(i=0;i<g_fifoCount;i++)
+		{
+			g_fifo[i] = g_fifo[i + 1];
+		}
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_startShift
+[Description]: move the byte of the holding register to the shift register and put its frame on the line,
+				TXB8 is taken now
+[Args]:
+[in]	uint64 start:
+					CPU cycle of the start bit
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_startShift(uint64 start)
+{
+	HOST_UartFrame frame;
+
+	UART_fillFrame(&frame);
+	frame.start = start;
+	frame.data = g_holding;
+	if((frame.dataBits == 9) && BIT_IS_SET(HOST_registers[UART_UCSRB_ADDRESS],TXB8))
+	{
+		SET_BIT(frame.data,8);
+	}
+
+	g_holdingFull = FALSE;
+	g_shifting = TRUE;
+	g_shiftEnd = start + HOST_UART_LINE_CYCLES(&frame);
+
+	if(g_line != NULL_PTR)
+	{
+		g_line(&frame);
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_receive
+[Description]: receive a frame of the Rx line with the current settings ... a different
+				bit time or number of data bits breaks it, a slave in the multi-processor mode
+				ignores the data frames and a full FIFO loses it
+[Args]:
+[in]	const HOST_UartFrame * frame:
+					pointer to the frame
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_receive(const HOST_UartFrame * frame)
+{
+	HOST_UartFrame own;
+	uint32 difference;
+	uint16 data = frame->data;
+	uint8 flags = 0;
+
+	if(BIT_IS_CLEAR(HOST_registers[UART_UCSRB_ADDRESS],RXEN))
+	{
+		return;
+	}
+
+	UART_fillFrame(&own);
+	difference = (frame->bitCycles > own.bitCycles) ? (frame->bitCycles - own.bitCycles) : (own.bitCycles - frame->bitCycles);
+	if((frame->broken == TRUE) || (frame->dataBits != own.dataBits) ||
+			((difference * 100) > ((uint32)own.bitCycles * HOST_UART_TOLERANCE_PERCENT)))
+	{
+		/* the bits are sampled at the wrong places ... the byte is garbage and the stop bit is missed */
+		data = (uint16)~data;
+		SET_BIT(flags,FE);
+	}
+	else if((own.parity != 0) && (frame->parity != own.parity))
+	{
+		SET_BIT(flags,PE);
+	}
+	data &= (uint16)((1 << own.dataBits) - 1);
+
+	/* the multi-processor mode takes the address frames only (9th bit = 1) */
+	if(BIT_IS_SET(g_control,MPCM) && (own.dataBits == 9) && BIT_IS_CLEAR(data,8))
+	{
+		return;
+	}
+
+	if(g_fifoCount == HOST_UART_RX_FIFO_SIZE)
+	{
+		/* the new byte is lost ... DOR is seen with the last byte in the FIFO */
+		SET_BIT(g_fifo[HOST_UART_RX_FIFO_SIZE - 1].flags,DOR);
+		return;
+	}
+	g_fifo[g_fifoCount].data = data;
+	g_fifo[g_fifoCount].flags = flags;
+	g_fifoCount++;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_serve
+[Description]: serve the enabled interrupts in the AVR vectors order, they are raised as long as
+				their flags are set ... the writes of an ISR are taken right after it
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_serve(void)
+{
+	if((g_fifoCount != 0) && BIT_IS_SET(HOST_registers[UART_UCSRB_ADDRESS],RXCIE) &&
+			(USART_RXC_vect != NULL_PTR) && (HOST_interrupt(USART_RXC_vect) == TRUE))
+	{
+		UART_takeWrites();
+	}
+
+	if((g_holdingFull == FALSE) && BIT_IS_SET(HOST_registers[UART_UCSRB_ADDRESS],UDRIE) &&
+			(USART_UDRE_vect != NULL_PTR) && (HOST_interrupt(USART_UDRE_vect) == TRUE))
+	{
+		UART_takeWrites();
+	}
+
+	/* TXC is cleared when its ISR is served */
+	if((g_txComplete == TRUE) && BIT_IS_SET(HOST_registers[UART_UCSRB_ADDRESS],TXCIE) &&
+			(USART_TXC_vect != NULL_PTR) && (HOST_interrupt(USART_TXC_vect) == TRUE))
+	{
+		g_txComplete = FALSE;
+		UART_takeWrites();
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  UART_fillFrame
+[Description]: fill the format of a frame from the current settings (UBRR, U2X and UCSRC/UCSZ2)
+[Args]:
+[in]	-NONE
+[out]	HOST_UartFrame * frame:
+					pointer to the frame
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void UART_fillFrame(HOST_UartFrame * frame)
+{
+	uint16 ubrr = (uint16)(((uint16)g_ubrrh << 8) | HOST_registers[UART_UBRRL_ADDRESS]);
+	uint8 size = ((g_ucsrc >> UCSZ0) & 0x03) | (BIT_IS_SET(HOST_registers[UART_UCSRB_ADDRESS],UCSZ2) ? 0x04 : 0);
+
+	frame->start = 0;
+	frame->data = 0;
+	frame->bitCycles = (uint16)((BIT_IS_SET(g_control,U2X) ? 8 : 16) * (ubrr + 1));
+	frame->dataBits = (size == 7) ? 9 : ((size <= 3) ? (5 + size) : 8);
+	frame->parity = (g_ucsrc >> UPM0) & 0x03;
+	frame->stopBits = BIT_IS_SET(g_ucsrc,USBS) ? 2 : 1;
+	frame->broken = FALSE;
+}
@@ -0,0 +1,135 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: host_uart.h
+ *
+ * Description: Header file for the USART device model of the host build, the frames put on
+ *              the Tx line are given to the wire (host_wire.h) and the frames of the other
+ *              devices are delivered by it
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef HOST_UART_H_
+#define HOST_UART_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Most difference between the bit times of the sender and the receiver in percent,
+ * a bigger one is received with a framing error (the AVR receiver tolerates about 4%)
+ */
+#define HOST_UART_TOLERANCE_PERCENT	4
+
+/* depth of the receive FIFO of the USART (UDR and the one behind it) */
+#define HOST_UART_RX_FIFO_SIZE		2
+
+/* frames delivered and not received yet */
+#define HOST_UART_MAX_PENDING		16
+
+/* the frame is received in the middle of its first stop bit */
+#define HOST_UART_RX_CYCLES(frame)	((uint32)(frame)->bitCycles * (1 + (frame)->dataBits + (((frame)->parity != 0) ? 1 : 0)) + \
+									((frame)->bitCycles / 2))
+
+/* the line is busy till the end of the last stop bit */
+#define HOST_UART_LINE_CYCLES(frame)	((uint32)(frame)->bitCycles * (1 + (frame)->dataBits + (((frame)->parity != 0) ? 1 : 0) + \
+									(frame)->stopBits))
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: HOST_UartFrame
+[Structure Description]: one frame on the line
+					start     : CPU cycle of the start bit (in the time of the sender)
+					data      : the data bits, the 9th bit is bit 8
+					bitCycles : CPU cycles of one bit
+					dataBits  : 5 -> 9
+					parity    : the UPM bits (0 none, 2 even, 3 odd)
+					stopBits  : 1 or 2
+					broken    : the line was taken by another sender so it is received with a framing error
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint64 start;
+	uint16 data;
+	uint16 bitCycles;
+	uint8 dataBits;
+	uint8 parity;
+	uint8 stopBits;
+	boolean broken;
+}HOST_UartFrame;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_uartSetLine
+[Description]: give the frames the USART puts on the Tx line to a function (the wire),
+				without one they are sent to nowhere
+[Args]:
+[in]	void (*send)(const HOST_UartFrame * frame):
+					the function or NULL_PTR
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void HOST_uartSetLine(void (*send)(const HOST_UartFrame * frame));
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_uartDeliver
+[Description]: put a frame of another device on the Rx line, it is received
+				HOST_UART_RX_CYCLES after its start with the settings of the USART then
+[Args]:
+[in]	const HOST_UartFrame * frame:
+					pointer to the frame
+[out]	-NONE
+[in/out] -NONE
+[Returns]: FALSE if there are HOST_UART_MAX_PENDING frames not received yet, TRUE otherwise
+------------------------------------------------------------------*/
+boolean HOST_uartDeliver(const HOST_UartFrame * frame);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_uartGetRxCycles
+[Description]: get the CPU cycles from the start of a frame sent with the current settings
+				till it is received, no frame of this device can reach another one sooner
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the cycles
+------------------------------------------------------------------*/
+uint32 HOST_uartGetRxCycles(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  HOST_uartGetLateFrames
+[Description]: get how many frames were delivered after the time they should have been received,
+				they are received at once ... a late frame means the wire let the time run too far
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the number of late frames
+------------------------------------------------------------------*/
+uint32 HOST_uartGetLateFrames(void);
+
+
+
+#endif /* HOST_UART_H_ */
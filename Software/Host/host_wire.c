@@ -0,0 +1,251 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: host_wire.c
+ *
+ * Description: Wire of the host build, the ECU runs till the cycle granted by the coordinator
+ *              then tells it the time it has reached and waits ... the frames of its USART and
+ *              the changes of its ports are sent on the way and the frames of the other ECUs
+ *              and the keypad buttons are taken while waiting
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "host.h"
+#include "host_wire.h"
+#include "host_uart.h"
+#include "host_keypad.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define WIRE_PORTB_ADDRESS			0x38
+#define WIRE_PORTC_ADDRESS			0x35
+#define WIRE_PORTD_ADDRESS			0x32
+#define WIRE_OCR0_ADDRESS			0x5C
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* the socket to the coordinator */
+static int g_socket = -1;
+
+/* the ECU waits for the coordinator once this cycle is reached */
+static uint64 g_grantEnd = 0;
+
+/* the ports last sent to the coordinator */
+static uint8 g_pins[HOST_WIRE_NUM_OF_PINS];
+
+/* the addresses of the ports in the HOST_WIRE_PORTB ... order */
+static const uint8 g_pinAddresses[HOST_WIRE_NUM_OF_PINS] = {WIRE_PORTB_ADDRESS, WIRE_PORTC_ADDRESS, WIRE_PORTD_ADDRESS, WIRE_OCR0_ADDRESS};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void WIRE_advance(uint32 cycles);
+static uint32 WIRE_nextEvent(void);
+static void WIRE_sendFrame(const HOST_UartFrame * frame);
+static void WIRE_wait(void);
+static void WIRE_send(HOST_WireMessage * message);
+
+/* the hooks of the model ... plugged in before main */
+static const HOST_Model g_model = {NULL_PTR, WIRE_advance, WIRE_nextEvent};
+
+static void WIRE_plug(void) __attribute__((constructor));
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  WIRE_plug
+[Description]: connect the wire if the ECU is started by a coordinator
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void WIRE_plug(void)
+{
+	const char * fd = getenv(HOST_WIRE_FD_VARIABLE);
+
+	if(fd == NULL_PTR)
+	{
+		return;
+	}
+	g_socket = atoi(fd);
+	HOST_uartSetLine(WIRE_sendFrame);
+	HOST_addModel(&g_model);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  WIRE_advance
+[Description]: send the changed ports and wait for the coordinator at the end of the granted time
+[Args]:
+[in]	uint32 cycles:
+					the CPU cycles
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void WIRE_advance(uint32 cycles)
+{
+	HOST_WireMessage message;
+	boolean changed = FALSE;
+	uint8 i;
+
+	(void)cycles;
+
+	for(i=0;i<HOST_WIRE_NUM_OF_PINS;i++)
+	{
+		if(HOST_registers[g_pinAddresses[i]] != g_pins[i])
+		{
+			g_pins[i] = HOST_registers[g_pinAddresses[i]];
+			changed = TRUE;
+		}
+	}
+	if(changed == TRUE)
+	{
+		message.type = HOST_WIRE_PINS;
+		message.cycles = HOST_getCycles();
+		memcpy(message.pins, g_pins, sizeof(g_pins));
+		WIRE_send(&message);
+	}
+
+	if(HOST_getCycles() >= g_grantEnd)
+	{
+		WIRE_wait();
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  WIRE_nextEvent
+[Description]: the wire raises no interrupt, the frames and the keys it takes
+				come at the end of the granted time
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: HOST_NO_EVENT
+------------------------------------------------------------------*/
+static uint32 WIRE_nextEvent(void)
+{
+	return HOST_NO_EVENT;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  WIRE_sendFrame
+[Description]: give a frame the USART puts on the line to the coordinator
+[Args]:
+[in]	const HOST_UartFrame * frame:
+					pointer to the frame
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void WIRE_sendFrame(const HOST_UartFrame * frame)
+{
+	HOST_WireMessage message;
+
+	message.type = HOST_WIRE_FRAME;
+	message.cycles = HOST_getCycles();
+	message.frame = *frame;
+	WIRE_send(&message);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  WIRE_wait
+[Description]: tell the coordinator the reached time and take its messages till the next GRANT,
+				the program ends with QUIT or if the coordinator is gone
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void WIRE_wait(void)
+{
+	HOST_WireMessage message;
+
+	message.type = HOST_WIRE_DONE;
+	message.cycles = HOST_getCycles();
+	message.sleepCycles = HOST_getSleepCycles();
+	message.rxCycles = HOST_uartGetRxCycles();
+	message.lateFrames = HOST_uartGetLateFrames();
+	message.sleptCycles = HOST_getSleptCycles();
+	message.sleeps = HOST_getSleeps();
+	WIRE_send(&message);
+
+	while(1)
+	{
+		if(recv(g_socket, &message, sizeof(message), 0) != sizeof(message))
+		{
+			exit(0);
+		}
+
+		switch(message.type)
+		{
+		case HOST_WIRE_GRANT:
+			g_grantEnd = message.cycles;
+			return;
+
+		case HOST_WIRE_FRAME:
+			HOST_uartDeliver(&message.frame);
+			break;
+
+		case HOST_WIRE_KEY:
+			HOST_keypadPress(message.key);
+			break;
+
+		default:
+			exit(0);
+		}
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  WIRE_send
+[Description]: send one message to the coordinator, the program ends if it is gone
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] HOST_WireMessage * message:
+					pointer to the message
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void WIRE_send(HOST_WireMessage * message)
+{
+	if(send(g_socket, message, sizeof(*message), MSG_NOSIGNAL) != sizeof(*message))
+	{
+		exit(0);
+	}
+}
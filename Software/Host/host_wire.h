@@ -0,0 +1,82 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: host_wire.h
+ *
+ * Description: Header file for the wire of the host build, it connects an ECU program to a
+ *              coordinator that runs several ECUs in lockstep on one emulated UART bus
+ *              (Tests/Cosim) ... the ECU runs alone if HOST_WIRE_FD isn't set
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef HOST_WIRE_H_
+#define HOST_WIRE_H_
+
+#include "std_types.h"
+#include "host_uart.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* the environment variable with the number of the socket (SOCK_SEQPACKET) to the coordinator */
+#define HOST_WIRE_FD_VARIABLE		"HOST_WIRE_FD"
+
+/* the pins of the ECU sent to the coordinator */
+#define HOST_WIRE_PORTB				0
+#define HOST_WIRE_PORTC				1
+#define HOST_WIRE_PORTD				2
+#define HOST_WIRE_OCR0				3
+#define HOST_WIRE_NUM_OF_PINS		4
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[ENUM Name]: HOST_WireType
+[ENUM Description]: the messages between the ECU and the coordinator
+					GRANT : (coordinator) run till the cycle
+					DONE  : (ECU) the granted cycle is reached, the ECU waits for the next GRANT
+					FRAME : a frame put on the line by the ECU or delivered to it
+					KEY   : (coordinator) press or release a button of the keypad
+					PINS  : (ECU) the ports have changed
+					QUIT  : (coordinator) end the program
+------------------------------------------------------------------*/
+typedef enum
+{
+	HOST_WIRE_GRANT,HOST_WIRE_DONE,HOST_WIRE_FRAME,HOST_WIRE_KEY,HOST_WIRE_PINS,HOST_WIRE_QUIT
+}HOST_WireType;
+
+/*------------------------------------------------------------------
+[Structure Name]: HOST_WireMessage
+[Structure Description]: one message on the socket
+					type      : HOST_WireType
+					key       : KEY   -> the button (host_keypad.h)
+					pins      : PINS  -> the ports (HOST_WIRE_PORTB ...)
+					cycles    : GRANT -> the cycle to run till, DONE and PINS -> the cycle of the ECU
+					rxCycles  : DONE  -> HOST_uartGetRxCycles, the lookahead of the ECU
+					sleepCycles: DONE -> HOST_getSleepCycles, no frame is sent before they pass
+					lateFrames: DONE  -> HOST_uartGetLateFrames
+					sleptCycles: DONE -> HOST_getSleptCycles
+					sleeps    : DONE  -> HOST_getSleeps
+					frame     : FRAME -> the frame
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint8 type;
+	uint8 key;
+	uint8 pins[HOST_WIRE_NUM_OF_PINS];
+	uint64 cycles;
+	uint32 rxCycles;
+	uint32 sleepCycles;
+	uint32 lateFrames;
+	uint64 sleptCycles;
+	uint32 sleeps;
+	HOST_UartFrame frame;
+}HOST_WireMessage;
+
+#endif /* HOST_WIRE_H_ */
@@ -0,0 +1,21 @@
+ /******************************************************************************
+ *
+ * Module: Host
+ *
+ * File Name: delay.h
+ *
+ * Description: avr-libc delay functions for the host build ... the delay only lets the models' time pass
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef HOST_UTIL_DELAY_H_
+#define HOST_UTIL_DELAY_H_
+
+#include "host.h"
+
+#define _delay_ms(ms)				HOST_advance((uint32)((ms) * (F_CPU / 1000UL)))
+#define _delay_us(us)				HOST_advance((uint32)((us) * (F_CPU / 1000000UL)))
+
+#endif /* HOST_UTIL_DELAY_H_ */
@@ -0,0 +1,110 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: test_bench_drivers.c
+ *
+ * Description: Microbenchmarks of the driver entry points of the Control_ECU on the host build, every
+ *              entry point is called alone and its cycles per call are checked against its budget
+ *              ... the flash they take is reported by makefile.release (sizes)
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "test.h"
+#include "host.h"
+#include "uart.h"
+#include "i2c.h"
+#include "pwm.h"
+#include "systick.h"
+#include "app.h"
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define TEST_CALLS					100
+
+/* the 24C16 model of the host build (write address of its first block) */
+#define TEST_EEPROM_WRITE			0xA0
+
+/* bytes sent at once ... less than UART_TX_BUFFER_SIZE so no call waits for room */
+#define TEST_UART_CALLS				16
+
+/*
+ * the budgets of one call in CPU cycles ... a byte waits for its 9 SCL periods at 400 kHz,
+ * the code that touches no register (compareTwoPasswords) costs nothing on the host so it
+ * isn't benchmarked here, its instructions are timed on the target by the PROF pages
+ */
+#define TEST_I2C_WRITE_BUDGET		200
+#define TEST_UART_SEND_BUDGET		8
+#define TEST_PWM_START_BUDGET		12
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void test_i2c(void);
+static void test_uart(void);
+static void test_pwm(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void)
+{
+	I2C_ConfigType i2cConfig = {FAST_MODE,0b0000001};
+	UART_ConfigType uartConfig = {DISABLE_PARITY,ONE_STOPBIT,EIGHT_DATABITS,500000,UART_INTERRUPT_MODE,UART_MASTER_ADDRESS};
+
+	SREG = (1<<7);
+	SYSTICK_init();
+	I2C_init(&i2cConfig);
+	UART_init(&uartConfig);
+
+	TEST_RUN(test_i2c);
+	TEST_RUN(test_uart);
+	TEST_RUN(test_pwm);
+
+	return TEST_RESULT();
+}
+
+
+
+
+
+/* a data byte written to the EEPROM waits till the TWI has shifted it and taken the ACK */
+static void test_i2c(void)
+{
+	I2C_start();
+	I2C_writeByte(TEST_EEPROM_WRITE);
+	TEST_CHECK(I2C_getStatus() == I2C_MT_SLA_W_ACK);
+
+	TEST_BENCH(I2C_writeByte(0x00), TEST_CALLS, TEST_I2C_WRITE_BUDGET);
+	TEST_CHECK(I2C_getStatus() == I2C_MT_DATA_ACK);
+	I2C_stop();
+}
+
+
+
+
+
+/* a byte is put in the Tx buffer, the UDRE interrupt that takes it is counted too */
+static void test_uart(void)
+{
+	TEST_BENCH(UART_sendByte(0x55), TEST_UART_CALLS, TEST_UART_SEND_BUDGET);
+	UART_flush();
+}
+
+
+
+
+
+/* the timer is set up and the duty cycle is written to OCR0 */
+static void test_pwm(void)
+{
+	TEST_BENCH(PWM_Timer0_Start(50), TEST_CALLS, TEST_PWM_START_BUDGET);
+	TEST_CHECK(OCR0 == 127);
+}
@@ -0,0 +1,180 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: test_cred.c
+ *
+ * Description: Tests of the password store against the 24C16 model of the host build: a password
+ *              saved before the checksum was added, a damaged record and the EEPROM fallback of
+ *              CRED_check when the cache isn't used
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "test.h"
+#include "host_twi.h"
+#include "i2c.h"
+#include "cred.h"
+#include "systick.h"
+#include <avr/io.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* the checksum of TEST_PASSWORD ... the complement of the sum of its digits */
+#define TEST_CHECKSUM				((uint8)~(1 + 2 + 3 + 4 + 5))
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static const uint8 g_password[CRED_PASSWORD_SIZE] = {1, 2, 3, 4, 5};
+static const uint8 g_wrongPassword[CRED_PASSWORD_SIZE] = {5, 4, 3, 2, 1};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void writeRecord(uint8 exist, uint8 checksum);
+static void waitIdle(void);
+
+static void test_oldRecordMigrated(void);
+static void test_damagedRecordKept(void);
+static void test_fallbackChecksChecksum(void);
+static void test_fallbackChecksExistMark(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void)
+{
+	I2C_ConfigType i2cConfig = {FAST_MODE,0b0000001};
+
+	SREG = (1<<7);
+	SYSTICK_init();
+	I2C_init(&i2cConfig);
+
+	TEST_RUN(test_oldRecordMigrated);
+	TEST_RUN(test_damagedRecordKept);
+	TEST_RUN(test_fallbackChecksChecksum);
+	TEST_RUN(test_fallbackChecksExistMark);
+
+	return TEST_RESULT();
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  writeRecord
+[Description]: put a record with g_password straight in the EEPROM memory, no write cycle is started
+[Args]:
+[in]	uint8 exist:
+					the exist byte
+		uint8 checksum:
+					the checksum byte
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void writeRecord(uint8 exist, uint8 checksum)
+{
+	uint8 * memory = HOST_twiGetMemory();
+
+	memory[CRED_EXIST_ADDRESS] = exist;
+	memcpy(&memory[CRED_PASSWORD_ADDRESS], g_password, CRED_PASSWORD_SIZE);
+	memory[CRED_CHECKSUM_ADDRESS] = checksum;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  waitIdle
+[Description]: sleep till all the submitted transfers are done
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void waitIdle(void)
+{
+	while(I2C_isIdle() == FALSE)
+	{
+		SYSTICK_sleepUntil(SYSTICK_getDeadline(1));
+	}
+}
+
+
+
+
+
+/* a password saved with its exist mark but no checksum gets its checksum at the start and is used */
+static void test_oldRecordMigrated(void)
+{
+	writeRecord(CRED_EXIST_MARK, 0xFF);
+
+	CRED_init();
+	waitIdle();
+	TEST_CHECK(HOST_twiGetMemory()[CRED_CHECKSUM_ADDRESS] == TEST_CHECKSUM);
+	TEST_CHECK(CRED_exists() == TRUE);
+	TEST_CHECK(CRED_check(g_password) == TRUE);
+	TEST_CHECK(CRED_check(g_wrongPassword) == FALSE);
+}
+
+
+
+
+
+/* a checksum that is written but wrong isn't replaced and no password is accepted */
+static void test_damagedRecordKept(void)
+{
+	writeRecord(CRED_EXIST_MARK, TEST_CHECKSUM ^ 0x01);
+
+	CRED_init();
+	waitIdle();
+	TEST_CHECK(HOST_twiGetMemory()[CRED_CHECKSUM_ADDRESS] == (TEST_CHECKSUM ^ 0x01));
+	TEST_CHECK(CRED_exists() == TRUE);
+	TEST_CHECK(CRED_check(g_password) == FALSE);
+}
+
+
+
+
+
+/* the check found a damaged checksum so the EEPROM fallback refuses the saved password */
+static void test_fallbackChecksChecksum(void)
+{
+	CRED_init();
+	TEST_CHECK(CRED_save(g_password) == TRUE);
+	TEST_CHECK(CRED_check(g_password) == TRUE);
+
+	HOST_twiGetMemory()[CRED_CHECKSUM_ADDRESS] ^= 0x01;
+	CRED_verify();
+	waitIdle();
+	TEST_CHECK(CRED_check(g_password) == FALSE);
+}
+
+
+
+
+
+/* the check found the exist mark cleared so the EEPROM fallback refuses the password left behind it */
+static void test_fallbackChecksExistMark(void)
+{
+	CRED_init();
+	TEST_CHECK(CRED_save(g_password) == TRUE);
+	TEST_CHECK(CRED_check(g_password) == TRUE);
+
+	HOST_twiGetMemory()[CRED_EXIST_ADDRESS] = 0x00;
+	CRED_verify();
+	waitIdle();
+	TEST_CHECK(CRED_check(g_password) == FALSE);
+}
@@ -0,0 +1,291 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: test_i2c_faults.c
+ *
+ * Description: Fault injection tests of the I2C driver against the 24C16 model of the host build:
+ *              a missing EEPROM, bus errors, a slave holding SDA low and the error counters
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "test.h"
+#include "host_twi.h"
+#include "i2c.h"
+#include "external_eeprom.h"
+#include "cred.h"
+#include "diag.h"
+#include "frame.h"
+#include "systick.h"
+#include <avr/io.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* a block that crosses two pages and two 256-byte blocks of the 24C16 */
+#define TEST_BLOCK_ADDRESS			0x1F9
+#define TEST_BLOCK_SIZE				40
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static uint8 g_pattern[TEST_BLOCK_SIZE];
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void waitMs(uint16 timeMs);
+
+static void test_normalAccess(void);
+static void test_missingDevice(void);
+static void test_busErrors(void);
+static void test_stuckSdaRecovered(void);
+static void test_stuckSdaDuringTransfer(void);
+static void test_stuckSdaBlockingApi(void);
+static void test_stuckCredVerify(void);
+static void test_diagnosticsPage(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void)
+{
+	I2C_ConfigType i2cConfig = {FAST_MODE,0b0000001};
+	uint8 i;
+
+	SREG = (1<<7);
+	SYSTICK_init();
+	I2C_init(&i2cConfig);
+
+	for(i=0;i<TEST_BLOCK_SIZE;i++)
+	{
+		g_pattern[i] = (uint8)(i * 7 + 1);
+	}
+
+	/* the counters are checked as they grow so the order matters */
+	TEST_RUN(test_normalAccess);
+	TEST_RUN(test_missingDevice);
+	TEST_RUN(test_busErrors);
+	TEST_RUN(test_stuckSdaRecovered);
+	TEST_RUN(test_stuckSdaDuringTransfer);
+	TEST_RUN(test_stuckSdaBlockingApi);
+	TEST_RUN(test_stuckCredVerify);
+	TEST_RUN(test_diagnosticsPage);
+
+	return TEST_RESULT();
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  waitMs
+[Description]: let the interrupts run for a while
+[Args]:
+[in]	uint16 timeMs:
+					the time in milliseconds
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void waitMs(uint16 timeMs)
+{
+	uint32 deadline = SYSTICK_getDeadline(timeMs);
+
+	while(SYSTICK_isExpired(deadline) == FALSE)
+	{
+		SYSTICK_sleepUntil(deadline);
+	}
+}
+
+
+
+
+
+/* a block and a byte are written and read back without any error counted */
+static void test_normalAccess(void)
+{
+	uint8 data[TEST_BLOCK_SIZE];
+	uint8 byte = 0;
+	I2C_Statistics stats;
+
+	TEST_CHECK(EEPROM_writeBlock(TEST_BLOCK_ADDRESS, g_pattern, TEST_BLOCK_SIZE) == SUCCESS);
+	TEST_CHECK(EEPROM_readBlock(TEST_BLOCK_ADDRESS, data, TEST_BLOCK_SIZE) == SUCCESS);
+	TEST_CHECK(memcmp(data, g_pattern, TEST_BLOCK_SIZE) == 0);
+	TEST_CHECK(memcmp(HOST_twiGetMemory() + TEST_BLOCK_ADDRESS, g_pattern, TEST_BLOCK_SIZE) == 0);
+
+	TEST_CHECK(EEPROM_writeByte(5, 0x42) == SUCCESS);
+	TEST_CHECK((EEPROM_readByte(5, &byte) == SUCCESS) && (byte == 0x42));
+
+	I2C_getStatistics(&stats);
+	TEST_CHECK((stats.timeouts == 0) && (stats.nacks == 0) && (stats.busErrors == 0) && (stats.recoveries == 0));
+}
+
+
+
+
+
+/* an EEPROM that doesn't acknowledge its address fails the access and counts one NACK */
+static void test_missingDevice(void)
+{
+	uint8 data[4];
+	uint8 byte = 0;
+	I2C_Statistics stats;
+
+	HOST_twiSetPresent(FALSE);
+	TEST_CHECK(EEPROM_readBlock(0, data, sizeof(data)) == ERROR);
+	HOST_twiSetPresent(TRUE);
+
+	I2C_getStatistics(&stats);
+	TEST_CHECK(stats.nacks == 1);
+	TEST_CHECK(stats.timeouts == 0);
+
+	/* the bus is left free for the next access */
+	TEST_CHECK((EEPROM_readByte(5, &byte) == SUCCESS) && (byte == 0x42));
+}
+
+
+
+
+
+/* a bus error and a lost arbitration in the middle of a transfer fail it and are counted */
+static void test_busErrors(void)
+{
+	uint8 data[4];
+	uint8 byte = 0;
+	I2C_Statistics stats;
+
+	HOST_twiInjectStatus(I2C_BUS_ERROR);
+	TEST_CHECK(EEPROM_readBlock(0, data, sizeof(data)) == ERROR);
+
+	HOST_twiInjectStatus(I2C_ARBITRATION_LOST);
+	TEST_CHECK(EEPROM_readBlock(0, data, sizeof(data)) == ERROR);
+
+	I2C_getStatistics(&stats);
+	TEST_CHECK(stats.busErrors == 2);
+	TEST_CHECK((EEPROM_readByte(5, &byte) == SUCCESS) && (byte == 0x42));
+}
+
+
+
+
+
+/* a slave holding SDA low for a few clocks times the step out, the bus is recovered and works again */
+static void test_stuckSdaRecovered(void)
+{
+	uint8 data[TEST_BLOCK_SIZE];
+	uint32 start;
+	I2C_Statistics stats;
+
+	HOST_twiHoldSda(5);
+	start = SYSTICK_getTicks();
+	TEST_CHECK(EEPROM_readBlock(TEST_BLOCK_ADDRESS, data, TEST_BLOCK_SIZE) == ERROR);
+
+	/* the failure is reported after one step timeout, not after the whole EEPROM timeout */
+	TEST_CHECK((SYSTICK_getTicks() - start) <= (2 * I2C_STEP_TIMEOUT_MS));
+
+	I2C_getStatistics(&stats);
+	TEST_CHECK((stats.timeouts == 1) && (stats.recoveries == 1));
+
+	memset(data, 0, sizeof(data));
+	TEST_CHECK(EEPROM_readBlock(TEST_BLOCK_ADDRESS, data, TEST_BLOCK_SIZE) == SUCCESS);
+	TEST_CHECK(memcmp(data, g_pattern, TEST_BLOCK_SIZE) == 0);
+}
+
+
+
+
+
+/* SDA held low for good in the middle of a queued read ... it fails and the recovery fails till SDA is released */
+static void test_stuckSdaDuringTransfer(void)
+{
+	uint8 data[TEST_BLOCK_SIZE];
+	uint8 byte = 0;
+	I2C_Transfer transfer;
+
+	TEST_CHECK(EEPROM_startRead(&transfer, TEST_BLOCK_ADDRESS, data, TEST_BLOCK_SIZE, NULL_PTR) == SUCCESS);
+	HOST_twiHoldSda(HOST_TWI_HOLD_FOREVER);
+
+	TEST_CHECK(I2C_wait(&transfer) == I2C_FAILED);
+	TEST_CHECK(transfer.errorStatus == I2C_STEP_TIMEOUT);
+	TEST_CHECK(I2C_recoverBus() == FALSE);
+	TEST_CHECK(EEPROM_writeByte(6, 0x01) == ERROR);
+
+	HOST_twiHoldSda(0);
+	TEST_CHECK(I2C_recoverBus() == TRUE);
+	TEST_CHECK(EEPROM_writeByte(6, 0x77) == SUCCESS);
+	TEST_CHECK((EEPROM_readByte(6, &byte) == SUCCESS) && (byte == 0x77));
+}
+
+
+
+
+
+/* the blocking functions of the old interface are bounded too */
+static void test_stuckSdaBlockingApi(void)
+{
+	HOST_twiHoldSda(3);
+	I2C_start();
+	TEST_CHECK(I2C_getStatus() == I2C_STEP_TIMEOUT);
+	TEST_CHECK(I2C_recoverBus() == TRUE);
+
+	I2C_start();
+	TEST_CHECK(I2C_getStatus() == I2C_START);
+	I2C_stop();
+}
+
+
+
+
+
+/* a background password check stuck on the bus is dropped and the cache keeps answering */
+static void test_stuckCredVerify(void)
+{
+	uint8 pass[CRED_PASSWORD_SIZE] = {1, 2, 3, 4, 5};
+
+	CRED_init();
+	TEST_CHECK(CRED_save(pass) == TRUE);
+	TEST_CHECK(CRED_check(pass) == TRUE);
+
+	HOST_twiHoldSda(HOST_TWI_HOLD_FOREVER);
+	CRED_verify();
+	waitMs(4 * I2C_STEP_TIMEOUT_MS);
+	TEST_CHECK(I2C_isIdle() == TRUE);
+	TEST_CHECK(CRED_check(pass) == TRUE);
+
+	HOST_twiHoldSda(0);
+	TEST_CHECK(I2C_recoverBus() == TRUE);
+	CRED_verify();
+	while(I2C_isIdle() == FALSE)
+	{
+		waitMs(1);
+	}
+	TEST_CHECK(CRED_check(pass) == TRUE);
+}
+
+
+
+
+
+/* the counters reach the diagnostics page of the I2C */
+static void test_diagnosticsPage(void)
+{
+	uint8 page[FRAME_MAX_PAYLOAD_SIZE];
+	I2C_Statistics stats;
+
+	I2C_getStatistics(&stats);
+	TEST_CHECK(DIAG_fillPage(DIAG_PAGE_I2C, page) == 8);
+	TEST_CHECK(DIAG_getField(DIAG_PAGE_I2C, page, 0) == stats.timeouts);
+	TEST_CHECK(DIAG_getField(DIAG_PAGE_I2C, page, 1) == stats.nacks);
+	TEST_CHECK(DIAG_getField(DIAG_PAGE_I2C, page, 2) == stats.busErrors);
+	TEST_CHECK(DIAG_getField(DIAG_PAGE_I2C, page, 3) == stats.recoveries);
+	TEST_CHECK(stats.recoveries >= 4);
+}
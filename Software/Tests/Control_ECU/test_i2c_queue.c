@@ -0,0 +1,358 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: test_i2c_queue.c
+ *
+ * Description: Tests of the interrupt driven I2C transfers against the 24C16 model of the host build:
+ *              the queue order, the callbacks, a failed transfer in the queue, EEPROM_startRead and
+ *              the profiled write cycle
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "test.h"
+#include "host_twi.h"
+#include "i2c.h"
+#include "external_eeprom.h"
+#include "systick.h"
+#include "prof.h"
+#include <avr/io.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define TEST_EEPROM_ADDRESS			0x50
+#define TEST_MISSING_ADDRESS		0x20
+#define TEST_NUM_OF_TRANSFERS		4
+#define TEST_READ_SIZE				8
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* the transfers in the order their callbacks are called */
+static I2C_Transfer * g_doneOrder[TEST_NUM_OF_TRANSFERS + 1];
+static volatile uint8 g_doneCount = 0;
+
+/* a transfer submitted by the callback of another one */
+static I2C_Transfer g_chained;
+static uint8 g_chainedData[TEST_READ_SIZE];
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void recordDone(I2C_Transfer * transfer);
+static void submitChained(I2C_Transfer * transfer);
+static void setupRead(I2C_Transfer * transfer, uint16 address, uint8 * data, uint16 length);
+static void waitIdle(void);
+
+static void test_queueOrder(void);
+static void test_failedTransferInQueue(void);
+static void test_callbackSubmitsNext(void);
+static void test_startReadRunsInBackground(void);
+static void test_startReadAfterWrite(void);
+static void test_writeCycleProfiled(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void)
+{
+	I2C_ConfigType i2cConfig = {FAST_MODE,0b0000001};
+	uint8 * memory = HOST_twiGetMemory();
+	uint16 i;
+
+	SREG = (1<<7);
+	SYSTICK_init();
+	I2C_init(&i2cConfig);
+
+	/* every byte holds the low byte of its address */
+	for(i=0;i<HOST_TWI_EEPROM_SIZE;i++)
+	{
+		memory[i] = (uint8)i;
+	}
+
+	TEST_RUN(test_queueOrder);
+	TEST_RUN(test_failedTransferInQueue);
+	TEST_RUN(test_callbackSubmitsNext);
+	TEST_RUN(test_startReadRunsInBackground);
+	TEST_RUN(test_startReadAfterWrite);
+	TEST_RUN(test_writeCycleProfiled);
+
+	return TEST_RESULT();
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  recordDone
+[Description]: callback that saves the order the transfers are done in ... called by the ISR
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] I2C_Transfer * transfer:
+					the done transfer
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void recordDone(I2C_Transfer * transfer)
+{
+	if(g_doneCount <= TEST_NUM_OF_TRANSFERS)
+	{
+		g_doneOrder[g_doneCount] = transfer;
+	}
+	g_doneCount++;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  submitChained
+[Description]: callback that submits g_chained from the ISR
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] I2C_Transfer * transfer:
+					the done transfer
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void submitChained(I2C_Transfer * transfer)
+{
+	recordDone(transfer);
+	setupRead(&g_chained, 0x300, g_chainedData, TEST_READ_SIZE);
+	I2C_submit(&g_chained);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  setupRead
+[Description]: fill a transfer that reads the EEPROM (word address then a repeated START)
+[Args]:
+[in]	uint16 address:
+					the EEPROM address
+		uint16 length:
+					number of bytes
+[out]	uint8 * data:
+					the read bytes
+[in/out] I2C_Transfer * transfer:
+					the transfer
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void setupRead(I2C_Transfer * transfer, uint16 address, uint8 * data, uint16 length)
+{
+	memset(transfer, 0, sizeof(*transfer));
+	transfer->address = (uint8)(TEST_EEPROM_ADDRESS | ((address >> 8) & 0x07));
+	transfer->command[0] = (uint8)address;
+	transfer->commandLength = 1;
+	transfer->readData = data;
+	transfer->readLength = length;
+	transfer->callback = recordDone;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  waitIdle
+[Description]: sleep till all the submitted transfers are done
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void waitIdle(void)
+{
+	while(I2C_isIdle() == FALSE)
+	{
+		SYSTICK_sleepUntil(SYSTICK_getDeadline(1));
+	}
+}
+
+
+
+
+
+/* transfers submitted back to back are done one after the other in the submit order */
+static void test_queueOrder(void)
+{
+	I2C_Transfer transfers[TEST_NUM_OF_TRANSFERS];
+	uint8 data[TEST_NUM_OF_TRANSFERS][TEST_READ_SIZE];
+	uint8 i;
+	uint8 j;
+
+	g_doneCount = 0;
+	for(i=0;i<TEST_NUM_OF_TRANSFERS;i++)
+	{
+		setupRead(&transfers[i], 0x100 * i + 0x10 * i, data[i], TEST_READ_SIZE);
+		I2C_submit(&transfers[i]);
+	}
+
+	/* only the first one can be on the bus yet */
+	TEST_CHECK(I2C_isIdle() == FALSE);
+	TEST_CHECK(transfers[TEST_NUM_OF_TRANSFERS - 1].status == I2C_PENDING);
+
+	waitIdle();
+	TEST_CHECK(g_doneCount == TEST_NUM_OF_TRANSFERS);
+	for(i=0;i<TEST_NUM_OF_TRANSFERS;i++)
+	{
+		TEST_CHECK(g_doneOrder[i] == &transfers[i]);
+		TEST_CHECK(transfers[i].status == I2C_DONE);
+		for(j=0;j<TEST_READ_SIZE;j++)
+		{
+			TEST_CHECK(data[i][j] == (uint8)(0x10 * i + j));
+		}
+	}
+}
+
+
+
+
+
+/* a transfer the slave doesn't acknowledge fails alone, the one after it is still done */
+static void test_failedTransferInQueue(void)
+{
+	I2C_Transfer missing;
+	I2C_Transfer good;
+	uint8 missingData[TEST_READ_SIZE];
+	uint8 goodData[TEST_READ_SIZE];
+
+	g_doneCount = 0;
+	setupRead(&missing, 0, missingData, TEST_READ_SIZE);
+	missing.address = TEST_MISSING_ADDRESS;
+	setupRead(&good, 0x40, goodData, TEST_READ_SIZE);
+
+	I2C_submit(&missing);
+	I2C_submit(&good);
+
+	TEST_CHECK(I2C_wait(&missing) == I2C_FAILED);
+	TEST_CHECK(missing.errorStatus == I2C_MT_SLA_W_NACK);
+	TEST_CHECK(I2C_wait(&good) == I2C_DONE);
+	TEST_CHECK((g_doneCount == 2) && (g_doneOrder[0] == &missing) && (g_doneOrder[1] == &good));
+	TEST_CHECK(goodData[0] == 0x40);
+}
+
+
+
+
+
+/* a callback can submit the next transfer from the ISR */
+static void test_callbackSubmitsNext(void)
+{
+	I2C_Transfer first;
+	uint8 data[TEST_READ_SIZE];
+
+	g_doneCount = 0;
+	setupRead(&first, 0x200, data, TEST_READ_SIZE);
+	first.callback = submitChained;
+	I2C_submit(&first);
+
+	waitIdle();
+	TEST_CHECK(g_doneCount == 2);
+	TEST_CHECK((g_doneOrder[0] == &first) && (g_doneOrder[1] == &g_chained));
+	TEST_CHECK(g_chained.status == I2C_DONE);
+	TEST_CHECK((data[0] == 0x00) && (g_chainedData[TEST_READ_SIZE - 1] == (TEST_READ_SIZE - 1)));
+}
+
+
+
+
+
+/* EEPROM_startRead returns at once and the CPU keeps working till the callback comes */
+static void test_startReadRunsInBackground(void)
+{
+	I2C_Transfer transfer;
+	uint8 data[2 * HOST_TWI_PAGE_SIZE];
+	uint32 work = 0;
+	uint8 i;
+
+	g_doneCount = 0;
+	TEST_CHECK(EEPROM_startRead(&transfer, 0x123, data, sizeof(data), recordDone) == SUCCESS);
+	TEST_CHECK(transfer.status == I2C_PENDING);
+
+	/* the main loop work ... every pass reads a register so the time passes */
+	while(transfer.status == I2C_PENDING)
+	{
+		work++;
+		(void)TCNT1;
+	}
+
+	/* 32 bytes at 400 kHz take hundreds of register accesses of work */
+	TEST_CHECK(work > 100);
+	TEST_CHECK((g_doneCount == 1) && (g_doneOrder[0] == &transfer));
+	TEST_CHECK(transfer.status == I2C_DONE);
+	for(i=0;i<sizeof(data);i++)
+	{
+		TEST_CHECK(data[i] == (uint8)(0x23 + i));
+	}
+}
+
+
+
+
+
+/* a read started while the EEPROM saves a write waits for the write cycle and reads the new bytes */
+static void test_startReadAfterWrite(void)
+{
+	I2C_Transfer transfer;
+	const uint8 pattern[4] = {0xA1, 0xB2, 0xC3, 0xD4};
+	uint8 data[4];
+	I2C_Statistics stats;
+
+	TEST_CHECK(EEPROM_writeBlock(0x7F0, pattern, sizeof(pattern)) == SUCCESS);
+	g_doneCount = 0;
+	TEST_CHECK(EEPROM_startRead(&transfer, 0x7F0, data, sizeof(data), recordDone) == SUCCESS);
+	TEST_CHECK(I2C_wait(&transfer) == I2C_DONE);
+	TEST_CHECK(memcmp(data, pattern, sizeof(pattern)) == 0);
+
+	/* the ACK polling probes NACKed during the write cycle aren't errors */
+	I2C_getStatistics(&stats);
+	TEST_CHECK(stats.nacks == 1);
+}
+
+
+
+
+
+/*
+ * the write cycle ends at the first ACK without an access after it ... the polling is the same
+ * in both builds, only with PROF_ENABLE the write cycle row gets its time
+ */
+static void test_writeCycleProfiled(void)
+{
+	const uint8 pattern[2] = {0x5A, 0xA5};
+#if(PROF_ENABLE == TRUE)
+	PROF_Region before;
+	PROF_Region after;
+
+	PROF_getRegion(PROF_EEPROM_WRITE_CYCLE, &before);
+#endif
+	TEST_CHECK(EEPROM_writeBlock(0x600, pattern, sizeof(pattern)) == SUCCESS);
+
+	/* the background polling keeps the queue busy till the EEPROM answers */
+	waitIdle();
+#if(PROF_ENABLE == TRUE)
+	PROF_getRegion(PROF_EEPROM_WRITE_CYCLE, &after);
+	TEST_CHECK(after.count == (before.count + 1));
+
+	/* one probe (~25 us at 400 kHz) is the resolution */
+	TEST_CHECK(after.max >= (HOST_TWI_WRITE_CYCLE_MS * 1000UL - 100));
+	TEST_CHECK(after.max <= (HOST_TWI_WRITE_CYCLE_MS * 1000UL + 100));
+#endif
+
+	/* nothing is left to wait for */
+	TEST_CHECK(I2C_isIdle() == TRUE);
+}
@@ -0,0 +1,793 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: cosim.c
+ *
+ * Description: Source file for the co-simulation coordinator ... every quantum the nodes are granted
+ *              the same end time, they run in parallel and send their frames and ports, then the
+ *              frames are checked for collisions and delivered before the next quantum
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "cosim.h"
+#include "host_wire.h"
+#include "host_keypad.h"
+#include "common_macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* frames one quantum can hold, a quantum is shorter than one frame per node */
+#define COSIM_MAX_QUANTUM_FRAMES	(4 * COSIM_MAX_NODES)
+
+/* the LCD pins (PORTC data, RS = PD5 and E = PD7) and its commands */
+#define COSIM_LCD_RS_PIN			5
+#define COSIM_LCD_E_PIN				7
+#define COSIM_LCD_CLEAR				0x01
+#define COSIM_LCD_HOME				0x02
+#define COSIM_LCD_SET_ADDRESS		0x80
+#define COSIM_LCD_SECOND_ROW		0x40
+
+/* the motor and the buzzer pins */
+#define COSIM_MOTOR_IN1_PIN			0
+#define COSIM_MOTOR_IN2_PIN			1
+#define COSIM_BUZZER_PIN			7
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: COSIM_Node
+[Structure Description]: one ECU program and the devices around it
+------------------------------------------------------------------*/
+typedef struct
+{
+	pid_t pid;
+	int socket;
+	uint64 cycles;
+	uint32 rxCycles;
+	uint32 sleepCycles;
+	uint32 lateFrames;
+	uint64 sleptCycles;
+	uint32 sleeps;
+	uint8 pins[HOST_WIRE_NUM_OF_PINS];
+	uint8 ddram[COSIM_LCD_DDRAM_SIZE];
+	uint8 lcdAddress;
+	char row[COSIM_LCD_COLS + 1];
+	uint64 lineBusyEnd;
+}COSIM_Node;
+
+/*------------------------------------------------------------------
+[Structure Name]: COSIM_LineFrame
+[Structure Description]: a frame put on the line in the current quantum and its sender
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint8 node;
+	HOST_UartFrame frame;
+}COSIM_LineFrame;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static COSIM_Node g_nodes[COSIM_MAX_NODES];
+static uint8 g_numOfNodes = 0;
+static boolean g_failed = FALSE;
+
+static COSIM_LineFrame g_frames[COSIM_MAX_QUANTUM_FRAMES];
+static uint8 g_numOfFrames = 0;
+
+static COSIM_Statistics g_stats;
+static void (*g_lineHook)(uint8 node, const HOST_UartFrame * frame) = NULL_PTR;
+
+/* the buttons of the 4x4 keypad in the order of their numbers (row * 4 + column + 1) */
+static const uint8 g_keys[16] = {7, 8, 9, '%', 4, 5, 6, '*', 1, 2, 3, '-', 13, 0, '=', '+'};
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static boolean COSIM_runQuantum(void);
+static boolean COSIM_collect(uint8 node);
+static void COSIM_deliverFrames(void);
+static void COSIM_updatePins(uint8 node, const uint8 * pins);
+static boolean COSIM_send(uint8 node, HOST_WireMessage * message);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_start
+[Description]: start the ECU programs and wait till all of them reach their first register access
+[Args]:
+[in]	const char * const * programs:
+					the paths of the programs, the first one is the master
+		uint8 count:
+					number of programs (up to COSIM_MAX_NODES)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if all of them are started, FALSE otherwise
+------------------------------------------------------------------*/
+boolean COSIM_start(const char * const * programs, uint8 count)
+{
+	int sockets[2];
+	char fd[12];
+	uint8 i;
+
+	if(count > COSIM_MAX_NODES)
+	{
+		return FALSE;
+	}
+
+	memset(g_nodes, 0, sizeof(g_nodes));
+	memset(&g_stats, 0, sizeof(g_stats));
+	g_numOfNodes = 0;
+	g_numOfFrames = 0;
+	g_failed = FALSE;
+
+	for(i=0;i<count;i++)
+	{
+		if(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) != 0)
+		{
+			COSIM_stop();
+			return FALSE;
+		}
+
+		g_nodes[i].pid = fork();
+		if(g_nodes[i].pid == 0)
+		{
+			/* the ECU gets the other end of the socket */
+			close(sockets[0]);
+			snprintf(fd, sizeof(fd), "%d", sockets[1]);
+			setenv(HOST_WIRE_FD_VARIABLE, fd, 1);
+			execl(programs[i], programs[i], (char *)NULL_PTR);
+			_exit(127);
+		}
+		close(sockets[1]);
+		g_nodes[i].socket = sockets[0];
+		memset(g_nodes[i].ddram, ' ', COSIM_LCD_DDRAM_SIZE);
+		g_numOfNodes++;
+
+		if((g_nodes[i].pid < 0) || (COSIM_collect(i) == FALSE))
+		{
+			printf("  cosim: %s didn't start\n", programs[i]);
+			COSIM_stop();
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_stop
+[Description]: end the ECU programs and wait for them
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void COSIM_stop(void)
+{
+	HOST_WireMessage message;
+	uint8 i;
+
+	memset(&message, 0, sizeof(message));
+	message.type = HOST_WIRE_QUIT;
+	for(i=0;i<g_numOfNodes;i++)
+	{
+		/* a node that doesn't take the message is gone or stuck */
+		if(send(g_nodes[i].socket, &message, sizeof(message), MSG_NOSIGNAL | MSG_DONTWAIT) != sizeof(message))
+		{
+			kill(g_nodes[i].pid, SIGKILL);
+		}
+		close(g_nodes[i].socket);
+		waitpid(g_nodes[i].pid, NULL_PTR, 0);
+	}
+	g_numOfNodes = 0;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_run
+[Description]: run all the nodes for a time
+[Args]:
+[in]	uint32 timeMs:
+					the time in milliseconds
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is done or FALSE if a node has ended
+------------------------------------------------------------------*/
+boolean COSIM_run(uint32 timeMs)
+{
+	uint64 end = COSIM_getCycles() + (uint64)timeMs * COSIM_CYCLES_PER_MS;
+
+	while((g_failed == FALSE) && (COSIM_getCycles() < end))
+	{
+		COSIM_runQuantum();
+	}
+	return (g_failed == FALSE) ? TRUE : FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_runUntilLcd
+[Description]: run all the nodes till a row of the LCD of a node has a text
+[Args]:
+[in]	uint8 node:
+					the node
+		uint8 row:
+					the LCD row (0 or 1)
+		const char * text:
+					the text, anywhere in the row
+		uint32 timeoutMs:
+					the most time to run
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the text is shown, FALSE if the time is out or a node has ended
+------------------------------------------------------------------*/
+boolean COSIM_runUntilLcd(uint8 node, uint8 row, const char * text, uint32 timeoutMs)
+{
+	uint64 end = COSIM_getCycles() + (uint64)timeoutMs * COSIM_CYCLES_PER_MS;
+
+	while(strstr(COSIM_getLcdRow(node, row), text) == NULL_PTR)
+	{
+		if((COSIM_getCycles() >= end) || (COSIM_runQuantum() == FALSE))
+		{
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_pressKey
+[Description]: press a button of the keypad of a node, hold it for COSIM_KEY_HOLD_MS
+				and release it for COSIM_KEY_GAP_MS
+[Args]:
+[in]	uint8 node:
+					the node
+		uint8 key:
+					the key as KEYPAD_getPressedKey gives it (0 -> 9, '+', '-', '%', '*', '=' or 13)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is done or FALSE if the key isn't on the keypad or a node has ended
+------------------------------------------------------------------*/
+boolean COSIM_pressKey(uint8 node, uint8 key)
+{
+	HOST_WireMessage message;
+	uint8 button;
+
+	for(button=0;(button<sizeof(g_keys)) && (g_keys[button] != key);button++);
+	if(button == sizeof(g_keys))
+	{
+		return FALSE;
+	}
+
+	/* the node is waiting for its next grant so it takes the button before it runs again */
+	memset(&message, 0, sizeof(message));
+	message.type = HOST_WIRE_KEY;
+	message.key = button + 1;
+	if((COSIM_send(node, &message) == FALSE) || (COSIM_run(COSIM_KEY_HOLD_MS) == FALSE))
+	{
+		return FALSE;
+	}
+
+	message.key = HOST_KEYPAD_RELEASED;
+	return ((COSIM_send(node, &message) == TRUE) && (COSIM_run(COSIM_KEY_GAP_MS) == TRUE)) ? TRUE : FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_typeKeys
+[Description]: press a row of keys, the digits '0' -> '9' are the number keys
+				and COSIM_ENTER is Enter
+[Args]:
+[in]	uint8 node:
+					the node
+		const char * keys:
+					the keys
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is done or FALSE otherwise
+------------------------------------------------------------------*/
+boolean COSIM_typeKeys(uint8 node, const char * keys)
+{
+	uint8 key;
+
+	for(;*keys != '\0';keys++)
+	{
+		if((*keys >= '0') && (*keys <= '9'))
+		{
+			key = (uint8)(*keys - '0');
+		}
+		else if(*keys == COSIM_ENTER)
+		{
+			key = 13;
+		}
+		else
+		{
+			key = (uint8)*keys;
+		}
+
+		if(COSIM_pressKey(node, key) == FALSE)
+		{
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_getLcdRow
+[Description]: get the text shown on a row of the LCD of a node
+[Args]:
+[in]	uint8 node:
+					the node
+		uint8 row:
+					the LCD row (0 or 1)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the COSIM_LCD_COLS characters of the row
+------------------------------------------------------------------*/
+const char * COSIM_getLcdRow(uint8 node, uint8 row)
+{
+	COSIM_Node * lcd = &g_nodes[node];
+
+	memcpy(lcd->row, &lcd->ddram[(row == 0) ? 0 : COSIM_LCD_SECOND_ROW], COSIM_LCD_COLS);
+	lcd->row[COSIM_LCD_COLS] = '\0';
+	return lcd->row;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_getMotor
+[Description]: get what the motor of a node does
+[Args]:
+[in]	uint8 node:
+					the node
+[out]	uint8 * duty:
+					the PWM duty cycle in percent (OCR0), it can be NULL_PTR
+[in/out] -NONE
+[Returns]: the direction
+------------------------------------------------------------------*/
+COSIM_Motor COSIM_getMotor(uint8 node, uint8 * duty)
+{
+	uint8 portb = g_nodes[node].pins[HOST_WIRE_PORTB];
+
+	if(duty != NULL_PTR)
+	{
+		*duty = (uint8)(((uint16)g_nodes[node].pins[HOST_WIRE_OCR0] * 100 + 127) / 255);
+	}
+
+	if(BIT_IS_SET(portb,COSIM_MOTOR_IN1_PIN) && BIT_IS_CLEAR(portb,COSIM_MOTOR_IN2_PIN))
+	{
+		return COSIM_MOTOR_CW;
+	}
+	if(BIT_IS_CLEAR(portb,COSIM_MOTOR_IN1_PIN) && BIT_IS_SET(portb,COSIM_MOTOR_IN2_PIN))
+	{
+		return COSIM_MOTOR_A_CW;
+	}
+	return COSIM_MOTOR_STOP;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_isBuzzerOn
+[Description]: check the buzzer of a node (PD7)
+[Args]:
+[in]	uint8 node:
+					the node
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is on, FALSE otherwise
+------------------------------------------------------------------*/
+boolean COSIM_isBuzzerOn(uint8 node)
+{
+	return BIT_IS_SET(g_nodes[node].pins[HOST_WIRE_PORTD],COSIM_BUZZER_PIN) ? TRUE : FALSE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_getCycles
+[Description]: get the time all the nodes have reached
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the CPU cycles since the start
+------------------------------------------------------------------*/
+uint64 COSIM_getCycles(void)
+{
+	uint64 cycles = 0;
+	uint8 i;
+
+	for(i=0;i<g_numOfNodes;i++)
+	{
+		if((i == 0) || (g_nodes[i].cycles < cycles))
+		{
+			cycles = g_nodes[i].cycles;
+		}
+	}
+	return cycles;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_getStatistics
+[Description]: take a copy of the counters of the bus
+[Args]:
+[in]	-NONE
+[out]	COSIM_Statistics * stats:
+					pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void COSIM_getStatistics(COSIM_Statistics * stats)
+{
+	uint8 i;
+
+	*stats = g_stats;
+	stats->lateFrames = 0;
+	for(i=0;i<g_numOfNodes;i++)
+	{
+		stats->lateFrames += g_nodes[i].lateFrames;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_getSleepStatistics
+[Description]: take a copy of the sleep counters of a node
+[Args]:
+[in]	uint8 node:
+					the node
+[out]	COSIM_SleepStatistics * stats:
+					pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void COSIM_getSleepStatistics(uint8 node, COSIM_SleepStatistics * stats)
+{
+	stats->cycles = g_nodes[node].cycles;
+	stats->sleptCycles = g_nodes[node].sleptCycles;
+	stats->sleeps = g_nodes[node].sleeps;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_setLineHook
+[Description]: watch the frames put on the line, the hook is called for every frame
+				in the order of their start in a quantum
+[Args]:
+[in]	void (*hook)(uint8 node, const HOST_UartFrame * frame):
+					the function or NULL_PTR
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void COSIM_setLineHook(void (*hook)(uint8 node, const HOST_UartFrame * frame))
+{
+	g_lineHook = hook;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_runQuantum
+[Description]: grant all the nodes behind the end of the quantum, take their messages
+				till they are done and deliver the frames sent meanwhile
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is done or FALSE if a node has ended
+------------------------------------------------------------------*/
+static boolean COSIM_runQuantum(void)
+{
+	HOST_WireMessage message;
+	uint64 now = COSIM_getCycles();
+	uint64 end = now + COSIM_MAX_QUANTUM;
+	uint64 reception;
+	boolean granted[COSIM_MAX_NODES];
+	uint8 i;
+
+	if(g_failed == TRUE)
+	{
+		return FALSE;
+	}
+
+	/* the nearest reception of a frame any node may start ... a sleeping node starts none before it wakes */
+	for(i=0;i<g_numOfNodes;i++)
+	{
+		reception = g_nodes[i].cycles + g_nodes[i].sleepCycles + g_nodes[i].rxCycles;
+		if(reception < (end + COSIM_SLACK_CYCLES))
+		{
+			end = reception - COSIM_SLACK_CYCLES;
+		}
+	}
+	if(end < (now + HOST_ADVANCE_STEP))
+	{
+		end = now + HOST_ADVANCE_STEP;
+	}
+
+	memset(&message, 0, sizeof(message));
+	message.type = HOST_WIRE_GRANT;
+	message.cycles = end;
+	for(i=0;i<g_numOfNodes;i++)
+	{
+		granted[i] = (g_nodes[i].cycles < message.cycles) ? TRUE : FALSE;
+		if((granted[i] == TRUE) && (COSIM_send(i, &message) == FALSE))
+		{
+			return FALSE;
+		}
+	}
+
+	/* the nodes run in parallel now */
+	for(i=0;i<g_numOfNodes;i++)
+	{
+		if((granted[i] == TRUE) && (COSIM_collect(i) == FALSE))
+		{
+			return FALSE;
+		}
+	}
+
+	COSIM_deliverFrames();
+	g_stats.quanta++;
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_collect
+[Description]: take the messages of a node till it is done with its grant
+[Args]:
+[in]	uint8 node:
+					the node
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is done or FALSE if it has ended
+------------------------------------------------------------------*/
+static boolean COSIM_collect(uint8 node)
+{
+	HOST_WireMessage message;
+
+	while(1)
+	{
+		if(recv(g_nodes[node].socket, &message, sizeof(message), 0) != sizeof(message))
+		{
+			printf("  cosim: node %u has ended\n", node);
+			g_failed = TRUE;
+			return FALSE;
+		}
+
+		switch(message.type)
+		{
+		case HOST_WIRE_DONE:
+			g_nodes[node].cycles = message.cycles;
+			g_nodes[node].rxCycles = message.rxCycles;
+			g_nodes[node].sleepCycles = message.sleepCycles;
+			g_nodes[node].lateFrames = message.lateFrames;
+			g_nodes[node].sleptCycles = message.sleptCycles;
+			g_nodes[node].sleeps = message.sleeps;
+			return TRUE;
+
+		case HOST_WIRE_FRAME:
+			if(g_numOfFrames < COSIM_MAX_QUANTUM_FRAMES)
+			{
+				g_frames[g_numOfFrames].node = node;
+				g_frames[g_numOfFrames].frame = message.frame;
+				g_numOfFrames++;
+			}
+			break;
+
+		case HOST_WIRE_PINS:
+			COSIM_updatePins(node, message.pins);
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_deliverFrames
+[Description]: deliver the frames of the quantum in the order of their start, the master frames
+				go to all the slaves and the slave frames to the master ... a slave frame that starts
+				while another slave is sending is broken (the frame on the line before it may
+				already be received if it was sent in an earlier quantum)
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void COSIM_deliverFrames(void)
+{
+	HOST_WireMessage message;
+	COSIM_LineFrame swap;
+	uint8 i;
+	uint8 j;
+
+	/* a few frames only ... insertion sort */
+	for(i=1;i<g_numOfFrames;i++)
+	{
+		for(j=i;(j > 0) && (g_frames[j - 1].frame.start > g_frames[j].frame.start);j--)
+		{
+			swap = g_frames[j];
+			g_frames[j] = g_frames[j - 1];
+			g_frames[j - 1] = swap;
+		}
+	}
+
+	memset(&message, 0, sizeof(message));
+	message.type = HOST_WIRE_FRAME;
+	for(i=0;i<g_numOfFrames;i++)
+	{
+		if(g_frames[i].node != COSIM_MASTER)
+		{
+			for(j=0;j<g_numOfNodes;j++)
+			{
+				if((j != COSIM_MASTER) && (j != g_frames[i].node) && (g_nodes[j].lineBusyEnd > g_frames[i].frame.start))
+				{
+					g_frames[i].frame.broken = TRUE;
+				}
+			}
+			if(g_frames[i].frame.broken == TRUE)
+			{
+				g_stats.collisions++;
+			}
+		}
+		g_nodes[g_frames[i].node].lineBusyEnd = g_frames[i].frame.start + HOST_UART_LINE_CYCLES(&g_frames[i].frame);
+		g_stats.frames++;
+
+		if(g_lineHook != NULL_PTR)
+		{
+			g_lineHook(g_frames[i].node, &g_frames[i].frame);
+		}
+
+		message.frame = g_frames[i].frame;
+		for(j=0;j<g_numOfNodes;j++)
+		{
+			if((j != g_frames[i].node) && ((g_frames[i].node == COSIM_MASTER) || (j == COSIM_MASTER)))
+			{
+				COSIM_send(j, &message);
+			}
+		}
+	}
+	g_numOfFrames = 0;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_updatePins
+[Description]: take the new ports of a node, the LCD takes its data bus on the falling edge of E
+[Args]:
+[in]	uint8 node:
+					the node
+		const uint8 * pins:
+					the ports (HOST_WIRE_PORTB ...)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void COSIM_updatePins(uint8 node, const uint8 * pins)
+{
+	COSIM_Node * lcd = &g_nodes[node];
+	uint8 data = pins[HOST_WIRE_PORTC];
+
+	if(BIT_IS_SET(lcd->pins[HOST_WIRE_PORTD],COSIM_LCD_E_PIN) && BIT_IS_CLEAR(pins[HOST_WIRE_PORTD],COSIM_LCD_E_PIN))
+	{
+		if(BIT_IS_SET(pins[HOST_WIRE_PORTD],COSIM_LCD_RS_PIN))
+		{
+			lcd->ddram[lcd->lcdAddress] = data;
+			lcd->lcdAddress = (lcd->lcdAddress + 1) & (COSIM_LCD_DDRAM_SIZE - 1);
+		}
+		else if(data & COSIM_LCD_SET_ADDRESS)
+		{
+			lcd->lcdAddress = data & (COSIM_LCD_DDRAM_SIZE - 1);
+		}
+		else if(data == COSIM_LCD_CLEAR)
+		{
+			memset(lcd->ddram, ' ', COSIM_LCD_DDRAM_SIZE);
+			lcd->lcdAddress = 0;
+		}
+		else if((data & (uint8)~1) == COSIM_LCD_HOME)
+		{
+			lcd->lcdAddress = 0;
+		}
+	}
+	memcpy(lcd->pins, pins, HOST_WIRE_NUM_OF_PINS);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_send
+[Description]: send one message to a node
+[Args]:
+[in]	uint8 node:
+					the node
+[out]	-NONE
+[in/out] HOST_WireMessage * message:
+					pointer to the message
+[Returns]: TRUE if it is sent or FALSE if the node has ended
+------------------------------------------------------------------*/
+static boolean COSIM_send(uint8 node, HOST_WireMessage * message)
+{
+	if(send(g_nodes[node].socket, message, sizeof(*message), MSG_NOSIGNAL) != sizeof(*message))
+	{
+		printf("  cosim: node %u has ended\n", node);
+		g_failed = TRUE;
+		return FALSE;
+	}
+	return TRUE;
+}
@@ -0,0 +1,316 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: cosim.h
+ *
+ * Description: Header file for the co-simulation coordinator, it runs the host builds of the ECUs
+ *              as separate programs in lockstep on one emulated UART bus (host_wire.h) and
+ *              plays the devices around them: the keypad buttons, the HD44780 LCD, the motor
+ *              H-bridge and the buzzer ... the 24C16 is the TWI model inside the Control_ECU
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef COSIM_H_
+#define COSIM_H_
+
+#include "std_types.h"
+#include "host.h"
+#include "host_uart.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define COSIM_MAX_NODES				4
+
+/* the first node is the master of the bus (the Control_ECU), its frames go to all the others
+ * and the frames of the others go to it only */
+#define COSIM_MASTER				0
+
+#define COSIM_CYCLES_PER_MS			(F_CPU / 1000UL)
+
+/*
+ * The time every node runs before the frames on the line are exchanged ... a frame can't be
+ * received sooner than HOST_uartGetRxCycles after its start and a sleeping node starts none
+ * before its HOST_getSleepCycles pass, so a quantum that ends before the nearest of those
+ * (less the HOST_ADVANCE_STEP a node may run past its grant and one more for the node
+ * that was ahead) delivers every frame before its time, it is capped to keep the keys and
+ * the pins on time while the nodes sleep
+ */
+#define COSIM_SLACK_CYCLES			(2 * HOST_ADVANCE_STEP)
+#define COSIM_MAX_QUANTUM			COSIM_CYCLES_PER_MS
+
+/* a key is held longer than the debounce and the scan period of the HMI_ECU */
+#define COSIM_KEY_HOLD_MS			60
+#define COSIM_KEY_GAP_MS			60
+
+/* the LCD is 2x16, its DDRAM has 40 places per row at 0x00 and 0x40 */
+#define COSIM_LCD_ROWS				2
+#define COSIM_LCD_COLS				16
+#define COSIM_LCD_DDRAM_SIZE		0x80
+
+/* the typed key of COSIM_typeKeys for Enter */
+#define COSIM_ENTER					'E'
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[ENUM Name]: COSIM_Motor
+[ENUM Description]: what the H-bridge of the motor does (IN1 = PB0, IN2 = PB1)
+------------------------------------------------------------------*/
+typedef enum
+{
+	COSIM_MOTOR_STOP,COSIM_MOTOR_CW,COSIM_MOTOR_A_CW
+}COSIM_Motor;
+
+/*------------------------------------------------------------------
+[Structure Name]: COSIM_Statistics
+[Structure Description]: it holds the counters of the bus
+					frames     : frames put on the line
+					collisions : frames sent by a slave while another slave was sending
+					lateFrames : frames delivered after the time they should have been received (0 in lockstep)
+					quanta     : times the nodes were run
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint32 frames;
+	uint32 collisions;
+	uint32 lateFrames;
+	uint32 quanta;
+}COSIM_Statistics;
+
+/*------------------------------------------------------------------
+[Structure Name]: COSIM_SleepStatistics
+[Structure Description]: it holds the sleep counters of a node
+					cycles      : CPU cycles the node has reached
+					sleptCycles : CPU cycles it has slept (sleep_cpu till the interrupt that woke it up)
+					sleeps      : times it has slept ... every one ends with a wake-up
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint64 cycles;
+	uint64 sleptCycles;
+	uint32 sleeps;
+}COSIM_SleepStatistics;
+
+/*******************************************************************************
+ *                              Functions Prototypes                           *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_start
+[Description]: start the ECU programs and wait till all of them reach their first register access
+[Args]:
+[in]	const char * const * programs:
+					the paths of the programs, the first one is the master
+		uint8 count:
+					number of programs (up to COSIM_MAX_NODES)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if all of them are started, FALSE otherwise
+------------------------------------------------------------------*/
+boolean COSIM_start(const char * const * programs, uint8 count);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_stop
+[Description]: end the ECU programs and wait for them
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void COSIM_stop(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_run
+[Description]: run all the nodes for a time
+[Args]:
+[in]	uint32 timeMs:
+					the time in milliseconds
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is done or FALSE if a node has ended
+------------------------------------------------------------------*/
+boolean COSIM_run(uint32 timeMs);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_runUntilLcd
+[Description]: run all the nodes till a row of the LCD of a node has a text
+[Args]:
+[in]	uint8 node:
+					the node
+		uint8 row:
+					the LCD row (0 or 1)
+		const char * text:
+					the text, anywhere in the row
+		uint32 timeoutMs:
+					the most time to run
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the text is shown, FALSE if the time is out or a node has ended
+------------------------------------------------------------------*/
+boolean COSIM_runUntilLcd(uint8 node, uint8 row, const char * text, uint32 timeoutMs);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_pressKey
+[Description]: press a button of the keypad of a node, hold it for COSIM_KEY_HOLD_MS
+				and release it for COSIM_KEY_GAP_MS
+[Args]:
+[in]	uint8 node:
+					the node
+		uint8 key:
+					the key as KEYPAD_getPressedKey gives it (0 -> 9, '+', '-', '%', '*', '=' or 13)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is done or FALSE if the key isn't on the keypad or a node has ended
+------------------------------------------------------------------*/
+boolean COSIM_pressKey(uint8 node, uint8 key);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_typeKeys
+[Description]: press a row of keys, the digits '0' -> '9' are the number keys
+				and COSIM_ENTER is Enter
+[Args]:
+[in]	uint8 node:
+					the node
+		const char * keys:
+					the keys
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is done or FALSE otherwise
+------------------------------------------------------------------*/
+boolean COSIM_typeKeys(uint8 node, const char * keys);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_getLcdRow
+[Description]: get the text shown on a row of the LCD of a node
+[Args]:
+[in]	uint8 node:
+					the node
+		uint8 row:
+					the LCD row (0 or 1)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the COSIM_LCD_COLS characters of the row
+------------------------------------------------------------------*/
+const char * COSIM_getLcdRow(uint8 node, uint8 row);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_getMotor
+[Description]: get what the motor of a node does
+[Args]:
+[in]	uint8 node:
+					the node
+[out]	uint8 * duty:
+					the PWM duty cycle in percent (OCR0), it can be NULL_PTR
+[in/out] -NONE
+[Returns]: the direction
+------------------------------------------------------------------*/
+COSIM_Motor COSIM_getMotor(uint8 node, uint8 * duty);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_isBuzzerOn
+[Description]: check the buzzer of a node (PD7)
+[Args]:
+[in]	uint8 node:
+					the node
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is on, FALSE otherwise
+------------------------------------------------------------------*/
+boolean COSIM_isBuzzerOn(uint8 node);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_getCycles
+[Description]: get the time all the nodes have reached
+[Args]:
+[in]	-NONE
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the CPU cycles since the start
+------------------------------------------------------------------*/
+uint64 COSIM_getCycles(void);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_getStatistics
+[Description]: take a copy of the counters of the bus
+[Args]:
+[in]	-NONE
+[out]	COSIM_Statistics * stats:
+					pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void COSIM_getStatistics(COSIM_Statistics * stats);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_getSleepStatistics
+[Description]: take a copy of the sleep counters of a node
+[Args]:
+[in]	uint8 node:
+					the node
+[out]	COSIM_SleepStatistics * stats:
+					pointer to the structure you want to save the counters in
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void COSIM_getSleepStatistics(uint8 node, COSIM_SleepStatistics * stats);
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  COSIM_setLineHook
+[Description]: watch the frames put on the line, the hook is called for every frame
+				in the order of their start in a quantum
+[Args]:
+[in]	void (*hook)(uint8 node, const HOST_UartFrame * frame):
+					the function or NULL_PTR
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+void COSIM_setLineHook(void (*hook)(uint8 node, const HOST_UartFrame * frame));
+
+
+
+#endif /* COSIM_H_ */
@@ -0,0 +1,272 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: test_cosim_baud.c
+ *
+ * Description: Benchmark of the negotiated baud rates on the co-simulation: the HMI_ECU is built
+ *              with every BAUD_FIRST_INDEX (baud.h) so it negotiates each rate of the table, then
+ *              the round trip of a password check is timed on the line from the first byte of the
+ *              PASS_CHECK frame to the last byte of the answer of the Control_ECU
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "test.h"
+#include "cosim.h"
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define TEST_HMI					1
+
+/* the rates of baud.h from the fastest one ... the default HMI_ECU build negotiates the first */
+#define TEST_NUM_OF_RATES			6
+
+/* the request of the HMI_ECU and the frame bytes around the payload (frame.h) */
+#define TEST_PASS_CHECK				0xF3
+#define TEST_SYNC_BYTE				0x7E
+#define TEST_FRAME_OVERHEAD			5
+#define TEST_MAX_PAYLOAD			16
+#define TEST_LENGTH_INDEX			3
+
+/* an address frame has the ninth bit set */
+#define TEST_ADDRESS_BIT			0x100
+
+/* the time the handshake with the negotiation and a request may take */
+#define TEST_REQUEST_MS				2000
+
+/* the round trip at a rate must not take longer than its wire time and this for the Control_ECU */
+#define TEST_PROCESSING_US			2000
+
+#define TEST_PASSWORD				"12345"
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: TEST_RoundTrip
+[Structure Description]: the frames of the password check seen on the line
+					armed      : the next PASS_CHECK frame is timed
+					bytes      : bytes of the answer taken so far
+					length     : bytes of the answer (0 till its length byte is taken)
+					bitCycles  : bit time of the request
+					start      : the cycle the request starts at
+					end        : the cycle the answer ends at (0 till it is complete)
+------------------------------------------------------------------*/
+typedef struct
+{
+	boolean armed;
+	uint8 bytes;
+	uint8 length;
+	uint16 bitCycles;
+	uint64 start;
+	uint64 end;
+}TEST_RoundTrip;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static const uint32 g_rates[TEST_NUM_OF_RATES] = {500000,250000,125000,38400,19200,9600};
+
+static TEST_RoundTrip g_roundTrip;
+
+/* the HMI_ECU byte before the current one ... the type follows the SYNC byte */
+static uint16 g_lastHmiByte;
+
+/* the round trip at every rate in microseconds */
+static uint32 g_roundTripUs[TEST_NUM_OF_RATES];
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void watchLine(uint8 node, const HOST_UartFrame * frame);
+static uint32 measureRate(uint8 index);
+
+static void test_roundTrips(void);
+static void test_fasterIsShorter(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void)
+{
+	COSIM_setLineHook(watchLine);
+
+	TEST_RUN(test_roundTrips);
+	TEST_RUN(test_fasterIsShorter);
+
+	return TEST_RESULT();
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  watchLine
+[Description]: time the PASS_CHECK frame of the HMI_ECU and the frame that answers it
+[Args]:
+[in]	uint8 node:
+					the node that sent the frame
+		const HOST_UartFrame * frame:
+					the frame on the line
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void watchLine(uint8 node, const HOST_UartFrame * frame)
+{
+	uint64 end = frame->start + (uint64)frame->bitCycles * (1 + frame->dataBits + frame->parity + frame->stopBits);
+
+	if(node == TEST_HMI)
+	{
+		if((g_roundTrip.armed == TRUE) && (g_lastHmiByte == TEST_SYNC_BYTE) && (frame->data == TEST_PASS_CHECK))
+		{
+			/* the SYNC byte is sent right before the type */
+			g_roundTrip.start = frame->start - (uint64)frame->bitCycles * (1 + frame->dataBits + frame->parity + frame->stopBits);
+			g_roundTrip.bitCycles = frame->bitCycles;
+			g_roundTrip.armed = FALSE;
+		}
+		g_lastHmiByte = frame->data;
+		return;
+	}
+
+	/* the answer is the first data frame of the Control_ECU after the request */
+	if((g_roundTrip.start == 0) || (g_roundTrip.end != 0) || ((frame->data & TEST_ADDRESS_BIT) != 0))
+	{
+		return;
+	}
+	if((g_roundTrip.bytes == 0) && (frame->data != TEST_SYNC_BYTE))
+	{
+		return;
+	}
+
+	if(g_roundTrip.bytes == TEST_LENGTH_INDEX)
+	{
+		g_roundTrip.length = (uint8)frame->data + TEST_FRAME_OVERHEAD;
+	}
+	g_roundTrip.bytes++;
+	if(g_roundTrip.bytes == g_roundTrip.length)
+	{
+		g_roundTrip.end = end;
+	}
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  measureRate
+[Description]: start the ECUs with the HMI_ECU that negotiates a rate, save a password
+				and time the check of it
+[Args]:
+[in]	uint8 index:
+					the index of the rate in g_rates
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the round trip in microseconds or 0 if it isn't measured at that rate
+------------------------------------------------------------------*/
+static uint32 measureRate(uint8 index)
+{
+	char hmiProgram[256];
+	const char * programs[2] = {COSIM_CONTROL_ECU, hmiProgram};
+	uint32 roundTripUs = 0;
+	uint32 rate;
+
+	/* the default build negotiates the fastest rate */
+	if(index == 0)
+	{
+		snprintf(hmiProgram, sizeof(hmiProgram), "%s", COSIM_HMI_ECU);
+	}
+	else
+	{
+		snprintf(hmiProgram, sizeof(hmiProgram), COSIM_HMI_BAUD_ECU, index);
+	}
+
+	memset(&g_roundTrip, 0, sizeof(g_roundTrip));
+	g_lastHmiByte = 0;
+	if(COSIM_start(programs, 2) == FALSE)
+	{
+		printf("  the ECU programs can't be started\n");
+		return 0;
+	}
+
+	if((COSIM_runUntilLcd(TEST_HMI, 0, "plz enter pass:", TEST_REQUEST_MS) == TRUE) &&
+		(COSIM_typeKeys(TEST_HMI, TEST_PASSWORD "E") == TRUE) &&
+		(COSIM_runUntilLcd(TEST_HMI, 0, "plz re-enter the", TEST_REQUEST_MS) == TRUE) &&
+		(COSIM_runUntilLcd(TEST_HMI, 1, "same pass:", TEST_REQUEST_MS) == TRUE) &&
+		(COSIM_typeKeys(TEST_HMI, TEST_PASSWORD "E") == TRUE) &&
+		(COSIM_runUntilLcd(TEST_HMI, 1, "- : Change Pass", TEST_REQUEST_MS) == TRUE) &&
+		(COSIM_pressKey(TEST_HMI, '+') == TRUE) &&
+		(COSIM_runUntilLcd(TEST_HMI, 0, "plz enter pass:", TEST_REQUEST_MS) == TRUE) &&
+		(COSIM_typeKeys(TEST_HMI, TEST_PASSWORD) == TRUE))
+	{
+		/* only the check sent by Enter is timed */
+		g_roundTrip.armed = TRUE;
+		if((COSIM_typeKeys(TEST_HMI, "E") == TRUE) &&
+			(COSIM_runUntilLcd(TEST_HMI, 1, "Unlocking", TEST_REQUEST_MS) == TRUE) &&
+			(g_roundTrip.end != 0))
+		{
+			rate = F_CPU / g_roundTrip.bitCycles;
+			printf("  %6u baud (%6u on the line): %5u us\n", (unsigned)g_rates[index], (unsigned)rate,
+					(unsigned)((g_roundTrip.end - g_roundTrip.start) / (F_CPU / 1000000UL)));
+
+			/* U2X gives every rate of the table within 0.2% */
+			if((rate * 500UL >= g_rates[index] * 499UL) && (rate * 500UL <= g_rates[index] * 501UL))
+			{
+				roundTripUs = (uint32)((g_roundTrip.end - g_roundTrip.start) / (F_CPU / 1000000UL));
+			}
+		}
+	}
+
+	COSIM_stop();
+	return roundTripUs;
+}
+
+
+
+
+
+/* every rate is negotiated and the check is answered within its wire time and the processing time */
+static void test_roundTrips(void)
+{
+	uint8 index;
+	uint32 minWireUs;
+	uint32 maxWireUs;
+
+	for(index=0;index<TEST_NUM_OF_RATES;index++)
+	{
+		g_roundTripUs[index] = measureRate(index);
+		TEST_CHECK(g_roundTripUs[index] != 0);
+
+		/* the request and the answer have TEST_FRAME_OVERHEAD to TEST_FRAME_OVERHEAD + TEST_MAX_PAYLOAD bytes of 11 bits */
+		minWireUs = (uint32)((2ULL * TEST_FRAME_OVERHEAD * 11 * 1000000UL) / g_rates[index]);
+		maxWireUs = (uint32)((2ULL * (TEST_FRAME_OVERHEAD + TEST_MAX_PAYLOAD) * 11 * 1000000UL) / g_rates[index]);
+		TEST_CHECK(g_roundTripUs[index] >= minWireUs);
+		TEST_CHECK(g_roundTripUs[index] <= maxWireUs + TEST_PROCESSING_US);
+	}
+}
+
+
+
+
+
+/* a faster rate gives a shorter round trip */
+static void test_fasterIsShorter(void)
+{
+	uint8 index;
+
+	for(index=1;index<TEST_NUM_OF_RATES;index++)
+	{
+		TEST_CHECK(g_roundTripUs[index - 1] < g_roundTripUs[index]);
+	}
+}
@@ -0,0 +1,214 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: test_cosim_idle.c
+ *
+ * Description: Idle residency of the ECUs on the co-simulation: both builds are left at the
+ *              password screen with no key pressed, the time every ECU sleeps and the times it
+ *              wakes up are reported ... the default build (one panel that has the UART to itself)
+ *              is bounded and compared with the round robin loop of the multi-panel build that
+ *              selects a panel with an address frame every PANEL_SLOT_MS
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "test.h"
+#include "cosim.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define TEST_CONTROL				COSIM_MASTER
+#define TEST_HMI					1
+#define TEST_MAX_NODES				3
+
+/* the time the ECUs take to reach the password screen and the idle time measured after it */
+#define TEST_REQUEST_MS				2000
+#define TEST_IDLE_MS				3000
+
+/*
+ * the bounds of the single panel loop ... the Control_ECU wakes up only for its software timers,
+ * the HMI_ECU for its keypad scan every KEY_SCAN_PERIOD_MS (10 ms)
+ */
+#define TEST_MIN_CONTROL_RESIDENCY	990
+#define TEST_MAX_CONTROL_WAKEUPS	30
+#define TEST_MIN_HMI_RESIDENCY		980
+#define TEST_MAX_HMI_WAKEUPS		110
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: TEST_Idle
+[Structure Description]: the idle figures of a node
+					residency : slept time in per mille of the idle time
+					wakeups   : wake-ups a second
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint32 residency;
+	uint32 wakeups;
+}TEST_Idle;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* the Control_ECU and the first HMI_ECU of each build */
+static TEST_Idle g_singlePanel[2];
+static TEST_Idle g_roundRobin[2];
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static boolean measureIdle(const char * loop, const char * const * programs, uint8 count, TEST_Idle * idle);
+
+static void test_singlePanelLoop(void);
+static void test_roundRobinLoop(void);
+static void test_fewerWakeups(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void)
+{
+	TEST_RUN(test_singlePanelLoop);
+	TEST_RUN(test_roundRobinLoop);
+	TEST_RUN(test_fewerWakeups);
+
+	return TEST_RESULT();
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  measureIdle
+[Description]: start the ECUs, wait till every panel shows the password screen then count
+				the sleeps of the first two nodes for TEST_IDLE_MS and print them
+				("idle <loop> <node> residency=<per mille> wakeups=<a second>")
+[Args]:
+[in]	const char * loop:
+					the name of the loop in the printed lines
+		const char * const * programs:
+					the ECU programs ... the Control_ECU first
+		uint8 count:
+					the number of the programs
+[out]	TEST_Idle * idle:
+					the figures of the Control_ECU and the first HMI_ECU
+[in/out] -NONE
+[Returns]: TRUE if they are measured, FALSE otherwise
+------------------------------------------------------------------*/
+static boolean measureIdle(const char * loop, const char * const * programs, uint8 count, TEST_Idle * idle)
+{
+	COSIM_SleepStatistics before[TEST_MAX_NODES];
+	COSIM_SleepStatistics after[TEST_MAX_NODES];
+	boolean measured = TRUE;
+	TEST_Idle figures;
+	uint64 cycles;
+	uint8 node;
+
+	if(COSIM_start(programs, count) == FALSE)
+	{
+		printf("  the ECU programs can't be started\n");
+		return FALSE;
+	}
+
+	for(node=TEST_HMI;node<count;node++)
+	{
+		if(COSIM_runUntilLcd(node, 0, "plz enter pass:", TEST_REQUEST_MS) == FALSE)
+		{
+			measured = FALSE;
+		}
+	}
+
+	for(node=0;node<count;node++)
+	{
+		COSIM_getSleepStatistics(node, &before[node]);
+	}
+	if(COSIM_run(TEST_IDLE_MS) == FALSE)
+	{
+		measured = FALSE;
+	}
+	for(node=0;node<count;node++)
+	{
+		COSIM_getSleepStatistics(node, &after[node]);
+	}
+	COSIM_stop();
+
+	if(measured == FALSE)
+	{
+		return FALSE;
+	}
+
+	for(node=0;node<count;node++)
+	{
+		cycles = after[node].cycles - before[node].cycles;
+		if(cycles == 0)
+		{
+			return FALSE;
+		}
+		figures.residency = (uint32)(((after[node].sleptCycles - before[node].sleptCycles) * 1000) / cycles);
+		figures.wakeups = (uint32)(((uint64)(after[node].sleeps - before[node].sleeps) * F_CPU) / cycles);
+		printf("  idle %s %s%u residency=%u wakeups=%u\n", loop, (node == TEST_CONTROL) ? "control" : "hmi", node,
+				(unsigned)figures.residency, (unsigned)figures.wakeups);
+
+		/* the other panels are like the first one */
+		if(node <= TEST_HMI)
+		{
+			idle[node] = figures;
+		}
+	}
+	return TRUE;
+}
+
+
+
+
+
+/* the default build sleeps till its next software timer or the keypad scan */
+static void test_singlePanelLoop(void)
+{
+	const char * programs[2] = {COSIM_CONTROL_ECU, COSIM_HMI_ECU};
+
+	TEST_CHECK(measureIdle("single", programs, 2, g_singlePanel) == TRUE);
+	TEST_CHECK(g_singlePanel[TEST_CONTROL].residency >= TEST_MIN_CONTROL_RESIDENCY);
+	TEST_CHECK(g_singlePanel[TEST_CONTROL].wakeups <= TEST_MAX_CONTROL_WAKEUPS);
+	TEST_CHECK(g_singlePanel[TEST_HMI].residency >= TEST_MIN_HMI_RESIDENCY);
+	TEST_CHECK(g_singlePanel[TEST_HMI].wakeups <= TEST_MAX_HMI_WAKEUPS);
+}
+
+
+
+
+
+/* the multi-panel build selects a panel every turn ... it is only reported */
+static void test_roundRobinLoop(void)
+{
+	const char * programs[3] = {COSIM_CONTROL_PANELS_ECU, COSIM_HMI_PANEL1_ECU, COSIM_HMI_PANEL2_ECU};
+
+	TEST_CHECK(measureIdle("roundrobin", programs, 3, g_roundRobin) == TRUE);
+}
+
+
+
+
+
+/* the single panel loop wakes both ECUs up less often and lets them sleep longer */
+static void test_fewerWakeups(void)
+{
+	uint8 node;
+
+	for(node=0;node<2;node++)
+	{
+		TEST_CHECK(g_singlePanel[node].wakeups < g_roundRobin[node].wakeups);
+		TEST_CHECK(g_singlePanel[node].residency > g_roundRobin[node].residency);
+	}
+}
@@ -0,0 +1,215 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: test_cosim_panels.c
+ *
+ * Description: Load test of the multi-panel bus on the co-simulation: a Control_ECU built with
+ *              NUM_OF_PANELS = 2 serves two HMI_ECUs (PANEL_ADDRESS 1 and 2) that send their
+ *              requests at the same time ... every request must be answered in time and no two
+ *              panels may ever send at once
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "test.h"
+#include "cosim.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define TEST_CONTROL				COSIM_MASTER
+#define TEST_NUM_OF_PANELS			2
+
+/* the time a request may take while the other panel is busy too, and the door times with a margin */
+#define TEST_REQUEST_MS				2000
+#define TEST_DOOR_CYCLE_MS			(15000 + 3000 + 15000 + 1000)
+
+/* MAX_NUM_OF_WRONG_TRIES of the HMI_ECU ... one less is tried so the alarm isn't started */
+#define TEST_WRONG_TRIES			3
+
+#define TEST_PASSWORD				"12345E"
+#define TEST_WRONG_PASSWORD			"54321E"
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static boolean typeOnAllPanels(const char * keys);
+static boolean waitAllPanels(uint8 row, const char * text, uint32 timeoutMs);
+
+static void test_powerUp(void);
+static void test_newPassword(void);
+static void test_wrongPasswords(void);
+static void test_openDoorFromBothPanels(void);
+static void test_busStatistics(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void)
+{
+	const char * programs[1 + TEST_NUM_OF_PANELS] = {COSIM_CONTROL_PANELS_ECU, COSIM_HMI_PANEL1_ECU, COSIM_HMI_PANEL2_ECU};
+
+	if(COSIM_start(programs, 1 + TEST_NUM_OF_PANELS) == FALSE)
+	{
+		printf("  the ECU programs can't be started\n");
+		return 1;
+	}
+
+	TEST_RUN(test_powerUp);
+	TEST_RUN(test_newPassword);
+	TEST_RUN(test_wrongPasswords);
+	TEST_RUN(test_openDoorFromBothPanels);
+	TEST_RUN(test_busStatistics);
+
+	COSIM_stop();
+	return TEST_RESULT();
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  typeOnAllPanels
+[Description]: press a row of keys on the panels key by key, the second panel presses
+				every key right after the first one so their requests are sent together
+[Args]:
+[in]	const char * keys:
+					the keys (see COSIM_typeKeys)
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if it is done or FALSE otherwise
+------------------------------------------------------------------*/
+static boolean typeOnAllPanels(const char * keys)
+{
+	char key[2] = {0, 0};
+	uint8 panel;
+
+	for(;*keys != '\0';keys++)
+	{
+		key[0] = *keys;
+		for(panel=1;panel<=TEST_NUM_OF_PANELS;panel++)
+		{
+			if(COSIM_typeKeys(panel, key) == FALSE)
+			{
+				return FALSE;
+			}
+		}
+	}
+	return TRUE;
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  waitAllPanels
+[Description]: run till a row of the LCD of every panel has a text
+[Args]:
+[in]	uint8 row:
+					the LCD row (0 or 1)
+		const char * text:
+					the text
+		uint32 timeoutMs:
+					the most time to run for every panel
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if all of them show it, FALSE otherwise
+------------------------------------------------------------------*/
+static boolean waitAllPanels(uint8 row, const char * text, uint32 timeoutMs)
+{
+	uint8 panel;
+
+	for(panel=1;panel<=TEST_NUM_OF_PANELS;panel++)
+	{
+		if(COSIM_runUntilLcd(panel, row, text, timeoutMs) == FALSE)
+		{
+			printf("  panel %u shows [%s]\n", panel, COSIM_getLcdRow(panel, row));
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+
+
+
+
+/* both panels find the Control_ECU in their own slots and ask for a new password */
+static void test_powerUp(void)
+{
+	TEST_CHECK(waitAllPanels(0, "plz enter pass:", TEST_REQUEST_MS) == TRUE);
+}
+
+
+
+
+
+/* both panels save the same password, their requests are queued and served in turn */
+static void test_newPassword(void)
+{
+	TEST_CHECK(typeOnAllPanels(TEST_PASSWORD) == TRUE);
+	TEST_CHECK(waitAllPanels(0, "plz re-enter the", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(waitAllPanels(1, "same pass:", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(typeOnAllPanels(TEST_PASSWORD) == TRUE);
+	TEST_CHECK(waitAllPanels(0, "+ : Open Door", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(waitAllPanels(1, "- : Change Pass", TEST_REQUEST_MS) == TRUE);
+}
+
+
+
+
+
+/* the password checks of both panels are sent together and every one gets its own answer */
+static void test_wrongPasswords(void)
+{
+	uint8 i;
+
+	TEST_CHECK(typeOnAllPanels("+") == TRUE);
+	for(i=0;i<(TEST_WRONG_TRIES - 1);i++)
+	{
+		TEST_CHECK(waitAllPanels(0, "plz enter pass:", TEST_REQUEST_MS) == TRUE);
+		TEST_CHECK(typeOnAllPanels(TEST_WRONG_PASSWORD) == TRUE);
+		TEST_CHECK(waitAllPanels(0, "Wrong Password!!", TEST_REQUEST_MS) == TRUE);
+	}
+	TEST_CHECK(COSIM_isBuzzerOn(TEST_CONTROL) == FALSE);
+}
+
+
+
+
+
+/* the right password on both panels opens the door once and both follow the door cycle */
+static void test_openDoorFromBothPanels(void)
+{
+	TEST_CHECK(waitAllPanels(0, "plz enter pass:", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(typeOnAllPanels(TEST_PASSWORD) == TRUE);
+	TEST_CHECK(waitAllPanels(1, "Unlocking", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(COSIM_getMotor(TEST_CONTROL, NULL_PTR) == COSIM_MOTOR_CW);
+
+	TEST_CHECK(waitAllPanels(0, "+ : Open Door", TEST_DOOR_CYCLE_MS) == TRUE);
+	TEST_CHECK(waitAllPanels(1, "- : Change Pass", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(COSIM_getMotor(TEST_CONTROL, NULL_PTR) == COSIM_MOTOR_STOP);
+}
+
+
+
+
+
+/* all the frames came on time and the panels never sent at once */
+static void test_busStatistics(void)
+{
+	COSIM_Statistics stats;
+
+	COSIM_getStatistics(&stats);
+	printf("  %u frames in %u quanta\n", (unsigned)stats.frames, (unsigned)stats.quanta);
+	TEST_CHECK(stats.frames > 0);
+	TEST_CHECK(stats.collisions == 0);
+	TEST_CHECK(stats.lateFrames == 0);
+}
@@ -0,0 +1,218 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: test_cosim_prof.c
+ *
+ * Description: Latency budgets of the user visible flows on the co-simulation: the HMI_ECU (built
+ *              with PROF_ENABLE = TRUE by makefile.host) is powered on, a password is saved, typed
+ *              and checked, then the longest time of every flow is read from the profiling pages of
+ *              its service screen, printed ("prof <region> count=<n> max_us=<n> budget_us=<n>") and
+ *              checked against PROF_BUDGETS_US (prof.h)
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "test.h"
+#include "cosim.h"
+#include "prof.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define TEST_HMI					1
+
+/* the flows of the HMI_ECU timed by PROF_START/PROF_STOP and its debounced keys */
+#define TEST_NUM_OF_FLOWS			4
+
+/*
+ * the time the handshake and a request of the HMI_ECU may take ... the keys are pressed once
+ * the last row of the screen is shown, a page of the service screen takes about 150 ms to draw
+ */
+#define TEST_REQUEST_MS				2000
+
+/* the time the HMI_ECU takes to see a key released after a screen is drawn (a scan and KEY_DEBOUNCE_MS) */
+#define TEST_RELEASE_MS				50
+
+/* the time the door takes to lock again after it is stopped at once */
+#define TEST_DOOR_LOCK_MS			5000
+
+/* the hidden key of the service screen (SERVICE_SCREEN_KEY) */
+#define TEST_SERVICE_KEY			'%'
+
+#define TEST_PASSWORD				"12345E"
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*------------------------------------------------------------------
+[Structure Name]: TEST_Flow
+[Structure Description]: a profiled flow and the name of its page on the service screen
+					region : the region (PROF_xxx)
+					name   : its name in the printed lines
+					label  : the name of its first field on the service screen
+------------------------------------------------------------------*/
+typedef struct
+{
+	uint8 region;
+	const char * name;
+	const char * label;
+}TEST_Flow;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* from the last page to the first one ... '-' shows the first fields of the page before */
+static const TEST_Flow g_flows[TEST_NUM_OF_FLOWS] =
+{
+	{PROF_POWER_ON_TO_MENU, "power_on_to_menu", "Boot"},
+	{PROF_NEW_PASS_TO_SAVED, "new_pass_to_saved", "NewPw"},
+	{PROF_ENTER_TO_PASS_CORRECT, "enter_to_pass_correct", "PwOk"},
+	{PROF_KEY_TO_ECHO, "key_to_echo", "KeyEc"}
+};
+
+static const uint32 g_budgets[PROF_NUM_OF_REGIONS] = PROF_BUDGETS_US;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static boolean pressAndWait(uint8 key, const char * row0, const char * row1);
+static uint32 readField(uint8 row, const char * label);
+
+static void test_flows(void);
+static void test_budgets(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void)
+{
+	const char * programs[2] = {COSIM_CONTROL_ECU, COSIM_HMI_ECU};
+
+	if(COSIM_start(programs, 2) == FALSE)
+	{
+		printf("  the ECU programs can't be started\n");
+		return 1;
+	}
+
+	TEST_RUN(test_flows);
+	TEST_RUN(test_budgets);
+
+	COSIM_stop();
+	return TEST_RESULT();
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  pressAndWait
+[Description]: press a key of the HMI_ECU and run till both rows of the next screen are shown,
+				the same key can be pressed again after it
+[Args]:
+[in]	uint8 key:
+					the key
+		const char * row0:
+					text of the first row of the next screen ... it isn't on the current one
+		const char * row1:
+					text of the second row, the first row is complete once it is shown
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the screen is shown, FALSE otherwise
+------------------------------------------------------------------*/
+static boolean pressAndWait(uint8 key, const char * row0, const char * row1)
+{
+	return (COSIM_pressKey(TEST_HMI, key) == TRUE) &&
+			(COSIM_runUntilLcd(TEST_HMI, 0, row0, TEST_REQUEST_MS) == TRUE) &&
+			(COSIM_runUntilLcd(TEST_HMI, 1, row1, TEST_REQUEST_MS) == TRUE) &&
+			(COSIM_run(TEST_RELEASE_MS) == TRUE);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  readField
+[Description]: read the number of a field of the service screen ("H <label> <number>")
+[Args]:
+[in]	uint8 row:
+					the row of the field
+		const char * label:
+					the name of the field
+[out]	-NONE
+[in/out] -NONE
+[Returns]: the number
+------------------------------------------------------------------*/
+static uint32 readField(uint8 row, const char * label)
+{
+	const char * text = strstr(COSIM_getLcdRow(TEST_HMI, row), label);
+
+	return (text == NULL_PTR) ? 0 : (uint32)strtoul(text + strlen(label), NULL_PTR, 10);
+}
+
+
+
+
+
+/* a password is saved and the door is opened with it ... every key is echoed on the screen */
+static void test_flows(void)
+{
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 0, "plz enter pass:", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(COSIM_typeKeys(TEST_HMI, TEST_PASSWORD) == TRUE);
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 0, "plz re-enter the", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 1, "same pass:", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(COSIM_typeKeys(TEST_HMI, TEST_PASSWORD) == TRUE);
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 1, "- : Change Pass", TEST_REQUEST_MS) == TRUE);
+
+	TEST_CHECK(pressAndWait('+', "plz enter pass:", "") == TRUE);
+	TEST_CHECK(COSIM_typeKeys(TEST_HMI, TEST_PASSWORD) == TRUE);
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 1, "Unlocking -:Stop", TEST_REQUEST_MS) == TRUE);
+
+	/* stopped at once so the door locks in a moment */
+	TEST_CHECK(pressAndWait('-', "Door is Locking", "+:Re-open") == TRUE);
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 1, "- : Change Pass", TEST_DOOR_LOCK_MS) == TRUE);
+}
+
+
+
+
+
+/* the longest time of every flow is within its budget */
+static void test_budgets(void)
+{
+	uint32 count;
+	uint32 maxUs;
+	uint8 i;
+
+	/* the pages of this ECU ... the last one is before the first one */
+	TEST_CHECK(pressAndWait(TEST_SERVICE_KEY, "", "") == TRUE);
+	TEST_CHECK(pressAndWait('=', "H RxByt", "H TxByt") == TRUE);
+	TEST_CHECK(pressAndWait('-', "H EeWr", "H MinUs") == TRUE);
+
+	for(i=0;i<TEST_NUM_OF_FLOWS;i++)
+	{
+		char label[8];
+
+		snprintf(label, sizeof(label), "H %s", g_flows[i].label);
+		TEST_CHECK(pressAndWait('-', label, "H MinUs") == TRUE);
+		count = readField(0, label);
+
+		TEST_CHECK(pressAndWait('+', "H MaxUs", "H TotUs") == TRUE);
+		maxUs = readField(0, "H MaxUs");
+
+		printf("  prof %s count=%u max_us=%u budget_us=%u\n", g_flows[i].name, (unsigned)count,
+				(unsigned)maxUs, (unsigned)g_budgets[g_flows[i].region]);
+		TEST_CHECK(count != 0);
+		TEST_CHECK(maxUs <= g_budgets[g_flows[i].region]);
+	}
+}
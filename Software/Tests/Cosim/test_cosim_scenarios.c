@@ -0,0 +1,296 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: test_cosim_scenarios.c
+ *
+ * Description: Scenarios of the whole system on the co-simulation: the Control_ECU and the HMI_ECU
+ *              run their own programs on one emulated UART bus, the keys are pressed on the keypad
+ *              of the HMI_ECU and the LCD, the motor and the buzzer are checked ... the scenarios
+ *              go on from each other so the order matters
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "test.h"
+#include "cosim.h"
+#include <time.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define TEST_CONTROL				COSIM_MASTER
+#define TEST_HMI					1
+
+/* the times of the Control_ECU (DOOR_MOVE_MS, DOOR_HOLD_MS and the alarm) and a margin for them */
+#define TEST_DOOR_MOVE_MS			15000
+#define TEST_DOOR_HOLD_MS			3000
+#define TEST_ALARM_MS				60000
+#define TEST_MARGIN_MS				1000
+
+/*
+ * the time the handshake and a request of the HMI_ECU may take ... the HMI_ECU doesn't scan the
+ * keypad while it draws a screen (about 5 ms a character) so the keys are pressed once the last
+ * row of the screen is shown
+ */
+#define TEST_REQUEST_MS				2000
+
+/* MAX_NUM_OF_WRONG_TRIES of the HMI_ECU */
+#define TEST_WRONG_TRIES			3
+
+#define TEST_PASSWORD				"12345E"
+#define TEST_WRONG_PASSWORD			"54321E"
+
+/* the commands of the HMI_ECU that the Control_ECU answers with their own type (app.h) */
+#define TEST_OPEN_DOOR				0xF5
+#define TEST_ACTIVATE_THE_ALERT		0xF6
+
+/* the frame bytes (frame.h): SYNC, TYPE, SEQ (the response flag is its MSB), LENGTH, payload, CRC */
+#define TEST_SYNC_BYTE				0x7E
+#define TEST_RESPONSE_FLAG			0x80
+#define TEST_TYPE_INDEX				1
+#define TEST_SEQ_INDEX				2
+#define TEST_LENGTH_INDEX			3
+#define TEST_FRAME_OVERHEAD			5
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* the responses of the Control_ECU seen on the line for every type */
+static uint32 g_responses[256];
+
+/* the byte of the current frame of the Control_ECU, its type, sequence number and size */
+static uint8 g_frameIndex = 0;
+static uint8 g_frameType;
+static uint8 g_frameSeq;
+static uint8 g_frameSize;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static boolean waitMainMenu(uint32 timeoutMs);
+static void watchLine(uint8 node, const HOST_UartFrame * frame);
+
+static void test_powerUp(void);
+static void test_newPassword(void);
+static void test_openDoor(void);
+static void test_wrongPasswordAlarm(void);
+static void test_busStatistics(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void)
+{
+	const char * programs[2] = {COSIM_CONTROL_ECU, COSIM_HMI_ECU};
+	struct timespec wallStart, wallEnd;
+	double wallTime;
+
+	COSIM_setLineHook(watchLine);
+	if(COSIM_start(programs, 2) == FALSE)
+	{
+		printf("  the ECU programs can't be started\n");
+		return 1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &wallStart);
+	TEST_RUN(test_powerUp);
+	TEST_RUN(test_newPassword);
+	TEST_RUN(test_openDoor);
+	TEST_RUN(test_wrongPasswordAlarm);
+	TEST_RUN(test_busStatistics);
+	clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+
+	wallTime = (wallEnd.tv_sec - wallStart.tv_sec) + (wallEnd.tv_nsec - wallStart.tv_nsec) / 1e9;
+	printf("  %.1f s simulated in %.1f s\n", (double)COSIM_getCycles() / F_CPU, wallTime);
+
+	COSIM_stop();
+	return TEST_RESULT();
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  waitMainMenu
+[Description]: run till both rows of the main menu are shown on the HMI_ECU
+[Args]:
+[in]	uint32 timeoutMs:
+					the most time to run
+[out]	-NONE
+[in/out] -NONE
+[Returns]: TRUE if the menu is shown, FALSE otherwise
+------------------------------------------------------------------*/
+static boolean waitMainMenu(uint32 timeoutMs)
+{
+	return (COSIM_runUntilLcd(TEST_HMI, 0, "+ : Open Door", timeoutMs) == TRUE) &&
+			(COSIM_runUntilLcd(TEST_HMI, 1, "- : Change Pass", TEST_REQUEST_MS) == TRUE);
+}
+
+
+
+
+
+/*------------------------------------------------------------------
+[Function Name]:  watchLine
+[Description]: count the responses of the Control_ECU by their type
+[Args]:
+[in]	uint8 node:
+					the node that sent the frame
+		const HOST_UartFrame * frame:
+					the frame on the line
+[out]	-NONE
+[in/out] -NONE
+[Returns]: Nothing
+------------------------------------------------------------------*/
+static void watchLine(uint8 node, const HOST_UartFrame * frame)
+{
+	if(node != TEST_CONTROL)
+	{
+		return;
+	}
+
+	if((g_frameIndex == 0) && (frame->data != TEST_SYNC_BYTE))
+	{
+		return;
+	}
+
+	switch(g_frameIndex)
+	{
+	case TEST_TYPE_INDEX:
+		g_frameType = (uint8)frame->data;
+		break;
+
+	case TEST_SEQ_INDEX:
+		g_frameSeq = (uint8)frame->data;
+		break;
+
+	case TEST_LENGTH_INDEX:
+		g_frameSize = (uint8)frame->data + TEST_FRAME_OVERHEAD;
+		break;
+	}
+
+	g_frameIndex++;
+	if((g_frameIndex > TEST_LENGTH_INDEX) && (g_frameIndex == g_frameSize))
+	{
+		if((g_frameSeq & TEST_RESPONSE_FLAG) != 0)
+		{
+			g_responses[g_frameType]++;
+		}
+		g_frameIndex = 0;
+	}
+}
+
+
+
+
+
+/* the HMI_ECU finds the Control_ECU and asks for a new password (the EEPROM is empty) */
+static void test_powerUp(void)
+{
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 0, "plz enter pass:", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(COSIM_getMotor(TEST_CONTROL, NULL_PTR) == COSIM_MOTOR_STOP);
+	TEST_CHECK(COSIM_isBuzzerOn(TEST_CONTROL) == FALSE);
+}
+
+
+
+
+
+/* the password is entered twice, saved in the EEPROM of the Control_ECU and the main menu is shown */
+static void test_newPassword(void)
+{
+	TEST_CHECK(COSIM_typeKeys(TEST_HMI, TEST_PASSWORD) == TRUE);
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 0, "plz re-enter the", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 1, "same pass:", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(COSIM_typeKeys(TEST_HMI, TEST_PASSWORD) == TRUE);
+	TEST_CHECK(waitMainMenu(TEST_REQUEST_MS) == TRUE);
+}
+
+
+
+
+
+/* the right password opens the door: the motor turns CW while unlocking, stops while the door
+ * is held open and turns A_CW while locking ... the Control_ECU answers OPEN_DOOR */
+static void test_openDoor(void)
+{
+	uint8 duty = 0;
+
+	TEST_CHECK(COSIM_pressKey(TEST_HMI, '+') == TRUE);
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 0, "plz enter pass:", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(COSIM_typeKeys(TEST_HMI, TEST_PASSWORD) == TRUE);
+
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 1, "Unlocking", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(COSIM_run(TEST_MARGIN_MS) == TRUE);
+	TEST_CHECK(COSIM_getMotor(TEST_CONTROL, &duty) == COSIM_MOTOR_CW);
+	TEST_CHECK(duty == 100);
+
+	/* the command is tagged and answered once */
+	TEST_CHECK(g_responses[TEST_OPEN_DOOR] == 1);
+
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 0, "Door is Open", TEST_DOOR_MOVE_MS + TEST_MARGIN_MS) == TRUE);
+	TEST_CHECK(COSIM_run(TEST_MARGIN_MS) == TRUE);
+	TEST_CHECK(COSIM_getMotor(TEST_CONTROL, NULL_PTR) == COSIM_MOTOR_STOP);
+
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 0, "Door is Locking", TEST_DOOR_HOLD_MS + TEST_MARGIN_MS) == TRUE);
+	TEST_CHECK(COSIM_run(TEST_MARGIN_MS) == TRUE);
+	TEST_CHECK(COSIM_getMotor(TEST_CONTROL, &duty) == COSIM_MOTOR_A_CW);
+	TEST_CHECK(duty == 100);
+
+	TEST_CHECK(waitMainMenu(TEST_DOOR_MOVE_MS + TEST_MARGIN_MS) == TRUE);
+	TEST_CHECK(COSIM_getMotor(TEST_CONTROL, NULL_PTR) == COSIM_MOTOR_STOP);
+}
+
+
+
+
+
+/* MAX_NUM_OF_WRONG_TRIES wrong passwords turn the buzzer of the Control_ECU on for the time of
+ * the alarm (ACTIVATE_THE_ALERT is answered) and the main menu comes back after it */
+static void test_wrongPasswordAlarm(void)
+{
+	uint8 i;
+
+	TEST_CHECK(COSIM_pressKey(TEST_HMI, '+') == TRUE);
+	for(i=0;i<TEST_WRONG_TRIES;i++)
+	{
+		TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 0, "plz enter pass:", TEST_REQUEST_MS) == TRUE);
+		TEST_CHECK(COSIM_typeKeys(TEST_HMI, TEST_WRONG_PASSWORD) == TRUE);
+		if(i < (TEST_WRONG_TRIES - 1))
+		{
+			TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 0, "Wrong Password!!", TEST_REQUEST_MS) == TRUE);
+		}
+	}
+
+	TEST_CHECK(COSIM_runUntilLcd(TEST_HMI, 0, "!!!! ERROR !!!!", TEST_REQUEST_MS) == TRUE);
+	TEST_CHECK(COSIM_run(TEST_MARGIN_MS) == TRUE);
+	TEST_CHECK(COSIM_isBuzzerOn(TEST_CONTROL) == TRUE);
+	TEST_CHECK(COSIM_getMotor(TEST_CONTROL, NULL_PTR) == COSIM_MOTOR_STOP);
+	TEST_CHECK(g_responses[TEST_ACTIVATE_THE_ALERT] == 1);
+
+	TEST_CHECK(waitMainMenu(TEST_ALARM_MS + TEST_MARGIN_MS) == TRUE);
+	TEST_CHECK(COSIM_isBuzzerOn(TEST_CONTROL) == FALSE);
+}
+
+
+
+
+
+/* all the frames came on time and no two slaves sent at once */
+static void test_busStatistics(void)
+{
+	COSIM_Statistics stats;
+
+	COSIM_getStatistics(&stats);
+	printf("  %u frames in %u quanta\n", (unsigned)stats.frames, (unsigned)stats.quanta);
+	TEST_CHECK(stats.frames > 0);
+	TEST_CHECK(stats.collisions == 0);
+	TEST_CHECK(stats.lateFrames == 0);
+}
@@ -0,0 +1,90 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: test_bench_drivers.c
+ *
+ * Description: Microbenchmarks of the driver entry points of the HMI_ECU on the host build, every
+ *              entry point is called alone and its cycles per call are checked against its budget
+ *              ... the flash they take is reported by makefile.release (sizes)
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#include "test.h"
+#include "host.h"
+#include "gpio.h"
+#include "lcd.h"
+#include "keypad.h"
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define TEST_CALLS					100
+
+/* the budgets of one call in CPU cycles ... a character waits about 4 ms for the LCD */
+#define TEST_WRITE_PIN_BUDGET		4
+#define TEST_READ_PIN_BUDGET		4
+#define TEST_DISPLAY_CHAR_BUDGET	34000
+#define TEST_KEYPAD_SCAN_BUDGET		80
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+static void test_gpio(void);
+static void test_lcd(void);
+static void test_keypad(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void)
+{
+	LCD_init();
+
+	TEST_RUN(test_gpio);
+	TEST_RUN(test_lcd);
+	TEST_RUN(test_keypad);
+
+	return TEST_RESULT();
+}
+
+
+
+
+
+/* a pin is written and read with one read-modify-write of its port */
+static void test_gpio(void)
+{
+	GPIO_setupPinDirection(PORTA_ID, PIN0_ID, PIN_OUTPUT);
+	TEST_BENCH(GPIO_writePin(PORTA_ID, PIN0_ID, LOGIC_HIGH), TEST_CALLS, TEST_WRITE_PIN_BUDGET);
+	TEST_BENCH(GPIO_readPin(PORTA_ID, PIN1_ID), TEST_CALLS, TEST_READ_PIN_BUDGET);
+}
+
+
+
+
+
+/* a character takes its two nibbles and the wait for the LCD to take it */
+static void test_lcd(void)
+{
+	TEST_BENCH(LCD_displayCharacter('A'), TEST_CALLS, TEST_DISPLAY_CHAR_BUDGET);
+}
+
+
+
+
+
+/* one scan of all the rows with no button pressed ... the longest one */
+static void test_keypad(void)
+{
+	uint8 key = 0;
+
+	TEST_BENCH(key = KEYPAD_scan(), TEST_CALLS, TEST_KEYPAD_SCAN_BUDGET);
+	TEST_CHECK(key == KEYPAD_NO_KEY);
+}
@@ -0,0 +1,51 @@
+ /******************************************************************************
+ *
+ * Module: Tests
+ *
+ * File Name: test.h
+ *
+ * Description: Checks shared by the test drivers of the host build, every driver is one program
+ *              that runs its tests in order and exits with 1 if any check fails
+ *
+ * Author: Mohamed Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include "std_types.h"
+#include <stdio.h>
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* number of the failed checks of the driver */
+static uint16 g_testFailures = 0;
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* report a failed condition with its place and go on with the test */
+#define TEST_CHECK(condition)		do{ if(!(condition)){ printf("  %s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); g_testFailures++; } }while(0)
+
+/* run one test function and show whether its checks passed */
+#define TEST_RUN(test)				do{ uint16 failuresBefore = g_testFailures; test(); printf("%-44s %s\n", #test, (failuresBefore == g_testFailures) ? "PASS" : "FAIL"); }while(0)
+
+/* run a call a number of times on the host build (host.h has to be included), show the CPU cycles of
+ * one call and check them against the declared budget ... the host counts the register accesses
+ * (HOST_CYCLES_PER_ACCESS), the delays and the waits for the device models, not the instructions,
+ * so a call that costs nothing on the host measures nothing and is refused */
+#define TEST_BENCH(call, calls, budget)	do{ uint64 benchStart = HOST_getCycles(); uint32 benchCycles; uint16 benchCall; \
+										for(benchCall=0;benchCall<(calls);benchCall++){ call; } \
+										benchCycles = (uint32)((HOST_getCycles() - benchStart) / (calls)); \
+										printf("  %-42s %8lu cycles (budget %lu)\n", #call, (unsigned long)benchCycles, (unsigned long)(budget)); \
+										TEST_CHECK(benchCycles != 0); \
+										TEST_CHECK(benchCycles <= (budget)); }while(0)
+
+/* the exit code of the driver */
+#define TEST_RESULT()				((g_testFailures == 0) ? 0 : 1)
+
+#endif /* TEST_H_ */
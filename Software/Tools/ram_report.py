@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+#
+# Module: Tools
+#
+# File Name: ram_report.py
+#
+# Description: print the .data and .bss bytes of every module from an avr-gcc map file
+#              usage: python3 ram_report.py <ECU>/Debug/<ECU>.map
+#
+# Author: Mohamed Ashraf
+#
+
+import re
+import sys
+
+# " .bss.g_name    0x00800122        0x1 ./APP/app.o" ... long section names wrap the rest to the next line,
+# the constants (.rodata) are copied to the RAM with .data on the AVR
+SECTION = re.compile(r'^ (\.data|\.rodata|\.bss|COMMON)(\.\S*)?\s*$|^ (\.data|\.rodata|\.bss|COMMON)(\.\S*)?\s+0x[0-9a-fA-F]+\s+(0x[0-9a-fA-F]+)\s+(\S.*)$')
+PLACED = re.compile(r'^\s+0x[0-9a-fA-F]+\s+(0x[0-9a-fA-F]+)\s+(\S.*)$')
+
+# the SRAM of the ATmega32
+RAM_SIZE = 2048
+
+
+def module_name(path):
+	# "./APP/app.o" -> "app", "...\libc.a(itoa.o)" -> "libc.a"
+	path = path.replace('\\', '/')
+	if '(' in path:
+		return path.split('/')[-1].split('(')[0]
+	return path.split('/')[-1].rsplit('.', 1)[0]
+
+
+def main():
+	if len(sys.argv) != 2:
+		sys.exit('usage: ram_report.py <map file>')
+
+	usage = {}
+	pending = None
+	in_memory_map = False
+
+	for line in open(sys.argv[1], errors='replace'):
+		if line.startswith('Linker script and memory map'):
+			in_memory_map = True
+			continue
+		if not in_memory_map:
+			continue
+
+		if pending is not None:
+			placed = PLACED.match(line)
+			if placed:
+				usage.setdefault(module_name(placed.group(2)), {'.data': 0, '.bss': 0})[pending] += int(placed.group(1), 16)
+			pending = None
+			continue
+
+		section = SECTION.match(line)
+		if not section:
+			continue
+		kind = section.group(1) or section.group(3)
+		kind = '.data' if kind in ('.data', '.rodata') else '.bss'
+		if section.group(5) is None:
+			pending = kind
+		else:
+			usage.setdefault(module_name(section.group(6)), {'.data': 0, '.bss': 0})[kind] += int(section.group(5), 16)
+
+	total_data = sum(u['.data'] for u in usage.values())
+	total_bss = sum(u['.bss'] for u in usage.values())
+
+	print('%-16s %6s %6s %6s' % ('module', '.data', '.bss', 'total'))
+	for name, u in sorted(usage.items(), key=lambda item: -(item[1]['.data'] + item[1]['.bss'])):
+		if u['.data'] + u['.bss']:
+			print('%-16s %6d %6d %6d' % (name, u['.data'], u['.bss'], u['.data'] + u['.bss']))
+	print('%-16s %6d %6d %6d' % ('all', total_data, total_bss, total_data + total_bss))
+	print('left for the stack: %d of %d bytes' % (RAM_SIZE - total_data - total_bss, RAM_SIZE))
+
+
+if __name__ == '__main__':
+	main()